@@ -0,0 +1,444 @@
+//
+// Polynomials with a chosen coefficient type.  BasicPolynomial<T> does the same arithmetic as
+// Polynomial (sums, products, scalar operations, powers, derivatives, integrals and evaluation), with
+// every coefficient, scalar and result in T:
+//
+// - PolynomialF (float) halves the memory of the coefficients and doubles the number of points per
+//   SIMD instruction in evaluate() (float AVX2 and AVX-512 kernels),
+// - BasicPolynomial<double> matches Polynomial,
+// - PolynomialLD (long double) uses the x87 80-bit format where the platform has it,
+// - PolynomialDD (DoubleDouble) gives about 106 bits of precision with plain double instructions.
+//
+// Polynomials with different values of a are combined like Polynomial's operators: the one with more
+// terms keeps its a, and the other one is rewritten around it (see recenter).
+//
+// Polynomial remains the full class (keyword series, root finding and isolation, display options);
+// a BasicPolynomial converts to and from it at the edges.
+//
+
+#ifndef POLYNOMIALC_BASICPOLYNOMIAL_H
+#define POLYNOMIALC_BASICPOLYNOMIAL_H
+
+#include "PolynomialC.h"
+#include "DoubleDouble.h"
+#include "Kernels.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace polynomialc_internal {
+    // Multiplies two operands of equal length n into out (2n - 1 terms) with Karatsuba's method, in
+    // any arithmetic type.
+    template <typename T>
+    void karatsuba_generic(const T* a, const T* b, size_t n, T* out) {
+        if (n < karatsuba_cutoff) {
+            fill(out, out + 2 * n - 1, T(0));
+            for (size_t i = 0; i < n; i++) {
+                for (size_t j = 0; j < n; j++) {
+                    out[i + j] += a[i] * b[j];
+                }
+            }
+            return;
+        }
+
+        const size_t low = n / 2;
+        const size_t high = n - low;
+        karatsuba_generic(a, b, low, out);
+        out[2 * low - 1] = T(0);
+        karatsuba_generic(a + low, b + low, high, out + 2 * low);
+
+        vector<T> a_sum(high);
+        vector<T> b_sum(high);
+        vector<T> middle(2 * high - 1);
+        for (size_t i = 0; i < high; i++) {
+            a_sum[i] = a[low + i] + (i < low ? a[i] : T(0));
+            b_sum[i] = b[low + i] + (i < low ? b[i] : T(0));
+        }
+        karatsuba_generic(a_sum.data(), b_sum.data(), high, middle.data());
+        for (size_t i = 0; i < 2 * low - 1; i++) {
+            middle[i] -= out[i];
+        }
+        for (size_t i = 0; i < 2 * high - 1; i++) {
+            middle[i] -= out[2 * low + i];
+        }
+        for (size_t i = 0; i < 2 * high - 1; i++) {
+            out[low + i] += middle[i];
+        }
+    }
+
+    // Multiplies a (n coefficients) by b (m coefficients) into out (n + m - 1 coefficients).  double
+    // goes to the multiplication engine, and so does float (the products of two floats are exact in
+    // double, so the result is rounded only once); the wider types use schoolbook or Karatsuba
+    // multiplication in their own arithmetic.
+    template <typename T>
+    void multiply_generic(const T* a, size_t n, const T* b, size_t m, T* out) {
+        if (n == 0 || m == 0) {
+            return;
+        }
+        if constexpr (is_same_v<T, double>) {
+            multiply(a, n, b, m, out);
+        } else if constexpr (is_same_v<T, float>) {
+            vector<double> wide_a(a, a + n);
+            vector<double> wide_b(b, b + m);
+            vector<double> product(n + m - 1);
+            multiply(wide_a.data(), n, wide_b.data(), m, product.data());
+            for (size_t i = 0; i < n + m - 1; i++) {
+                out[i] = (float) product[i];
+            }
+        } else {
+            if (n < m) {
+                swap(a, b);
+                swap(n, m);
+            }
+            fill(out, out + n + m - 1, T(0));
+            if (m < karatsuba_cutoff) {
+                for (size_t i = 0; i < n; i++) {
+                    for (size_t j = 0; j < m; j++) {
+                        out[i + j] += a[i] * b[j];
+                    }
+                }
+                return;
+            }
+
+            // An unbalanced product is split into blocks of the shorter operand's length.
+            vector<T> block(2 * m - 1);
+            for (size_t start = 0; start < n; start += m) {
+                size_t length = min(m, n - start);
+                if (length == m) {
+                    karatsuba_generic(a + start, b, m, block.data());
+                } else {
+                    multiply_generic(a + start, length, b, m, block.data());
+                }
+                for (size_t i = 0; i < length + m - 1; i++) {
+                    out[start + i] += block[i];
+                }
+            }
+        }
+    }
+
+    // Rewrites sum(coefficients[i] * t^i) in place as a polynomial in (t - shift).  double goes to
+    // taylor_shift; the other types use repeated synthetic division in their own arithmetic.
+    template <typename T>
+    void taylor_shift_generic(T* coefficients, size_t n, T shift) {
+        if constexpr (is_same_v<T, double>) {
+            taylor_shift(coefficients, n, shift);
+        } else {
+            for (size_t i = 0; i + 1 < n; i++) {
+                for (size_t j = n - 1; j-- > i;) {
+                    coefficients[j] += shift * coefficients[j + 1];
+                }
+            }
+        }
+    }
+}
+
+template <typename T>
+class BasicPolynomial {
+    // coefficient_list[i] is the coefficient of (x - a)^i, like the coefficient list of a Polynomial.
+    vector<T> coefficient_list;
+    T a;
+
+    void remove_top_zero_terms() {
+        while (!coefficient_list.empty() && coefficient_list.back() == T(0)) {
+            coefficient_list.pop_back();
+        }
+    }
+
+    // Horner's scheme over count points at once, for the types without a SIMD kernel.  count is a
+    // constant so every inner loop has a fixed trip count.
+    template <size_t count>
+    void evaluate_block(const T* xs, T* out) const {
+        const size_t n = coefficient_list.size();
+        T t[count];
+        T result[count];
+        for (size_t k = 0; k < count; k++) {
+            t[k] = xs[k] - a;
+            result[k] = T(0);
+        }
+        for (size_t i = n; i-- > 0;) {
+            const T c = coefficient_list[i];
+            for (size_t k = 0; k < count; k++) {
+                result[k] = result[k] * t[k] + c;
+            }
+        }
+        copy(result, result + count, out);
+    }
+
+    void move_center(T new_a) {
+        if (new_a != a) {
+            polynomialc_internal::taylor_shift_generic(coefficient_list.data(), coefficient_list.size(), new_a - a);
+            a = new_a;
+        }
+    }
+
+    // Moves this polynomial to the center it shares with other (the longer one's a) and returns other
+    // rewritten around it.
+    BasicPolynomial meet(const BasicPolynomial& other) {
+        move_center(polynomialc_internal::common_center(coefficient_list.size(), a, other.coefficient_list.size(),
+                                                        other.a));
+        return other.recenter(a);
+    }
+
+public:
+    // Class Constructors
+    BasicPolynomial() : coefficient_list{T(0)}, a(0) {}
+
+    BasicPolynomial(vector<T> set_coefficient_list, T set_a=T(0))
+        : coefficient_list(std::move(set_coefficient_list)), a(set_a) {
+        remove_top_zero_terms();
+    }
+
+    // Rounds (or widens) the coefficients of a Polynomial to T.
+    explicit BasicPolynomial(const Polynomial& polynomial) : a(T(polynomial.get_a())) {
+        for (double coefficient : polynomial.coefficients()) {
+            coefficient_list.push_back(T(coefficient));
+        }
+        remove_top_zero_terms();
+    }
+
+    // Rounds the coefficients to double.
+    Polynomial to_polynomial() const {
+        vector<double> rounded;
+        for (const T& coefficient : coefficient_list) {
+            rounded.push_back((double) coefficient);
+        }
+        return Polynomial(std::move(rounded), (double) a);
+    }
+
+    // Class Getters & Setters
+    const vector<T>& get_coefficients() const { return coefficient_list; }
+    span<const T> coefficients() const { return coefficient_list; }
+    void set_coefficients(vector<T> new_coefficients) {
+        coefficient_list = std::move(new_coefficients);
+        remove_top_zero_terms();
+    }
+    T get_a() const { return a; }
+    void set_a(T new_a) { a = new_a; }
+
+    // Class Functions
+
+    // Horner's scheme, entirely in T.
+    T solve(T x) const {
+        const T t = x - a;
+        T result = T(0);
+        for (size_t i = coefficient_list.size(); i-- > 0;) {
+            result = result * t + coefficient_list[i];
+        }
+        return result;
+    }
+
+    // float and double go to the runtime-dispatched Horner kernels of Polynomial::evaluate (AVX-512,
+    // AVX2 or scalar), where a float vector holds twice the points.  The other types evaluate a block
+    // of points at a time, with the points in the inner loop.
+    void evaluate(span<const T> xs, span<T> out) const {
+        if (xs.size() != out.size()) {
+            throw invalid_argument("Polynomial evaluate size mismatch.");
+        }
+        if constexpr (is_same_v<T, float> || is_same_v<T, double>) {
+            polynomialc_internal::horner_batch(coefficient_list.data(), coefficient_list.size(), a, xs.data(),
+                                               out.data(), xs.size());
+        } else {
+            constexpr size_t block = max<size_t>(1, 128 / sizeof(T));
+            size_t start = 0;
+            for (; start + block <= xs.size(); start += block) {
+                evaluate_block<block>(xs.data() + start, out.data() + start);
+            }
+            for (; start < xs.size(); start++) {
+                out[start] = solve(xs[start]);
+            }
+        }
+    }
+
+    BasicPolynomial differentiate() const {
+        vector<T> derivative;
+        for (size_t i = 1; i < coefficient_list.size(); i++) {
+            derivative.push_back(coefficient_list[i] * T(double(i)));
+        }
+        return BasicPolynomial(std::move(derivative), a);
+    }
+
+    BasicPolynomial integrate(T c=T(0)) const {
+        vector<T> integral = {c};
+        for (size_t i = 0; i < coefficient_list.size(); i++) {
+            integral.push_back(coefficient_list[i] / T(double(i + 1)));
+        }
+        return BasicPolynomial(std::move(integral), a);
+    }
+
+    // The same polynomial written around new_a, like Polynomial::recenter.
+    BasicPolynomial recenter(T new_a) const {
+        BasicPolynomial result = *this;
+        result.move_center(new_a);
+        return result;
+    }
+
+    // Binary exponentiation, like Polynomial::power.
+    BasicPolynomial power(unsigned int x) const {
+        BasicPolynomial result(vector<T>{T(1)}, a);
+        BasicPolynomial base = *this;
+        while (x > 0) {
+            if (x & 1) {
+                result *= base;
+            }
+            x >>= 1;
+            if (x > 0) {
+                base *= base;
+            }
+        }
+        return result;
+    }
+
+    // Class Interactions with other polynomials
+    BasicPolynomial& operator+=(const BasicPolynomial& other) {
+        if (a != other.a) {
+            return *this += meet(other);
+        }
+        if (coefficient_list.size() < other.coefficient_list.size()) {
+            coefficient_list.resize(other.coefficient_list.size(), T(0));
+        }
+        for (size_t i = 0; i < other.coefficient_list.size(); i++) {
+            coefficient_list[i] += other.coefficient_list[i];
+        }
+        remove_top_zero_terms();
+        return *this;
+    }
+
+    BasicPolynomial& operator-=(const BasicPolynomial& other) {
+        if (a != other.a) {
+            return *this -= meet(other);
+        }
+        if (coefficient_list.size() < other.coefficient_list.size()) {
+            coefficient_list.resize(other.coefficient_list.size(), T(0));
+        }
+        for (size_t i = 0; i < other.coefficient_list.size(); i++) {
+            coefficient_list[i] -= other.coefficient_list[i];
+        }
+        remove_top_zero_terms();
+        return *this;
+    }
+
+    BasicPolynomial& operator*=(const BasicPolynomial& other) {
+        if (a != other.a) {
+            return *this *= meet(other);
+        }
+        if (coefficient_list.empty() || other.coefficient_list.empty()) {
+            coefficient_list.clear();
+            return *this;
+        }
+        vector<T> product(coefficient_list.size() + other.coefficient_list.size() - 1);
+        polynomialc_internal::multiply_generic(coefficient_list.data(), coefficient_list.size(),
+                                               other.coefficient_list.data(), other.coefficient_list.size(),
+                                               product.data());
+        coefficient_list = std::move(product);
+        remove_top_zero_terms();
+        return *this;
+    }
+
+    // Class Interactions with constants
+    BasicPolynomial& operator+=(T x) {
+        if (coefficient_list.empty()) {
+            coefficient_list.push_back(T(0));
+        }
+        coefficient_list[0] += x;
+        remove_top_zero_terms();
+        return *this;
+    }
+
+    BasicPolynomial& operator-=(T x) {
+        return *this += -x;
+    }
+
+    BasicPolynomial& operator*=(T x) {
+        for (T& coefficient : coefficient_list) {
+            coefficient *= x;
+        }
+        remove_top_zero_terms();
+        return *this;
+    }
+
+    BasicPolynomial& operator/=(T x) {
+        for (T& coefficient : coefficient_list) {
+            coefficient /= x;
+        }
+        remove_top_zero_terms();
+        return *this;
+    }
+
+    // Miscellaneous Operations
+    T operator[](size_t i) const { return i < coefficient_list.size() ? coefficient_list[i] : T(0); }
+    T operator()(T x) const { return solve(x); }
+};
+
+// Interactions with other polynomials.  The scalar is taken as T (not deduced from the argument), so
+// p * 2.5 works for every coefficient type.
+template <typename T>
+BasicPolynomial<T> operator+(BasicPolynomial<T> left, const BasicPolynomial<T>& right) {
+    return left += right;
+}
+
+template <typename T>
+BasicPolynomial<T> operator-(BasicPolynomial<T> left, const BasicPolynomial<T>& right) {
+    return left -= right;
+}
+
+template <typename T>
+BasicPolynomial<T> operator*(BasicPolynomial<T> left, const BasicPolynomial<T>& right) {
+    return left *= right;
+}
+
+// Interactions with other data types
+template <typename T>
+BasicPolynomial<T> operator+(BasicPolynomial<T> polynomial, type_identity_t<T> x) {
+    return polynomial += x;
+}
+
+template <typename T>
+BasicPolynomial<T> operator+(type_identity_t<T> x, BasicPolynomial<T> polynomial) {
+    return polynomial += x;
+}
+
+template <typename T>
+BasicPolynomial<T> operator-(BasicPolynomial<T> polynomial, type_identity_t<T> x) {
+    return polynomial -= x;
+}
+
+template <typename T>
+BasicPolynomial<T> operator-(type_identity_t<T> x, BasicPolynomial<T> polynomial) {
+    polynomial *= T(-1);
+    return polynomial += x;
+}
+
+template <typename T>
+BasicPolynomial<T> operator*(BasicPolynomial<T> polynomial, type_identity_t<T> x) {
+    return polynomial *= x;
+}
+
+template <typename T>
+BasicPolynomial<T> operator*(type_identity_t<T> x, BasicPolynomial<T> polynomial) {
+    return polynomial *= x;
+}
+
+template <typename T>
+BasicPolynomial<T> operator/(BasicPolynomial<T> polynomial, type_identity_t<T> x) {
+    return polynomial /= x;
+}
+
+template <typename T>
+BasicPolynomial<T> operator-(BasicPolynomial<T> polynomial) {
+    return polynomial *= T(-1);
+}
+
+// Printed like a Polynomial, with the coefficients rounded to double.
+template <typename T>
+ostream& operator<<(ostream& out, const BasicPolynomial<T>& polynomial) {
+    return out << polynomial.to_polynomial();
+}
+
+using PolynomialF = BasicPolynomial<float>;
+using PolynomialLD = BasicPolynomial<long double>;
+using PolynomialDD = BasicPolynomial<DoubleDouble>;
+
+#endif //POLYNOMIALC_BASICPOLYNOMIAL_H
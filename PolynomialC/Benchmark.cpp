@@ -0,0 +1,475 @@
+//
+// polynomialc_bench: times the hot paths of the library over a sweep of degrees, point counts and
+// thread counts, and writes the results as JSON.  The JSON of an earlier run can be passed back as a
+// baseline; every case that got slower than it by more than the tolerance is reported, and the exit
+// status is then 1, so the benchmark can guard against regressions:
+//
+//     polynomialc_bench --out baseline.json
+//     polynomialc_bench --baseline baseline.json --tolerance 0.25
+//
+// Other options: --filter text (only the cases whose name contains text), --max-degree n (the
+// sweep goes 1, 10, ... up to n, 100000 by default), --min-time seconds (per case, 0.1 by default)
+// and --threads 1,2,4 (the thread counts of the threaded cases, by default 1 and every power of two
+// up to the number of hardware threads).
+//
+
+#include "BasicPolynomial.h"
+#include "ChebyshevPolynomial.h"
+#include "PolynomialC.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <vector>
+using namespace std;
+
+namespace {
+
+// ===== HELPERS =====
+
+struct Options {
+    string filter;
+    size_t max_degree = 100000;
+    double min_time = 0.1;
+    vector<unsigned int> threads;
+    string out = "polynomialc_bench.json";
+    string baseline;
+    double tolerance = 0.25;
+};
+
+struct Result {
+    string name;
+    string operation;
+    size_t degree;
+    size_t points;
+    unsigned int threads;
+    size_t iterations;
+    double ns_per_op;
+    double ns_min;
+};
+
+// Work past this many coefficient-times-point steps per call is skipped, to keep a full sweep within
+// a few minutes.
+const double max_work = 2e8;
+
+// Every case is timed as repetitions batches, and reports the median batch.
+const int repetitions = 5;
+
+// Results are written here so the compiler cannot drop the timed calls.
+volatile double sink;
+
+vector<double> random_coefficients(size_t n, unsigned int seed) {
+    // Fixed seeds, so every run (and the baseline) times the same polynomials.
+    mt19937_64 generator(seed);
+    uniform_real_distribution<double> distribution(-1.0, 1.0);
+    vector<double> coefficients(n);
+    for (double& coefficient : coefficients) {
+        coefficient = distribution(generator);
+    }
+    return coefficients;
+}
+
+vector<double> evaluation_points(size_t count) {
+    // Points in [-1, 1], where the random polynomials neither overflow nor vanish.
+    vector<double> xs(count);
+    for (size_t i = 0; i < count; i++) {
+        xs[i] = count > 1 ? -1.0 + 2.0 * double(i) / double(count - 1) : 0.5;
+    }
+    return xs;
+}
+
+template <typename Body>
+double time_batch(Body& body, size_t iterations) {
+    const auto start = chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; i++) {
+        body();
+    }
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+template <typename Body>
+void measure(Result& result, Body body, double min_time) {
+    // The number of iterations is grown until one batch takes a fair share of min_time, then the
+    // batches are timed.
+    body();
+    const double batch_time = min_time / repetitions;
+    size_t iterations = 1;
+    double elapsed = time_batch(body, iterations);
+    while (elapsed < batch_time && iterations < (size_t(1) << 30)) {
+        const double factor = elapsed > 0 ? min(10.0, max(2.0, 1.2 * batch_time / elapsed)) : 10.0;
+        iterations = size_t(double(iterations) * factor);
+        elapsed = time_batch(body, iterations);
+    }
+
+    vector<double> samples(repetitions);
+    for (double& sample : samples) {
+        sample = time_batch(body, iterations) * 1e9 / double(iterations);
+    }
+    sort(samples.begin(), samples.end());
+    result.iterations = iterations;
+    result.ns_per_op = samples[repetitions / 2];
+    result.ns_min = samples.front();
+}
+
+string case_name(const string& operation, size_t degree, size_t points, unsigned int threads) {
+    string name = operation;
+    if (degree > 0) {
+        name += "/degree:" + to_string(degree);
+    }
+    if (points > 0) {
+        name += "/points:" + to_string(points);
+    }
+    if (threads > 0) {
+        name += "/threads:" + to_string(threads);
+    }
+    return name;
+}
+
+vector<unsigned int> parse_thread_list(const string& text) {
+    vector<unsigned int> threads;
+    stringstream stream(text);
+    string item;
+    while (getline(stream, item, ',')) {
+        threads.push_back((unsigned int) stoul(item));
+    }
+    return threads;
+}
+
+map<string, double> read_baseline(const string& path) {
+    // Reads the name and ns_per_op of every case of a file written by write_json.
+    map<string, double> baseline;
+    ifstream file(path);
+    if (!file) {
+        cerr << "Cannot read the baseline " << path << "." << endl;
+        exit(2);
+    }
+    stringstream contents;
+    contents << file.rdbuf();
+    const string text = contents.str();
+
+    const string name_key = "\"name\": \"";
+    const string time_key = "\"ns_per_op\": ";
+    size_t position = text.find(name_key);
+    while (position != string::npos) {
+        const size_t name_start = position + name_key.size();
+        const size_t name_end = text.find('"', name_start);
+        const size_t time = text.find(time_key, name_end);
+        if (name_end == string::npos || time == string::npos) {
+            break;
+        }
+        baseline[text.substr(name_start, name_end - name_start)] = strtod(text.c_str() + time + time_key.size(), nullptr);
+        position = text.find(name_key, time);
+    }
+    return baseline;
+}
+
+void write_json(const string& path, const Options& options, const vector<Result>& results) {
+    ofstream file(path);
+    if (!file) {
+        cerr << "Cannot write " << path << "." << endl;
+        exit(2);
+    }
+    file << "{\n  \"context\": {\n";
+    file << "    \"compiler\": \"" << __VERSION__ << "\",\n";
+#ifdef NDEBUG
+    file << "    \"assertions\": false,\n";
+#else
+    file << "    \"assertions\": true,\n";
+#endif
+    file << "    \"hardware_threads\": " << thread::hardware_concurrency() << ",\n";
+    file << "    \"min_time\": " << options.min_time << "\n  },\n  \"benchmarks\": [\n";
+    file.precision(6);
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result& result = results[i];
+        file << "    {\"name\": \"" << result.name << "\", \"operation\": \"" << result.operation
+             << "\", \"degree\": " << result.degree << ", \"points\": " << result.points
+             << ", \"threads\": " << result.threads << ", \"iterations\": " << result.iterations
+             << ", \"ns_per_op\": " << fixed << result.ns_per_op << ", \"ns_min\": " << result.ns_min
+             << defaultfloat << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    file << "  ]\n}\n";
+}
+
+
+// ===== BENCHMARKS =====
+
+class Suite {
+    Options options;
+    vector<size_t> degrees;
+    vector<Result> results;
+
+    template <typename Body>
+    void run(const string& operation, size_t degree, size_t points, unsigned int threads, Body body) {
+        Result result{case_name(operation, degree, points, threads), operation, degree, points, threads, 0, 0, 0};
+        if (!options.filter.empty() && result.name.find(options.filter) == string::npos) {
+            return;
+        }
+        measure(result, body, options.min_time);
+        printf("%-48s %16.1f ns/op %12zu iterations\n", result.name.c_str(), result.ns_per_op, result.iterations);
+        fflush(stdout);
+        results.push_back(result);
+    }
+
+public:
+    explicit Suite(const Options& options) : options(options) {
+        for (size_t degree = 1; degree <= options.max_degree; degree *= 10) {
+            degrees.push_back(degree);
+        }
+    }
+
+    const vector<Result>& get_results() const {
+        return results;
+    }
+
+    void solve() {
+        // One point per call, as in a loop over solve().
+        for (size_t degree : degrees) {
+            const Polynomial polynomial(random_coefficients(degree + 1, 1), 0);
+            double x = 0.25;
+            run("solve", degree, 0, 0, [&] {
+                sink = polynomial.solve(x);
+                x = -x;
+            });
+        }
+    }
+
+    void evaluate() {
+        // The SIMD batch path, then evaluate_many over the thread pool.
+        for (size_t degree : degrees) {
+            const Polynomial polynomial(random_coefficients(degree + 1, 2), 0);
+            for (size_t points : {size_t(1), size_t(100), size_t(10000), size_t(1000000)}) {
+                if (double(degree + 1) * double(points) > max_work) {
+                    continue;
+                }
+                const vector<double> xs = evaluation_points(points);
+                vector<double> out(points);
+                run("evaluate", degree, points, 0, [&] {
+                    polynomial.evaluate(xs, out);
+                    sink = out[0];
+                });
+                if (points < 10000) {
+                    continue;
+                }
+                for (unsigned int threads : options.threads) {
+                    run("evaluate_many", degree, points, threads, [&] {
+                        sink = polynomial.evaluate_many(xs, threads)[0];
+                    });
+                }
+            }
+        }
+    }
+
+    void coefficient_types() {
+        // BasicPolynomial::evaluate in each coefficient type, next to the double evaluate above.
+        for (size_t degree : degrees) {
+            const vector<double> coefficients = random_coefficients(degree + 1, 2);
+            for (size_t points : {size_t(10000), size_t(1000000)}) {
+                if (double(degree + 1) * double(points) > max_work) {
+                    continue;
+                }
+                const vector<double> xs = evaluation_points(points);
+                evaluate_type<float>("evaluate_f", coefficients, xs, degree);
+                evaluate_type<double>("evaluate_basic", coefficients, xs, degree);
+                evaluate_type<long double>("evaluate_ld", coefficients, xs, degree);
+                evaluate_type<DoubleDouble>("evaluate_dd", coefficients, xs, degree);
+            }
+        }
+    }
+
+    template <typename T>
+    void evaluate_type(const string& operation, const vector<double>& coefficients, const vector<double>& xs,
+                       size_t degree) {
+        const BasicPolynomial<T> polynomial(Polynomial(coefficients, 0));
+        const vector<T> points(xs.begin(), xs.end());
+        vector<T> out(points.size());
+        run(operation, degree, points.size(), 0, [&] {
+            polynomial.evaluate(points, out);
+            sink = double(out[0]);
+        });
+    }
+
+    void multiply() {
+        for (size_t degree : degrees) {
+            const Polynomial left(random_coefficients(degree + 1, 3), 0);
+            const Polynomial right(random_coefficients(degree + 1, 4), 0);
+            run("multiply", degree, 0, 0, [&] {
+                sink = (left * right)[0];
+            });
+        }
+    }
+
+    void power() {
+        // The eighth power: three squarings of a growing polynomial, all of them fast products.
+        for (size_t degree : degrees) {
+            const Polynomial base(random_coefficients(degree + 1, 5), 0);
+            run("power", degree, 0, 0, [&] {
+                sink = base.power(8)[0];
+            });
+        }
+    }
+
+    void zero() {
+        // -1 + x + x^2 / 2 + ... + x^n / n has one root in (0, 1), which Newton's method reaches from 0.
+        for (size_t degree : degrees) {
+            vector<double> coefficients(degree + 1);
+            coefficients[0] = -1;
+            for (size_t i = 1; i <= degree; i++) {
+                coefficients[i] = 1.0 / double(i);
+            }
+            const Polynomial polynomial(coefficients, 0);
+            run("zero", degree, 0, 0, [&] {
+                sink = polynomial.zero();
+            });
+        }
+    }
+
+    void roots() {
+        // Aberth-Ehrlich over the thread pool; the iteration is O(n^2), so the sweep stops at 1000.
+        for (size_t degree : degrees) {
+            if (degree < 10 || degree > 1000) {
+                continue;
+            }
+            const Polynomial polynomial(random_coefficients(degree + 1, 6), 0);
+            for (unsigned int threads : options.threads) {
+                run("roots", degree, 0, threads, [&] {
+                    sink = polynomial.roots(threads)[0].real();
+                });
+            }
+        }
+    }
+
+    void keyword() {
+        // The keyword constructor (1000 terms from the shared tables), then series of every length.
+        for (const char* name : {"sine", "cosine", "euler", "ln"}) {
+            run(string("keyword/") + name, 0, 0, 0, [&] {
+                sink = Polynomial(name)[1];
+            });
+        }
+        for (size_t degree : degrees) {
+            run("series", degree, 0, 0, [&] {
+                sink = Polynomial::series("sine", (unsigned int) degree + 1)[1];
+            });
+        }
+    }
+
+    void format() {
+        // The simple display into a reused string (so the timing is the formatter, not the allocator).
+        string text;
+        for (size_t degree : degrees) {
+            const Polynomial polynomial(random_coefficients(degree + 1, 7), 0.5);
+            run("format", degree, 0, 0, [&] {
+                text.clear();
+                polynomial.format(text);
+                sink = double(text.size());
+            });
+        }
+    }
+
+    void chebyshev() {
+        // Clenshaw's recurrence over a batch of points, and a minimax fit of exp on [-1, 1].
+        for (size_t degree : degrees) {
+            const ChebyshevPolynomial polynomial(random_coefficients(degree + 1, 8));
+            const size_t points = 10000;
+            if (double(degree + 1) * double(points) > max_work) {
+                continue;
+            }
+            const vector<double> xs = evaluation_points(points);
+            vector<double> out(points);
+            run("chebyshev_evaluate", degree, points, 0, [&] {
+                polynomial.evaluate(xs, out);
+                sink = out[0];
+            });
+        }
+        run("chebyshev_fit", 0, 0, 0, [&] {
+            sink = ChebyshevPolynomial::fit([](double x) { return exp(x); }, -1, 1, 1e-13).error;
+        });
+    }
+};
+
+} // namespace
+
+
+
+
+
+// ===== MAIN =====
+
+int main(int argc, char* argv[]) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        const string argument = argv[i];
+        if (i + 1 >= argc) {
+            cerr << "Missing a value after " << argument << "." << endl;
+            return 2;
+        }
+        const string value = argv[++i];
+        if (argument == "--filter") {
+            options.filter = value;
+        } else if (argument == "--max-degree") {
+            options.max_degree = stoul(value);
+        } else if (argument == "--min-time") {
+            options.min_time = stod(value);
+        } else if (argument == "--threads") {
+            options.threads = parse_thread_list(value);
+        } else if (argument == "--out") {
+            options.out = value;
+        } else if (argument == "--baseline") {
+            options.baseline = value;
+        } else if (argument == "--tolerance") {
+            options.tolerance = stod(value);
+        } else {
+            cerr << argument << " is not a valid option." << endl;
+            return 2;
+        }
+    }
+    if (options.threads.empty()) {
+        const unsigned int hardware = max(1u, thread::hardware_concurrency());
+        for (unsigned int threads = 1; threads < hardware; threads *= 2) {
+            options.threads.push_back(threads);
+        }
+        options.threads.push_back(hardware);
+    }
+
+    Suite suite(options);
+    suite.solve();
+    suite.evaluate();
+    suite.coefficient_types();
+    suite.multiply();
+    suite.power();
+    suite.zero();
+    suite.roots();
+    suite.keyword();
+    suite.format();
+    suite.chebyshev();
+    write_json(options.out, options, suite.get_results());
+
+    if (options.baseline.empty()) {
+        return 0;
+    }
+
+    // A case is a regression when its median is more than tolerance slower than the baseline's.
+    const map<string, double> baseline = read_baseline(options.baseline);
+    int regressions = 0;
+    for (const Result& result : suite.get_results()) {
+        const auto found = baseline.find(result.name);
+        if (found == baseline.end() || found->second <= 0) {
+            continue;
+        }
+        const double ratio = result.ns_per_op / found->second;
+        if (ratio > 1 + options.tolerance) {
+            printf("REGRESSION %-37s %16.1f ns/op, baseline %.1f (%.2fx)\n", result.name.c_str(), result.ns_per_op,
+                   found->second, ratio);
+            regressions++;
+        }
+    }
+    printf("%d of %zu cases slower than the baseline by more than %.0f%%.\n", regressions,
+           suite.get_results().size(), options.tolerance * 100);
+    return regressions > 0 ? 1 : 0;
+}
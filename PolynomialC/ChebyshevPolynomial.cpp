@@ -0,0 +1,693 @@
+//
+// Chebyshev series: Clenshaw evaluation, conversion to and from the monomial basis, Chebyshev
+// interpolation, and the Remez exchange behind ChebyshevPolynomial::fit.
+//
+
+#include "ChebyshevPolynomial.h"
+#include "Kernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numbers>
+#include <stdexcept>
+using namespace std;
+
+namespace {
+
+// ===== HELPER FUNCTIONS =====
+
+void check_interval(double low, double high) {
+    if (!(low < high) || !isfinite(low) || !isfinite(high)) {
+        throw invalid_argument("A Chebyshev polynomial needs a finite interval with low < high.");
+    }
+}
+
+void remove_top_zero_terms(vector<double>& coefficients) {
+    while (coefficients.size() > 1 && coefficients.back() == 0) {
+        coefficients.pop_back();
+    }
+    if (coefficients.empty()) {
+        coefficients.push_back(0);
+    }
+}
+
+// x of a point u of [-1, 1]; the ends map exactly to low and high.
+double from_unit(double u, double low, double high) {
+    if (u <= -1) {
+        return low;
+    }
+    if (u >= 1) {
+        return high;
+    }
+    return (low + high) / 2 + (high - low) / 2 * u;
+}
+
+// Solves matrix * x = rhs (matrix is size x size, row by row) by Gaussian elimination with partial
+// pivoting.  The solution replaces rhs.
+void solve_linear(vector<double>& matrix, vector<double>& rhs, size_t size) {
+    for (size_t column = 0; column < size; column++) {
+        size_t pivot = column;
+        for (size_t row = column + 1; row < size; row++) {
+            if (fabs(matrix[row * size + column]) > fabs(matrix[pivot * size + column])) {
+                pivot = row;
+            }
+        }
+        if (pivot != column) {
+            swap_ranges(matrix.begin() + ptrdiff_t(pivot * size), matrix.begin() + ptrdiff_t((pivot + 1) * size),
+                        matrix.begin() + ptrdiff_t(column * size));
+            swap(rhs[pivot], rhs[column]);
+        }
+        const double diagonal = matrix[column * size + column];
+        for (size_t row = column + 1; row < size; row++) {
+            const double factor = matrix[row * size + column] / diagonal;
+            if (factor == 0) {
+                continue;
+            }
+            for (size_t k = column; k < size; k++) {
+                matrix[row * size + k] -= factor * matrix[column * size + k];
+            }
+            rhs[row] -= factor * rhs[column];
+        }
+    }
+    for (size_t row = size; row-- > 0;) {
+        double sum = rhs[row];
+        for (size_t k = row + 1; k < size; k++) {
+            sum -= matrix[row * size + k] * rhs[k];
+        }
+        rhs[row] = sum / matrix[row * size + row];
+    }
+}
+
+// The best approximation of one degree found by the Remez exchange.
+struct RemezResult {
+    vector<double> coefficients;
+    double error;
+    unsigned int iterations;
+};
+
+// The Remez exchange for the minimax polynomial of one degree.  The reference (degree + 2 points)
+// starts at the extrema of T_(degree + 1), where the truncated Chebyshev series already nearly
+// equioscillates.  Each step solves p(u_i) + (-1)^i E = f(u_i) on the reference, then moves the
+// reference to the largest error of every run of equal sign, found on a grid and refined by golden
+// section search.  It stops once the errors at the reference agree to 1e-6, which puts the result
+// within that fraction of the true minimax error.
+RemezResult remez(const function<double(double)>& f, double low, double high, size_t degree) {
+    const size_t size = degree + 2;
+    const unsigned int max_iterations = 30;
+
+    // A grid with about 16 points per oscillation of the error, denser towards the ends like the
+    // oscillations themselves.  f is sampled on it once.
+    const size_t grid_size = max<size_t>(256, 16 * size);
+    vector<double> grid(grid_size + 1);
+    vector<double> grid_values(grid_size + 1);
+    for (size_t j = 0; j <= grid_size; j++) {
+        grid[j] = -cos(numbers::pi * double(j) / double(grid_size));
+        grid_values[j] = f(from_unit(grid[j], low, high));
+    }
+
+    vector<double> reference(size);
+    for (size_t i = 0; i < size; i++) {
+        reference[i] = -cos(numbers::pi * double(i) / double(size - 1));
+    }
+
+    RemezResult best = {vector<double>(degree + 1, 0.0), numeric_limits<double>::infinity(), 0};
+    vector<double> matrix(size * size);
+    vector<double> rhs(size);
+    vector<double> errors(grid_size + 1);
+    unsigned int stalled = 0;
+    for (unsigned int iteration = 1; iteration <= max_iterations; iteration++) {
+        best.iterations = iteration;
+
+        // The levelled system, with the Chebyshev polynomials of every reference point by recurrence.
+        for (size_t i = 0; i < size; i++) {
+            double* row = matrix.data() + i * size;
+            const double u = reference[i];
+            row[0] = 1;
+            if (degree >= 1) {
+                row[1] = u;
+            }
+            for (size_t k = 2; k <= degree; k++) {
+                row[k] = 2 * u * row[k - 1] - row[k - 2];
+            }
+            row[size - 1] = i % 2 == 0 ? 1 : -1;
+            rhs[i] = f(from_unit(u, low, high));
+        }
+        solve_linear(matrix, rhs, size);
+        vector<double> coefficients(rhs.begin(), rhs.begin() + ptrdiff_t(degree + 1));
+        if (!all_of(coefficients.begin(), coefficients.end(), [](double c) { return isfinite(c); })) {
+            break;
+        }
+
+        auto error_at = [&](double u) {
+            return f(from_unit(u, low, high)) - polynomialc_internal::clenshaw_point(coefficients.data(), degree + 1, u);
+        };
+        for (size_t j = 0; j <= grid_size; j++) {
+            errors[j] = grid_values[j] - polynomialc_internal::clenshaw_point(coefficients.data(), degree + 1, grid[j]);
+        }
+
+        // The largest error of every run of grid points with the same sign, refined between its
+        // neighbors on the grid.
+        vector<double> extrema;
+        vector<double> extreme_errors;
+        size_t j = 0;
+        while (j <= grid_size) {
+            const bool positive = errors[j] >= 0;
+            size_t largest = j;
+            for (; j <= grid_size && (errors[j] >= 0) == positive; j++) {
+                if (fabs(errors[j]) > fabs(errors[largest])) {
+                    largest = j;
+                }
+            }
+
+            double u = grid[largest];
+            double value = errors[largest];
+            if (largest > 0 && largest < grid_size) {
+                const double sign = positive ? 1 : -1;
+                const double golden = (sqrt(5.0) - 1) / 2;
+                double left = grid[largest - 1];
+                double right = grid[largest + 1];
+                double inner_left = right - golden * (right - left);
+                double inner_right = left + golden * (right - left);
+                double value_left = sign * error_at(inner_left);
+                double value_right = sign * error_at(inner_right);
+                for (int step = 0; step < 25; step++) {
+                    if (value_left > value_right) {
+                        right = inner_right;
+                        inner_right = inner_left;
+                        value_right = value_left;
+                        inner_left = right - golden * (right - left);
+                        value_left = sign * error_at(inner_left);
+                    } else {
+                        left = inner_left;
+                        inner_left = inner_right;
+                        value_left = value_right;
+                        inner_right = left + golden * (right - left);
+                        value_right = sign * error_at(inner_right);
+                    }
+                }
+                const double refined = value_left > value_right ? inner_left : inner_right;
+                const double refined_value = sign * max(value_left, value_right);
+                if (fabs(refined_value) > fabs(value)) {
+                    u = refined;
+                    value = refined_value;
+                }
+            }
+            extrema.push_back(u);
+            extreme_errors.push_back(value);
+        }
+
+        double largest_error = 0;
+        for (double value : extreme_errors) {
+            largest_error = max(largest_error, fabs(value));
+        }
+        if (largest_error < best.error) {
+            best.coefficients = coefficients;
+            best.error = largest_error;
+            stalled = 0;
+        } else if (++stalled == 3) {
+            break;
+        }
+
+        // Too few sign changes means the error cannot equioscillate any further (f is itself close to a
+        // polynomial of this degree), so there is nothing left to exchange.
+        if (extrema.size() < size || largest_error == 0) {
+            break;
+        }
+
+        // Extra runs are dropped from the ends, the smaller end first, which keeps the signs
+        // alternating and never drops the largest error.
+        size_t first = 0;
+        size_t last = extrema.size();
+        while (last - first > size) {
+            if (fabs(extreme_errors[first]) < fabs(extreme_errors[last - 1])) {
+                first++;
+            } else {
+                last--;
+            }
+        }
+        double smallest_error = largest_error;
+        for (size_t i = first; i < last; i++) {
+            smallest_error = min(smallest_error, fabs(extreme_errors[i]));
+        }
+        copy(extrema.begin() + ptrdiff_t(first), extrema.begin() + ptrdiff_t(last), reference.begin());
+        if (largest_error - smallest_error <= 1e-6 * largest_error) {
+            break;
+        }
+    }
+    return best;
+}
+
+} // namespace
+
+
+
+
+
+// ===== CLASS CONSTRUCTORS =====
+
+
+/* Default Constructor
+ *
+ * The default constructor creates the zero polynomial on [-1, 1].
+ */
+ChebyshevPolynomial::ChebyshevPolynomial() : coefficient_list{0}, low(-1), high(1) {}
+
+
+/* Coefficient Constructor
+ *
+ * Creates the polynomial c_0 T_0(u) + c_1 T_1(u) + ... on an interval.
+ *
+ * Parameters: The Chebyshev coefficients, c_0 first (Vector of doubles), the ends of the interval.
+ * (Doubles)
+ */
+ChebyshevPolynomial::ChebyshevPolynomial(vector<double> set_coefficient_list, double set_low, double set_high)
+    : coefficient_list(std::move(set_coefficient_list)), low(set_low), high(set_high) {
+    check_interval(low, high);
+    remove_top_zero_terms(coefficient_list);
+}
+
+
+/* Monomial Constructor
+ *
+ * Rewrites a Polynomial (the same function, everywhere) in the Chebyshev basis of an interval.  The
+ * polynomial is first recentered on the middle of the interval, then Horner's scheme runs in the
+ * Chebyshev basis, where multiplying by u turns T_k into (T_(k-1) + T_(k+1)) / 2.  This takes
+ * O(n^2) steps.  A keyword polynomial converts its series coefficients.
+ *
+ * Parameters: The polynomial (Polynomial), the ends of the interval.  (Doubles)
+ */
+ChebyshevPolynomial::ChebyshevPolynomial(const Polynomial& polynomial, double set_low, double set_high)
+    : low(set_low), high(set_high) {
+    check_interval(low, high);
+    const double half = (high - low) / 2;
+    const Polynomial centered = polynomial.recenter((low + high) / 2);
+    span<const double> terms = centered.coefficients();
+
+    vector<double> result;
+    vector<double> shifted;
+    for (size_t i = terms.size(); i-- > 0;) {
+        // result = result * u + terms[i] * half^i
+        shifted.assign(result.size() + 1, 0.0);
+        for (size_t k = 0; k < result.size(); k++) {
+            if (k == 0) {
+                shifted[1] += result[0];
+            } else {
+                shifted[k - 1] += result[k] / 2;
+                shifted[k + 1] += result[k] / 2;
+            }
+        }
+        shifted[0] += terms[i] * pow(half, double(i));
+        result.swap(shifted);
+    }
+    coefficient_list = std::move(result);
+    remove_top_zero_terms(coefficient_list);
+}
+
+
+/* To Polynomial
+ *
+ * Rewrites the polynomial in the monomial basis, as a Polynomial around the middle of the interval
+ * (powers of x - middle stay as well-scaled as the Chebyshev coefficients; powers of x may not).
+ * T_(k+1) = 2u T_k - T_(k-1) gives the monomials of every T_k, in O(n^2) steps.  The monomial basis
+ * is badly conditioned (the coefficients of T_k grow like 2^k), so the conversion is accurate for
+ * the short fits this class is for, and loses about one digit per 3 terms past 30.
+ *
+ * Parameters: None.
+ * Returns: The polynomial.  (Polynomial)
+ */
+Polynomial ChebyshevPolynomial::to_polynomial() const {
+    const size_t n = coefficient_list.size();
+    vector<double> monomials(n, 0.0);
+    vector<double> previous(n, 0.0);
+    vector<double> current(n, 0.0);
+    vector<double> next(n, 0.0);
+    previous[0] = 1;                    // T_0
+    if (n > 1) {
+        current[1] = 1;                 // T_1
+    }
+    for (size_t k = 0; k < n; k++) {
+        const vector<double>& t = k == 0 ? previous : current;
+        for (size_t i = 0; i <= k; i++) {
+            monomials[i] += coefficient_list[k] * t[i];
+        }
+        if (k >= 1 && k + 1 < n) {
+            next[0] = -previous[0];
+            for (size_t i = 1; i <= k + 1; i++) {
+                next[i] = 2 * current[i - 1] - previous[i];
+            }
+            previous.swap(current);
+            current.swap(next);
+        }
+    }
+
+    // Powers of u are powers of (x - middle) / half.
+    const double half = (high - low) / 2;
+    for (size_t i = 0; i < n; i++) {
+        monomials[i] /= pow(half, double(i));
+    }
+    return Polynomial(std::move(monomials), (low + high) / 2);
+}
+
+
+/* Interpolate
+ *
+ * Builds the polynomial with a given number of terms that matches a function at the Chebyshev points
+ * of the interval (the zeros of T_terms).  Its error is within a small factor of the best possible
+ * error for that number of terms, and the coefficients of a smooth function decay quickly, so the
+ * last ones tell how accurate it is.  It calls f terms times and takes O(terms^2) steps.
+ *
+ * Parameters: The function (Callable from double to double), the ends of the interval (Doubles), the
+ * number of terms.  (Size)
+ * Returns: The interpolating polynomial.  (ChebyshevPolynomial)
+ */
+ChebyshevPolynomial ChebyshevPolynomial::interpolate(const function<double(double)>& f, double low, double high,
+                                                     size_t terms) {
+    check_interval(low, high);
+    if (terms == 0) {
+        throw invalid_argument("Chebyshev interpolation needs at least one term.");
+    }
+
+    // c_k = (2 / n) sum_j f(x_j) cos(pi k (2j + 1) / 2n), with c_0 halved.  Every angle is a multiple
+    // of pi / 2n, so the cosines come from one table of 4n entries.
+    const size_t n = terms;
+    vector<double> cosines(4 * n);
+    for (size_t m = 0; m < 4 * n; m++) {
+        cosines[m] = cos(numbers::pi * double(m) / double(2 * n));
+    }
+    vector<double> values(n);
+    for (size_t j = 0; j < n; j++) {
+        values[j] = f(from_unit(cosines[2 * j + 1], low, high));
+    }
+
+    vector<double> coefficients(n, 0.0);
+    for (size_t k = 0; k < n; k++) {
+        double sum = 0;
+        for (size_t j = 0; j < n; j++) {
+            sum += values[j] * cosines[k * (2 * j + 1) % (4 * n)];
+        }
+        coefficients[k] = sum * 2 / double(n);
+    }
+    coefficients[0] /= 2;
+    return ChebyshevPolynomial(std::move(coefficients), low, high);
+}
+
+
+/* Fit
+ *
+ * Builds a near-minimax polynomial for a function on an interval: the polynomial with the fewest
+ * terms whose largest error is within the target, found by the Remez exchange.
+ *  1. Chebyshev interpolants of 16, 32, 64, ... terms are built until their last quarter of
+ *     coefficients adds up to less than the target (or stops shrinking, or max_terms is reached).
+ *  2. Truncating that series where the dropped coefficients add up to half the target gives a
+ *     starting degree, since |T_k| <= 1 bounds the error of the truncation.
+ *  3. The Remez exchange finds the minimax polynomial of that degree.  Its error is usually well
+ *     below the truncation bound, so the lowest degree that still meets the target is searched for
+ *     below it (and higher degrees are tried if the first did not meet it).
+ * Non-smooth functions (|x|, for one) converge slowly and may need more than max_terms, and a target
+ * below the rounding error of f (the error is absolute, so about 1e-16 times the size of f) cannot be
+ * met at all; the result is then the best fit found, with converged false.
+ *
+ * Parameters: The function (Callable from double to double), the ends of the interval (Doubles), the
+ * largest error accepted (Double), the most terms to use.  (Size)
+ * Returns: The fit and how it went.  (ChebyshevFit)
+ * - polynomial: The polynomial.
+ * - error: The largest |f(x) - p(x)| found on the interval.
+ * - iterations: Remez exchanges over every degree that was tried.
+ * - converged: Whether error <= target_error.
+ */
+ChebyshevFit ChebyshevPolynomial::fit(const function<double(double)>& f, double low, double high,
+                                      double target_error, size_t max_terms) {
+    check_interval(low, high);
+    if (!(target_error > 0)) {
+        throw invalid_argument("The target error of a Chebyshev fit must be positive.");
+    }
+    if (max_terms == 0) {
+        throw invalid_argument("A Chebyshev fit needs at least one term.");
+    }
+
+    // 1. A converged Chebyshev series.
+    size_t terms = min<size_t>(16, max_terms);
+    ChebyshevPolynomial series;
+    double previous_tail = numeric_limits<double>::infinity();
+    while (true) {
+        series = interpolate(f, low, high, terms);
+        double tail = 0;
+        for (size_t k = terms - terms / 4; k < series.coefficient_list.size(); k++) {
+            tail += fabs(series.coefficient_list[k]);
+        }
+        // A tail that stops shrinking has reached the rounding error of f.
+        if (tail <= target_error / 4 || terms == max_terms || tail >= previous_tail) {
+            break;
+        }
+        previous_tail = tail;
+        terms = min(2 * terms, max_terms);
+    }
+
+    // 2. The truncation bound.
+    size_t degree = series.coefficient_list.size() - 1;
+    double dropped = 0;
+    while (degree > 0 && dropped + fabs(series.coefficient_list[degree]) <= target_error / 2) {
+        dropped += fabs(series.coefficient_list[degree]);
+        degree--;
+    }
+
+    // 3. Minimax fits around that degree.
+    ChebyshevFit result = {ChebyshevPolynomial(), numeric_limits<double>::infinity(), 0, false};
+    auto attempt = [&](size_t fit_degree) {
+        RemezResult remezed = remez(f, low, high, fit_degree);
+        result.iterations += remezed.iterations;
+        const bool within = remezed.error <= target_error;
+        if (within || (!result.converged && remezed.error < result.error)) {
+            result.polynomial = ChebyshevPolynomial(std::move(remezed.coefficients), low, high);
+            result.error = remezed.error;
+            result.converged = within;
+        }
+        return within;
+    };
+    if (attempt(degree)) {
+        // Near the rounding error the error no longer falls steadily with the degree, so one failure
+        // below a passing degree does not mean every lower degree fails.  Steps of 1, 2, 4, ... find a
+        // failing degree, and a binary search between it and the lowest passing one finishes.
+        size_t step = 1;
+        size_t failing = 0;
+        bool found_failing = false;
+        while (degree > 0 && !found_failing) {
+            const size_t lower = degree > step ? degree - step : 0;
+            if (attempt(lower)) {
+                degree = lower;
+                step *= 2;
+            } else {
+                failing = lower;
+                found_failing = true;
+            }
+        }
+        while (found_failing && failing + 1 < degree) {
+            const size_t middle = failing + (degree - failing) / 2;
+            if (attempt(middle)) {
+                degree = middle;
+            } else {
+                failing = middle;
+            }
+        }
+    } else {
+        // Past the rounding error of f and of the evaluation, more terms stop helping; the search
+        // gives up after 3 degrees that do not halve the error.
+        double previous_error = result.error;
+        unsigned int no_progress = 0;
+        while (degree + 1 < max_terms && !attempt(++degree)) {
+            if (result.error > previous_error / 2) {
+                if (++no_progress == 3) {
+                    break;
+                }
+            } else {
+                no_progress = 0;
+            }
+            previous_error = min(previous_error, result.error);
+        }
+    }
+    return result;
+}
+
+
+
+
+
+// ===== CLASS GETTERS =====
+
+
+/* Coefficients
+ *
+ * Returns a read-only view of the Chebyshev coefficients, c_0 first.
+ *
+ * Parameters: None.
+ * Returns: The coefficients.  (Span of doubles)
+ */
+span<const double> ChebyshevPolynomial::coefficients() const {
+    return coefficient_list;
+}
+
+
+/* Get Low and Get High
+ *
+ * Return the ends of the interval the polynomial is written for.
+ *
+ * Parameters: None.
+ * Returns: The end of the interval.  (Double)
+ */
+double ChebyshevPolynomial::get_low() const {
+    return low;
+}
+
+double ChebyshevPolynomial::get_high() const {
+    return high;
+}
+
+
+/* Degree
+ *
+ * Returns the degree of the polynomial, the number of coefficients minus 1.
+ *
+ * Parameters: None.
+ * Returns: The degree.  (Size)
+ */
+size_t ChebyshevPolynomial::degree() const {
+    return coefficient_list.size() - 1;
+}
+
+
+
+
+
+// ===== CLASS FUNCTIONS =====
+
+
+/* Solve
+ *
+ * Solves the polynomial at x with Clenshaw's recurrence, which takes 2 multiplications and 2
+ * additions per term and, unlike summing the T_k(u) directly, stays accurate on the whole interval.
+ * Outside of the interval the polynomial is still evaluated, but it no longer approximates anything
+ * in particular.
+ *
+ * Parameters: The value of x.  (Double)
+ * Returns: The value of the polynomial.  (Double)
+ */
+double ChebyshevPolynomial::solve(double x) const {
+    const double u = (2 * x - low - high) / (high - low);
+    return polynomialc_internal::clenshaw_point(coefficient_list.data(), coefficient_list.size(), u);
+}
+
+
+/* Evaluate
+ *
+ * Solves the polynomial at many values of x.  Blocks of points run through Clenshaw's recurrence
+ * together, with AVX2 when the CPU supports it.
+ *
+ * Parameters: The values of x (Span of doubles), where to write the results (Span of doubles, same
+ * size as the values of x).
+ * Returns: None.
+ */
+void ChebyshevPolynomial::evaluate(span<const double> xs, span<double> out) const {
+    if (xs.size() != out.size()) {
+        throw invalid_argument("Chebyshev polynomial evaluate size mismatch.");
+    }
+
+    polynomialc_internal::clenshaw_batch(coefficient_list.data(), coefficient_list.size(), 2 / (high - low),
+                                         (low + high) / (high - low), xs.data(), out.data(), xs.size());
+}
+
+
+/* Differentiate
+ *
+ * Differentiates the polynomial with respect to x, in the Chebyshev basis of the same interval:
+ * d_(k-1) = d_(k+1) + 2k c_k from the top down, with d_0 halved, times du/dx = 2 / (high - low).
+ *
+ * Parameters: None.
+ * Returns: The derivative.  (ChebyshevPolynomial)
+ */
+ChebyshevPolynomial ChebyshevPolynomial::differentiate() const {
+    const size_t n = coefficient_list.size();
+    if (n <= 1) {
+        return ChebyshevPolynomial(vector<double>{0}, low, high);
+    }
+    vector<double> derivative(n + 1, 0.0);
+    for (size_t k = n - 1; k >= 1; k--) {
+        derivative[k - 1] = derivative[k + 1] + 2 * double(k) * coefficient_list[k];
+    }
+    derivative[0] /= 2;
+    derivative.resize(n - 1);
+    const double scale = 2 / (high - low);
+    for (double& coefficient : derivative) {
+        coefficient *= scale;
+    }
+    return ChebyshevPolynomial(std::move(derivative), low, high);
+}
+
+
+/* Truncate
+ *
+ * Drops the highest terms as long as the absolute values of the dropped coefficients add up to at
+ * most the tolerance, which (since |T_k| <= 1) bounds the change anywhere on the interval.
+ *
+ * Parameters: The largest change allowed.  (Double)
+ * Returns: The shorter polynomial.  (ChebyshevPolynomial)
+ */
+ChebyshevPolynomial ChebyshevPolynomial::truncate(double tolerance) const {
+    size_t size = coefficient_list.size();
+    double dropped = 0;
+    while (size > 1 && dropped + fabs(coefficient_list[size - 1]) <= tolerance) {
+        dropped += fabs(coefficient_list[size - 1]);
+        size--;
+    }
+    return ChebyshevPolynomial(vector<double>(coefficient_list.begin(), coefficient_list.begin() + ptrdiff_t(size)),
+                               low, high);
+}
+
+
+
+
+
+// ===== MISCELLANEOUS OPERATIONS =====
+
+
+/* Square Bracket Operator
+ *
+ * Returns the coefficient of T_k (0 past the degree).
+ *
+ * Parameters: The index k.  (Size)
+ * Returns: The coefficient.  (Double)
+ */
+double ChebyshevPolynomial::operator[](size_t k) const {
+    return k < coefficient_list.size() ? coefficient_list[k] : 0.0;
+}
+
+
+/* Parentheses Operator
+ *
+ * Solves the polynomial at x, see solve.
+ *
+ * Parameters: The input number, x.  (Double)
+ * Returns: The result of the polynomial.  (Double)
+ */
+double ChebyshevPolynomial::operator()(double x) const {
+    return solve(x);
+}
+
+
+/* Angle Bracket Operator
+ *
+ * Prints the terms from T_0 up and the interval, such as 1.26607T0 + 1.13032T1 + 0.271495T2 on [-1, 1].
+ *
+ * Parameters: The output stream (Ostream), the polynomial.  (ChebyshevPolynomial)
+ * Returns: The output stream.  (Ostream)
+ */
+ostream& operator<<(ostream& out, const ChebyshevPolynomial& obj) {
+    span<const double> coefficients = obj.coefficients();
+    for (size_t k = 0; k < coefficients.size(); k++) {
+        if (k > 0) {
+            out << " + ";
+        }
+        out << coefficients[k] << "T" << k;
+    }
+    return out << " on [" << obj.get_low() << ", " << obj.get_high() << "]";
+}
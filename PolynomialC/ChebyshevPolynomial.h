@@ -0,0 +1,72 @@
+//
+// A polynomial in the Chebyshev basis on an interval [low, high]: c_0 T_0(u) + c_1 T_1(u) + ... with
+// u = (2x - low - high) / (high - low), so u runs over [-1, 1] while x runs over the interval.  On
+// its interval a Chebyshev series converges about as fast as the best possible polynomial, where a
+// Taylor series around one point needs far more terms (the keyword constructor keeps 1000), and its
+// coefficients stay small, so it is evaluated stably with Clenshaw's recurrence.
+//
+// ChebyshevPolynomial::fit builds a near-minimax approximation of any function to a target error:
+//
+//     ChebyshevFit fit = ChebyshevPolynomial::fit([](double x) { return exp(x); }, -1, 1, 1e-13);
+//     double y = fit.polynomial(0.3);              // 13 terms, |e^x - y| <= fit.error on [-1, 1]
+//     Polynomial p = fit.polynomial.to_polynomial();
+//
+
+#ifndef POLYNOMIALC_CHEBYSHEVPOLYNOMIAL_H
+#define POLYNOMIALC_CHEBYSHEVPOLYNOMIAL_H
+
+#include "PolynomialC.h"
+
+#include <cstddef>
+#include <functional>
+#include <span>
+#include <vector>
+
+struct ChebyshevFit;
+
+class ChebyshevPolynomial {
+    // coefficient_list[k] multiplies T_k(u).  Trailing zeros are dropped, but the list always holds
+    // at least one coefficient.
+    vector<double> coefficient_list;
+    double low;
+    double high;
+
+public:
+    // Class Constructors
+    ChebyshevPolynomial();
+    ChebyshevPolynomial(vector<double> set_coefficient_list, double set_low=-1, double set_high=1);
+    ChebyshevPolynomial(const Polynomial& polynomial, double set_low, double set_high);
+    Polynomial to_polynomial() const;
+    static ChebyshevPolynomial interpolate(const function<double(double)>& f, double low, double high,
+                                           size_t terms);
+    static ChebyshevFit fit(const function<double(double)>& f, double low, double high, double target_error,
+                            size_t max_terms=100);
+
+    // Class Getters
+    span<const double> coefficients() const;
+    double get_low() const;
+    double get_high() const;
+    size_t degree() const;
+
+    // Class Functions
+    double solve(double x) const;
+    void evaluate(span<const double> xs, span<double> out) const;
+    ChebyshevPolynomial differentiate() const;
+    ChebyshevPolynomial truncate(double tolerance) const;
+
+    // Miscellaneous Operations
+    double operator[](size_t k) const;
+    double operator()(double x) const;
+};
+
+// The outcome of ChebyshevPolynomial::fit.
+struct ChebyshevFit {
+    ChebyshevPolynomial polynomial;
+    double error;               // The largest |f(x) - p(x)| found on the interval.
+    unsigned int iterations;    // Remez exchanges over every degree that was tried.
+    bool converged;             // Whether error is within the target.
+};
+
+ostream& operator<<(ostream& out, const ChebyshevPolynomial& obj);
+
+#endif //POLYNOMIALC_CHEBYSHEVPOLYNOMIAL_H
@@ -0,0 +1,185 @@
+//
+// The coefficient storage of a Polynomial.  Up to POLYNOMIALC_INLINE_TERMS coefficients are kept
+// inside the object itself, so low-degree polynomials never touch the heap; longer lists move to a
+// vector that allocates from the list's memory resource (see PolynomialMemory.h).
+//
+
+#ifndef POLYNOMIALC_COEFFICIENTLIST_H
+#define POLYNOMIALC_COEFFICIENTLIST_H
+
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
+#include <memory_resource>
+#include <span>
+#include <vector>
+
+#include "PolynomialMemory.h"
+
+// The number of coefficients stored inline (degree 7 by default).  Every Polynomial carries this many
+// doubles, so raising it trades memory for fewer allocations.  It changes the layout of Polynomial, so
+// the library and everything using it must agree: set it with cmake -DPOLYNOMIALC_INLINE_TERMS=n,
+// which defines it for the library and for every target that links it.
+#ifndef POLYNOMIALC_INLINE_TERMS
+#define POLYNOMIALC_INLINE_TERMS 8
+#endif
+
+template <std::size_t InlineCapacity>
+class BasicCoefficientList {
+    static_assert(InlineCapacity > 0, "The inline capacity must hold at least one coefficient.");
+
+    // While on_heap is false the coefficients are the first count elements of small; afterwards they
+    // are all of large.  A list that has moved to the heap stays there, so it does not bounce back and
+    // forth around the inline capacity.  large takes the thread's polynomial resource when the list is
+    // created, and keeps it for the life of the list.
+    double small[InlineCapacity];
+    std::size_t count = 0;
+    std::pmr::vector<double> large{polynomial_resource()};
+    bool on_heap = false;
+
+    void move_to_heap(std::size_t capacity) {
+        large.reserve(std::max(capacity, 2 * InlineCapacity));
+        large.assign(small, small + count);
+        on_heap = true;
+    }
+
+public:
+    BasicCoefficientList() = default;
+
+    explicit BasicCoefficientList(std::pmr::memory_resource* resource) : large(resource) {}
+
+    BasicCoefficientList(std::size_t size, double value) {
+        resize(size, value);
+    }
+
+    BasicCoefficientList(std::initializer_list<double> values) {
+        assign(std::span<const double>(values.begin(), values.size()));
+    }
+
+    explicit BasicCoefficientList(std::span<const double> values) {
+        assign(values);
+    }
+
+    BasicCoefficientList(const BasicCoefficientList& other) {
+        assign(std::span<const double>(other.data(), other.size()));
+    }
+
+    // A moved list takes over the heap storage, and the memory resource, of the other list.
+    BasicCoefficientList(BasicCoefficientList&& other) noexcept
+        : count(other.count), large(std::move(other.large)), on_heap(other.on_heap) {
+        if (!on_heap) {
+            std::copy(other.small, other.small + other.count, small);
+        }
+        other.clear();
+    }
+
+    BasicCoefficientList& operator=(const BasicCoefficientList& other) {
+        if (this != &other) {
+            assign(std::span<const double>(other.data(), other.size()));
+        }
+        return *this;
+    }
+
+    // Assignment keeps the memory resource of this list, so the coefficients are copied (not taken
+    // over) when the two lists use different resources.
+    BasicCoefficientList& operator=(BasicCoefficientList&& other) {
+        if (this == &other) {
+            return *this;
+        }
+        if (other.on_heap) {
+            large = std::move(other.large);
+            on_heap = true;
+            count = 0;
+        } else {
+            std::copy(other.small, other.small + other.count, small);
+            count = other.count;
+            large.clear();
+            on_heap = false;
+        }
+        other.clear();
+        return *this;
+    }
+
+    void assign(std::span<const double> values) {
+        if (on_heap) {
+            large.assign(values.begin(), values.end());
+        } else if (values.size() <= InlineCapacity) {
+            std::copy(values.begin(), values.end(), small);
+            count = values.size();
+        } else {
+            large.assign(values.begin(), values.end());
+            on_heap = true;
+        }
+    }
+
+    std::size_t size() const { return on_heap ? large.size() : count; }
+    bool empty() const { return size() == 0; }
+    bool is_inline() const { return !on_heap; }
+
+    double* data() { return on_heap ? large.data() : small; }
+    const double* data() const { return on_heap ? large.data() : small; }
+    double* begin() { return data(); }
+    double* end() { return data() + size(); }
+    const double* begin() const { return data(); }
+    const double* end() const { return data() + size(); }
+
+    double& operator[](std::size_t i) { return data()[i]; }
+    double operator[](std::size_t i) const { return data()[i]; }
+    double& back() { return data()[size() - 1]; }
+    double back() const { return data()[size() - 1]; }
+
+    void push_back(double value) {
+        if (!on_heap && count == InlineCapacity) {
+            move_to_heap(count + 1);
+        }
+        if (on_heap) {
+            large.push_back(value);
+        } else {
+            small[count++] = value;
+        }
+    }
+
+    void pop_back() {
+        if (on_heap) {
+            large.pop_back();
+        } else {
+            count--;
+        }
+    }
+
+    void resize(std::size_t size, double value = 0) {
+        if (!on_heap && size > InlineCapacity) {
+            move_to_heap(size);
+        }
+        if (on_heap) {
+            large.resize(size, value);
+        } else {
+            if (size > count) {
+                std::fill(small + count, small + size, value);
+            }
+            count = size;
+        }
+    }
+
+    void clear() {
+        large.clear();
+        count = 0;
+        on_heap = false;
+    }
+
+    std::pmr::memory_resource* resource() const {
+        return large.get_allocator().resource();
+    }
+
+    std::vector<double> to_vector() const {
+        return std::vector<double>(begin(), end());
+    }
+
+    operator std::span<const double>() const {
+        return {data(), size()};
+    }
+};
+
+using CoefficientList = BasicCoefficientList<POLYNOMIALC_INLINE_TERMS>;
+
+#endif //POLYNOMIALC_COEFFICIENTLIST_H
@@ -0,0 +1,207 @@
+//
+// Changes of variable: Taylor shifts, which rewrite a polynomial around another center, compositions
+// p(q(t)) with the Brent-Kung baby-step giant-step scheme, and reversions of power series.  Every
+// product goes through multiply_fast.
+//
+
+#include "Kernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+using namespace std;
+
+namespace polynomialc_internal {
+namespace {
+
+// ===== HELPERS =====
+
+vector<double> binomial_power(double shift, size_t m) {
+    // The coefficients of (t + shift)^m, C(m, j) * shift^(m - j), from the top one down.  Each one
+    // comes from the one above with a single product and quotient, so every coefficient is within
+    // about 3m ulps.
+    vector<double> power(m + 1);
+    power[m] = 1;
+    for (size_t j = m; j > 0; j--) {
+        power[j - 1] = power[j] * shift * double(j) / double(m - j + 1);
+    }
+    return power;
+}
+
+void shift_halves(double* coefficients, size_t n, double shift, const vector<vector<double>>& powers,
+                  size_t level, vector<double>& product) {
+    // p = low + t^m * high, with m the largest power of two below n, so p(t + shift) is
+    // low(t + shift) + (t + shift)^m * high(t + shift).  powers[k] is (t + shift)^(2^k), shared by
+    // every call of the same size.
+    if (n < taylor_shift_cutoff) {
+        taylor_shift_horner(coefficients, n, shift);
+        return;
+    }
+    while ((size_t(1) << level) >= n) {
+        level--;
+    }
+    const size_t m = size_t(1) << level;
+    shift_halves(coefficients, m, shift, powers, level, product);
+    shift_halves(coefficients + m, n - m, shift, powers, level, product);
+
+    // (n - m) + (m + 1) - 1 = n terms: the low half adds to the bottom m, the top n - m are replaced.
+    product.resize(n);
+    multiply_fast(coefficients + m, n - m, powers[level].data(), m + 1, product.data());
+    for (size_t i = 0; i < m; i++) {
+        coefficients[i] += product[i];
+    }
+    copy(product.begin() + m, product.begin() + n, coefficients + m);
+}
+
+
+void truncated_product(const vector<double>& a, const vector<double>& b, size_t count, vector<double>& out) {
+    // The product of two nonempty series, without the terms at or above count.
+    out.resize(min(a.size() + b.size() - 1, count));
+    multiply_fast_low(a.data(), a.size(), b.data(), b.size(), out.data(), out.size());
+}
+
+} // namespace
+
+
+// ===== TAYLOR SHIFTS =====
+
+void taylor_shift_horner(double* coefficients, size_t n, double shift) {
+    // Repeated synthetic division by (t - shift); each pass fixes one more coefficient from the bottom.
+    for (size_t i = 0; i + 1 < n; i++) {
+        for (size_t j = n - 1; j-- > i;) {
+            coefficients[j] += shift * coefficients[j + 1];
+        }
+    }
+}
+
+void taylor_shift_divide_conquer(double* coefficients, size_t n, double shift) {
+    if (n < 2 || shift == 0) {
+        return;
+    }
+    vector<vector<double>> powers;
+    size_t level = 0;
+    while ((size_t(1) << level) < n) {
+        powers.push_back(binomial_power(shift, size_t(1) << level));
+        level++;
+    }
+    vector<double> product;
+    shift_halves(coefficients, n, shift, powers, level, product);
+}
+
+void taylor_shift(double* coefficients, size_t n, double shift) {
+    if (n < taylor_shift_cutoff) {
+        taylor_shift_horner(coefficients, n, shift);
+    } else {
+        taylor_shift_divide_conquer(coefficients, n, shift);
+    }
+}
+
+
+
+
+// ===== COMPOSITIONS =====
+
+void compose(const double* p, size_t n, const double* q, size_t m, double* out, size_t count) {
+    fill(out, out + count, 0.0);
+    if (n == 0 || count == 0) {
+        return;
+    }
+    if (n == 1 || m < 2) {
+        // A constant p, or a constant q, makes a constant.
+        const double t = m == 0 ? 0.0 : q[0];
+        double value = 0;
+        for (size_t i = n; i-- > 0;) {
+            value = value * t + p[i];
+        }
+        out[0] = value;
+        return;
+    }
+
+    // Brent-Kung: with k = ceil(sqrt(n)), p is cut into blocks of k coefficients, p = sum(P_j(t) *
+    // t^(jk)), so p(q) = sum(P_j(q) * (q^k)^j).  The baby steps q^0 ... q^(k-1) are shared by every
+    // block, which is then only a sum of scaled baby steps, and the blocks are combined with
+    // Horner's scheme in the giant step q^k.  That is about 2 sqrt(n) products instead of n.
+    const size_t k = size_t(ceil(sqrt(double(n))));
+    vector<vector<double>> baby(k);
+    baby[0] = {1.0};
+    baby[1].assign(q, q + min(m, count));
+    for (size_t i = 2; i < k; i++) {
+        truncated_product(baby[i - 1], baby[1], count, baby[i]);
+    }
+    vector<double> giant;
+    truncated_product(baby[k - 1], baby[1], count, giant);
+
+    const auto add_block = [&](size_t j, vector<double>& target) {
+        // target += P_j(q), which target must be long enough to hold.
+        for (size_t i = 0; i < k && j * k + i < n; i++) {
+            const double c = p[j * k + i];
+            const vector<double>& power = baby[i];
+            for (size_t t = 0; t < power.size(); t++) {
+                target[t] += c * power[t];
+            }
+        }
+    };
+
+    const size_t blocks = (n + k - 1) / k;
+    vector<double> result(baby[min(k, n - (blocks - 1) * k) - 1].size(), 0.0);
+    add_block(blocks - 1, result);
+    vector<double> product;
+    for (size_t j = blocks - 1; j-- > 0;) {
+        // The product is at least as long as the giant step, so it can hold every baby step.
+        truncated_product(result, giant, count, product);
+        add_block(j, product);
+        swap(result, product);
+    }
+    copy(result.begin(), result.end(), out);
+}
+
+
+// ===== REVERSIONS =====
+
+void revert_series(const double* f, size_t m, double* out, size_t count) {
+    fill(out, out + count, 0.0);
+    if (count < 2) {
+        return;
+    }
+    m = min(m, count);
+
+    // Newton's iteration on f(g) = s doubles the number of correct terms of g each step:
+    // g <- g - (f(g) - s) / f'(g).  With h = f(g), f'(g) = h' / g', so every step costs one
+    // composition, one reciprocal and two products of the new length.
+    vector<double> g = {0.0, 1.0 / f[1]};
+    vector<double> h;
+    vector<double> quotient;
+    vector<double> correction;
+    vector<double> slope;
+    vector<double> inverse;
+    for (size_t length = 2; length < count;) {
+        const size_t next = min(2 * length, count);
+        h.resize(next);
+        compose(f, m, g.data(), g.size(), h.data(), next);
+
+        // h' and g', then g' / h'.
+        slope.resize(next - 1);
+        for (size_t i = 0; i + 1 < next; i++) {
+            slope[i] = h[i + 1] * double(i + 1);
+        }
+        inverse.resize(next);
+        reciprocal_series(slope.data(), slope.size(), inverse.data(), next);
+        slope.resize(g.size() - 1);
+        for (size_t i = 0; i + 1 < g.size(); i++) {
+            slope[i] = g[i + 1] * double(i + 1);
+        }
+        truncated_product(slope, inverse, next, quotient);
+
+        // f(g) - s, whose first length terms are only rounding errors.
+        h[1] -= 1.0;
+        truncated_product(h, quotient, next, correction);
+        g.resize(next, 0.0);
+        for (size_t i = 0; i < correction.size(); i++) {
+            g[i] -= correction[i];
+        }
+        length = next;
+    }
+    copy(g.begin(), g.begin() + min(g.size(), count), out);
+}
+
+} // namespace polynomialc_internal
@@ -0,0 +1,108 @@
+//
+// Polynomial division: long division for short quotients or divisors, and division through a
+// Newton-iteration reciprocal series (on top of the multiplication engine) for long ones.
+//
+
+#include "Kernels.h"
+#include "Instrumentation.h"
+
+#include <algorithm>
+#include <vector>
+using namespace std;
+
+namespace polynomialc_internal {
+
+// ===== RECIPROCAL SERIES =====
+
+void reciprocal_series(const double* b, size_t m, double* out, size_t count) {
+    if (count == 0) {
+        return;
+    }
+
+    // Newton's iteration g <- g * (2 - b * g) doubles the number of correct terms each step.  The
+    // first `length` terms of b * g are already 1, 0, 0, ..., so only the next ones are computed,
+    // and the new terms of g are -g times them.
+    out[0] = 1.0 / b[0];
+    vector<double> product;
+    vector<double> correction;
+    for (size_t length = 1; length < count;) {
+        const size_t next = min(2 * length, count);
+        product.resize(next);
+        multiply_fast_low(b, min(m, next), out, length, product.data(), next);
+
+        const size_t added = next - length;
+        correction.resize(added);
+        multiply_fast_low(out, min(length, added), product.data() + length, added, correction.data(), added);
+        for (size_t i = 0; i < added; i++) {
+            out[length + i] = -correction[i];
+        }
+        length = next;
+    }
+}
+
+
+// ===== DIVISION =====
+
+void divide_long(const double* a, size_t n, const double* b, size_t m, double* quotient, double* remainder) {
+    // Schoolbook long division from the top term down.  The inner loop walks the running remainder
+    // and b contiguously so the compiler can vectorize it.
+    vector<double> running(a, a + n);
+    const double lead = b[m - 1];
+    count(PolynomialCounter::flops, (n - m + 1) * (2 * m + 1));
+    for (size_t k = n - m + 1; k-- > 0;) {
+        const double q = running[k + m - 1] / lead;
+        quotient[k] = q;
+        for (size_t j = 0; j < m; j++) {
+            running[k + j] -= q * b[j];
+        }
+    }
+    copy(running.begin(), running.begin() + (m - 1), remainder);
+}
+
+void divide_newton(const double* a, size_t n, const double* b, size_t m, double* quotient, double* remainder) {
+    // With k = n - m + 1 quotient terms, reversing the coefficients turns the division into a
+    // power series product: rev(q) = rev(a) / rev(b) mod x^k.  The remainder is then a - b * q, of
+    // which only the lowest m - 1 terms are not 0.
+    const size_t k = n - m + 1;
+    const size_t used = min(m, k);
+
+    vector<double> reversed_b(used);
+    for (size_t i = 0; i < used; i++) {
+        reversed_b[i] = b[m - 1 - i];
+    }
+    vector<double> inverse(k);
+    reciprocal_series(reversed_b.data(), used, inverse.data(), k);
+
+    vector<double> reversed_a(k);
+    for (size_t i = 0; i < k; i++) {
+        reversed_a[i] = a[n - 1 - i];
+    }
+    vector<double> reversed_q(k);
+    multiply_fast_low(reversed_a.data(), k, inverse.data(), k, reversed_q.data(), k);
+    for (size_t i = 0; i < k; i++) {
+        quotient[i] = reversed_q[k - 1 - i];
+    }
+
+    if (m > 1) {
+        vector<double> low(m - 1);
+        multiply_fast_low(b, m, quotient, k, low.data(), m - 1);
+        for (size_t i = 0; i < m - 1; i++) {
+            remainder[i] = a[i] - low[i];
+        }
+    }
+}
+
+void divide(const double* a, size_t n, const double* b, size_t m, double* quotient, double* remainder) {
+    if (n < m) {
+        copy(a, a + n, remainder);
+        fill(remainder + n, remainder + (m - 1), 0.0);
+        return;
+    }
+    if (min(n - m + 1, m) < newton_division_cutoff) {
+        divide_long(a, n, b, m, quotient, remainder);
+    } else {
+        divide_newton(a, n, b, m, quotient, remainder);
+    }
+}
+
+} // namespace polynomialc_internal
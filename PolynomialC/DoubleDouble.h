@@ -0,0 +1,118 @@
+//
+// A double-double number: an unevaluated sum hi + lo of two doubles with |lo| <= ulp(hi) / 2, which
+// carries about 106 bits of significand.  It is built from error-free transformations (two_sum and an
+// FMA-based two_prod), so it runs at the speed of plain double arithmetic instead of the x87 long
+// double path, and gives the same result on every platform.
+//
+// The range is the range of double; there is no special handling of overflow, NaN or infinity.
+//
+
+#ifndef POLYNOMIALC_DOUBLEDOUBLE_H
+#define POLYNOMIALC_DOUBLEDOUBLE_H
+
+#include <cmath>
+#include <ostream>
+
+struct DoubleDouble {
+    double hi = 0;
+    double lo = 0;
+
+    constexpr DoubleDouble() = default;
+    constexpr DoubleDouble(double value) : hi(value), lo(0) {}
+    constexpr DoubleDouble(double set_hi, double set_lo) : hi(set_hi), lo(set_lo) {}
+
+    explicit constexpr operator double() const { return hi + lo; }
+    explicit constexpr operator long double() const { return (long double) hi + (long double) lo; }
+
+    // ===== ERROR-FREE TRANSFORMATIONS =====
+
+    // a + b = sum + error exactly, for any a and b.
+    static constexpr DoubleDouble two_sum(double a, double b) {
+        double sum = a + b;
+        double b_virtual = sum - a;
+        double error = (a - (sum - b_virtual)) + (b - b_virtual);
+        return {sum, error};
+    }
+
+    // a + b = sum + error exactly, when |a| >= |b|.
+    static constexpr DoubleDouble quick_two_sum(double a, double b) {
+        double sum = a + b;
+        return {sum, b - (sum - a)};
+    }
+
+    // a * b = product + error exactly (barring underflow).
+    static DoubleDouble two_prod(double a, double b) {
+        double product = a * b;
+        return {product, std::fma(a, b, -product)};
+    }
+
+    // ===== ARITHMETIC =====
+
+    friend constexpr DoubleDouble operator+(const DoubleDouble& x, const DoubleDouble& y) {
+        DoubleDouble high = two_sum(x.hi, y.hi);
+        DoubleDouble low = two_sum(x.lo, y.lo);
+        high.lo += low.hi;
+        high = quick_two_sum(high.hi, high.lo);
+        high.lo += low.lo;
+        return quick_two_sum(high.hi, high.lo);
+    }
+
+    friend constexpr DoubleDouble operator-(const DoubleDouble& x) {
+        return {-x.hi, -x.lo};
+    }
+
+    friend constexpr DoubleDouble operator-(const DoubleDouble& x, const DoubleDouble& y) {
+        return x + (-y);
+    }
+
+    friend DoubleDouble operator*(const DoubleDouble& x, const DoubleDouble& y) {
+        DoubleDouble product = two_prod(x.hi, y.hi);
+        product.lo += x.hi * y.lo + x.lo * y.hi;
+        return quick_two_sum(product.hi, product.lo);
+    }
+
+    // Long division: one quotient digit per double, each corrected with the exact remainder.
+    friend DoubleDouble operator/(const DoubleDouble& x, const DoubleDouble& y) {
+        double first = x.hi / y.hi;
+        DoubleDouble remainder = x - y * DoubleDouble(first);
+        double second = remainder.hi / y.hi;
+        remainder = remainder - y * DoubleDouble(second);
+        double third = remainder.hi / y.hi;
+        DoubleDouble quotient = quick_two_sum(first, second);
+        return quotient + DoubleDouble(third);
+    }
+
+    DoubleDouble& operator+=(const DoubleDouble& other) { return *this = *this + other; }
+    DoubleDouble& operator-=(const DoubleDouble& other) { return *this = *this - other; }
+    DoubleDouble& operator*=(const DoubleDouble& other) { return *this = *this * other; }
+    DoubleDouble& operator/=(const DoubleDouble& other) { return *this = *this / other; }
+
+    // ===== COMPARISONS =====
+
+    friend constexpr bool operator==(const DoubleDouble& x, const DoubleDouble& y) {
+        return x.hi == y.hi && x.lo == y.lo;
+    }
+
+    friend constexpr bool operator!=(const DoubleDouble& x, const DoubleDouble& y) {
+        return !(x == y);
+    }
+
+    friend constexpr bool operator<(const DoubleDouble& x, const DoubleDouble& y) {
+        return x.hi < y.hi || (x.hi == y.hi && x.lo < y.lo);
+    }
+
+    friend constexpr bool operator>(const DoubleDouble& x, const DoubleDouble& y) { return y < x; }
+    friend constexpr bool operator<=(const DoubleDouble& x, const DoubleDouble& y) { return !(y < x); }
+    friend constexpr bool operator>=(const DoubleDouble& x, const DoubleDouble& y) { return !(x < y); }
+};
+
+inline DoubleDouble abs(const DoubleDouble& x) {
+    return x.hi < 0 ? -x : x;
+}
+
+// Prints the value rounded to double; read hi and lo for the full precision.
+inline std::ostream& operator<<(std::ostream& out, const DoubleDouble& x) {
+    return out << (double) x;
+}
+
+#endif //POLYNOMIALC_DOUBLEDOUBLE_H
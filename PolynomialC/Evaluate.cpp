@@ -0,0 +1,470 @@
+//
+// Batched Horner evaluation kernels with runtime CPU dispatch.
+//
+
+#include "Kernels.h"
+#include "Instrumentation.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define POLYNOMIALC_X86_DISPATCH 1
+#include <immintrin.h>
+#endif
+
+namespace polynomialc_internal {
+namespace {
+
+using HornerKernel = void (*)(const double*, size_t, double, const double*, double*, size_t);
+using HornerFloatKernel = void (*)(const float*, size_t, float, const float*, float*, size_t);
+using ClenshawKernel = void (*)(const double*, size_t, double, double, const double*, double*, size_t);
+using DifferenceKernel = void (*)(double*, size_t, double*, size_t);
+
+
+// ===== SCALAR KERNEL =====
+
+// Evaluates a single point.  Also used for the leftover points of the SIMD kernels so that every
+// kernel produces identical results for the tail of a batch.
+template <typename T>
+inline T horner_point(const T* coefficients, size_t n, T a, T x) {
+    T t = x - a;
+    T result = 0;
+    for (size_t i = n; i-- > 0;) {
+        result = result * t + coefficients[i];
+    }
+    return result;
+}
+
+template <typename T>
+void horner_scalar(const T* coefficients, size_t n, T a, const T* xs, T* out, size_t count) {
+    size_t k = 0;
+
+    // Four points are evaluated at once so that the multiply-add chains of independent points
+    // can overlap in the pipeline.
+    for (; k + 4 <= count; k += 4) {
+        T t[4];
+        T result[4] = {0, 0, 0, 0};
+        for (int lane = 0; lane < 4; lane++) {
+            t[lane] = xs[k + lane] - a;
+        }
+        for (size_t i = n; i-- > 0;) {
+            for (int lane = 0; lane < 4; lane++) {
+                result[lane] = result[lane] * t[lane] + coefficients[i];
+            }
+        }
+        for (int lane = 0; lane < 4; lane++) {
+            out[k + lane] = result[lane];
+        }
+    }
+
+    for (; k < count; k++) {
+        out[k] = horner_point(coefficients, n, a, xs[k]);
+    }
+}
+
+
+void clenshaw_scalar(const double* coefficients, size_t n, double scale, double shift, const double* xs,
+                     double* out, size_t count) {
+    size_t k = 0;
+    for (; k + 4 <= count; k += 4) {
+        double u[4], b1[4] = {0, 0, 0, 0}, b2[4] = {0, 0, 0, 0};
+        for (int lane = 0; lane < 4; lane++) {
+            u[lane] = xs[k + lane] * scale - shift;
+        }
+        for (size_t i = n; i-- > 1;) {
+            for (int lane = 0; lane < 4; lane++) {
+                const double b0 = coefficients[i] + 2 * u[lane] * b1[lane] - b2[lane];
+                b2[lane] = b1[lane];
+                b1[lane] = b0;
+            }
+        }
+        for (int lane = 0; lane < 4; lane++) {
+            out[k + lane] = coefficients[0] + u[lane] * b1[lane] - b2[lane];
+        }
+    }
+
+    for (; k < count; k++) {
+        out[k] = clenshaw_point(coefficients, n, xs[k] * scale - shift);
+    }
+}
+
+
+void difference_scalar(double* table, size_t degree, double* out, size_t steps) {
+    // Row k is updated with the old row k + 1, so the rows of a step are independent.
+    for (size_t s = 0; s < steps; s++) {
+        for (size_t l = 0; l < difference_lanes; l++) {
+            out[s * difference_lanes + l] = table[l];
+        }
+        for (size_t k = 0; k < degree; k++) {
+            for (size_t l = 0; l < difference_lanes; l++) {
+                table[k * difference_lanes + l] += table[(k + 1) * difference_lanes + l];
+            }
+        }
+    }
+}
+
+
+#ifdef POLYNOMIALC_X86_DISPATCH
+
+// ===== AVX2 KERNEL =====
+
+__attribute__((target("avx2,fma")))
+void horner_avx2(const double* coefficients, size_t n, double a, const double* xs, double* out,
+                 size_t count) {
+    const __m256d va = _mm256_set1_pd(a);
+    const __m256d top = _mm256_set1_pd(coefficients[n - 1]);
+    size_t k = 0;
+
+    // Sixteen points (four vectors) per pass keep enough independent FMAs in flight to cover the
+    // latency of each multiply-add.
+    for (; k + 16 <= count; k += 16) {
+        __m256d t0 = _mm256_sub_pd(_mm256_loadu_pd(xs + k), va);
+        __m256d t1 = _mm256_sub_pd(_mm256_loadu_pd(xs + k + 4), va);
+        __m256d t2 = _mm256_sub_pd(_mm256_loadu_pd(xs + k + 8), va);
+        __m256d t3 = _mm256_sub_pd(_mm256_loadu_pd(xs + k + 12), va);
+        __m256d r0 = top, r1 = top, r2 = top, r3 = top;
+        for (size_t i = n - 1; i-- > 0;) {
+            const __m256d c = _mm256_set1_pd(coefficients[i]);
+            r0 = _mm256_fmadd_pd(r0, t0, c);
+            r1 = _mm256_fmadd_pd(r1, t1, c);
+            r2 = _mm256_fmadd_pd(r2, t2, c);
+            r3 = _mm256_fmadd_pd(r3, t3, c);
+        }
+        _mm256_storeu_pd(out + k, r0);
+        _mm256_storeu_pd(out + k + 4, r1);
+        _mm256_storeu_pd(out + k + 8, r2);
+        _mm256_storeu_pd(out + k + 12, r3);
+    }
+
+    for (; k + 4 <= count; k += 4) {
+        __m256d t0 = _mm256_sub_pd(_mm256_loadu_pd(xs + k), va);
+        __m256d r0 = top;
+        for (size_t i = n - 1; i-- > 0;) {
+            r0 = _mm256_fmadd_pd(r0, t0, _mm256_set1_pd(coefficients[i]));
+        }
+        _mm256_storeu_pd(out + k, r0);
+    }
+
+    for (; k < count; k++) {
+        out[k] = horner_point(coefficients, n, a, xs[k]);
+    }
+}
+
+// horner_avx2 in float: eight points per vector, so a pass covers 32 points.
+__attribute__((target("avx2,fma")))
+void horner_float_avx2(const float* coefficients, size_t n, float a, const float* xs, float* out,
+                       size_t count) {
+    const __m256 va = _mm256_set1_ps(a);
+    const __m256 top = _mm256_set1_ps(coefficients[n - 1]);
+    size_t k = 0;
+
+    for (; k + 32 <= count; k += 32) {
+        __m256 t0 = _mm256_sub_ps(_mm256_loadu_ps(xs + k), va);
+        __m256 t1 = _mm256_sub_ps(_mm256_loadu_ps(xs + k + 8), va);
+        __m256 t2 = _mm256_sub_ps(_mm256_loadu_ps(xs + k + 16), va);
+        __m256 t3 = _mm256_sub_ps(_mm256_loadu_ps(xs + k + 24), va);
+        __m256 r0 = top, r1 = top, r2 = top, r3 = top;
+        for (size_t i = n - 1; i-- > 0;) {
+            const __m256 c = _mm256_set1_ps(coefficients[i]);
+            r0 = _mm256_fmadd_ps(r0, t0, c);
+            r1 = _mm256_fmadd_ps(r1, t1, c);
+            r2 = _mm256_fmadd_ps(r2, t2, c);
+            r3 = _mm256_fmadd_ps(r3, t3, c);
+        }
+        _mm256_storeu_ps(out + k, r0);
+        _mm256_storeu_ps(out + k + 8, r1);
+        _mm256_storeu_ps(out + k + 16, r2);
+        _mm256_storeu_ps(out + k + 24, r3);
+    }
+
+    for (; k + 8 <= count; k += 8) {
+        __m256 t0 = _mm256_sub_ps(_mm256_loadu_ps(xs + k), va);
+        __m256 r0 = top;
+        for (size_t i = n - 1; i-- > 0;) {
+            r0 = _mm256_fmadd_ps(r0, t0, _mm256_set1_ps(coefficients[i]));
+        }
+        _mm256_storeu_ps(out + k, r0);
+    }
+
+    for (; k < count; k++) {
+        out[k] = horner_point(coefficients, n, a, xs[k]);
+    }
+}
+
+
+__attribute__((target("avx2,fma")))
+void clenshaw_avx2(const double* coefficients, size_t n, double scale, double shift, const double* xs,
+                   double* out, size_t count) {
+    const __m256d vscale = _mm256_set1_pd(scale);
+    const __m256d vshift = _mm256_set1_pd(shift);
+    const __m256d first = _mm256_set1_pd(coefficients[0]);
+    const __m256d zero = _mm256_setzero_pd();
+    size_t k = 0;
+
+    // b_i = (c_i - b_(i+2)) + 2u * b_(i+1): the subtraction does not wait on the previous step, so
+    // each step adds one FMA of latency, and sixteen points per pass cover it as in horner_avx2.
+    for (; k + 16 <= count; k += 16) {
+        const __m256d u0 = _mm256_fmsub_pd(_mm256_loadu_pd(xs + k), vscale, vshift);
+        const __m256d u1 = _mm256_fmsub_pd(_mm256_loadu_pd(xs + k + 4), vscale, vshift);
+        const __m256d u2 = _mm256_fmsub_pd(_mm256_loadu_pd(xs + k + 8), vscale, vshift);
+        const __m256d u3 = _mm256_fmsub_pd(_mm256_loadu_pd(xs + k + 12), vscale, vshift);
+        const __m256d w0 = _mm256_add_pd(u0, u0), w1 = _mm256_add_pd(u1, u1);
+        const __m256d w2 = _mm256_add_pd(u2, u2), w3 = _mm256_add_pd(u3, u3);
+        __m256d b0 = zero, b1 = zero, b2 = zero, b3 = zero;
+        __m256d p0 = zero, p1 = zero, p2 = zero, p3 = zero;
+        for (size_t i = n; i-- > 1;) {
+            const __m256d c = _mm256_set1_pd(coefficients[i]);
+            const __m256d n0 = _mm256_fmadd_pd(w0, b0, _mm256_sub_pd(c, p0));
+            const __m256d n1 = _mm256_fmadd_pd(w1, b1, _mm256_sub_pd(c, p1));
+            const __m256d n2 = _mm256_fmadd_pd(w2, b2, _mm256_sub_pd(c, p2));
+            const __m256d n3 = _mm256_fmadd_pd(w3, b3, _mm256_sub_pd(c, p3));
+            p0 = b0, p1 = b1, p2 = b2, p3 = b3;
+            b0 = n0, b1 = n1, b2 = n2, b3 = n3;
+        }
+        _mm256_storeu_pd(out + k, _mm256_sub_pd(_mm256_fmadd_pd(u0, b0, first), p0));
+        _mm256_storeu_pd(out + k + 4, _mm256_sub_pd(_mm256_fmadd_pd(u1, b1, first), p1));
+        _mm256_storeu_pd(out + k + 8, _mm256_sub_pd(_mm256_fmadd_pd(u2, b2, first), p2));
+        _mm256_storeu_pd(out + k + 12, _mm256_sub_pd(_mm256_fmadd_pd(u3, b3, first), p3));
+    }
+
+    for (; k < count; k++) {
+        out[k] = clenshaw_point(coefficients, n, xs[k] * scale - shift);
+    }
+}
+
+
+// The eight lanes of a row are two vectors, and with the degree known at compile time every row
+// stays in a register for the whole run.
+template <size_t Degree>
+__attribute__((target("avx2")))
+void difference_avx2_degree(double* table, double* out, size_t steps) {
+    __m256d rows[2 * (Degree + 1)];
+    for (size_t i = 0; i < 2 * (Degree + 1); i++) {
+        rows[i] = _mm256_loadu_pd(table + 4 * i);
+    }
+    for (size_t s = 0; s < steps; s++) {
+        _mm256_storeu_pd(out + 8 * s, rows[0]);
+        _mm256_storeu_pd(out + 8 * s + 4, rows[1]);
+        for (size_t k = 0; k < Degree; k++) {
+            rows[2 * k] = _mm256_add_pd(rows[2 * k], rows[2 * k + 2]);
+            rows[2 * k + 1] = _mm256_add_pd(rows[2 * k + 1], rows[2 * k + 3]);
+        }
+    }
+    for (size_t i = 0; i < 2 * (Degree + 1); i++) {
+        _mm256_storeu_pd(table + 4 * i, rows[i]);
+    }
+}
+
+__attribute__((target("avx2")))
+void difference_avx2(double* table, size_t degree, double* out, size_t steps) {
+    switch (degree) {
+        case 0: difference_avx2_degree<0>(table, out, steps); break;
+        case 1: difference_avx2_degree<1>(table, out, steps); break;
+        case 2: difference_avx2_degree<2>(table, out, steps); break;
+        default: difference_avx2_degree<3>(table, out, steps); break;
+    }
+}
+
+
+// ===== AVX-512 KERNEL =====
+
+__attribute__((target("avx512f")))
+void horner_avx512(const double* coefficients, size_t n, double a, const double* xs, double* out,
+                   size_t count) {
+    const __m512d va = _mm512_set1_pd(a);
+    const __m512d top = _mm512_set1_pd(coefficients[n - 1]);
+    size_t k = 0;
+
+    for (; k + 32 <= count; k += 32) {
+        __m512d t0 = _mm512_sub_pd(_mm512_loadu_pd(xs + k), va);
+        __m512d t1 = _mm512_sub_pd(_mm512_loadu_pd(xs + k + 8), va);
+        __m512d t2 = _mm512_sub_pd(_mm512_loadu_pd(xs + k + 16), va);
+        __m512d t3 = _mm512_sub_pd(_mm512_loadu_pd(xs + k + 24), va);
+        __m512d r0 = top, r1 = top, r2 = top, r3 = top;
+        for (size_t i = n - 1; i-- > 0;) {
+            const __m512d c = _mm512_set1_pd(coefficients[i]);
+            r0 = _mm512_fmadd_pd(r0, t0, c);
+            r1 = _mm512_fmadd_pd(r1, t1, c);
+            r2 = _mm512_fmadd_pd(r2, t2, c);
+            r3 = _mm512_fmadd_pd(r3, t3, c);
+        }
+        _mm512_storeu_pd(out + k, r0);
+        _mm512_storeu_pd(out + k + 8, r1);
+        _mm512_storeu_pd(out + k + 16, r2);
+        _mm512_storeu_pd(out + k + 24, r3);
+    }
+
+    for (; k + 8 <= count; k += 8) {
+        __m512d t0 = _mm512_sub_pd(_mm512_loadu_pd(xs + k), va);
+        __m512d r0 = top;
+        for (size_t i = n - 1; i-- > 0;) {
+            r0 = _mm512_fmadd_pd(r0, t0, _mm512_set1_pd(coefficients[i]));
+        }
+        _mm512_storeu_pd(out + k, r0);
+    }
+
+    for (; k < count; k++) {
+        out[k] = horner_point(coefficients, n, a, xs[k]);
+    }
+}
+
+__attribute__((target("avx512f")))
+void horner_float_avx512(const float* coefficients, size_t n, float a, const float* xs, float* out,
+                         size_t count) {
+    const __m512 va = _mm512_set1_ps(a);
+    const __m512 top = _mm512_set1_ps(coefficients[n - 1]);
+    size_t k = 0;
+
+    for (; k + 64 <= count; k += 64) {
+        __m512 t0 = _mm512_sub_ps(_mm512_loadu_ps(xs + k), va);
+        __m512 t1 = _mm512_sub_ps(_mm512_loadu_ps(xs + k + 16), va);
+        __m512 t2 = _mm512_sub_ps(_mm512_loadu_ps(xs + k + 32), va);
+        __m512 t3 = _mm512_sub_ps(_mm512_loadu_ps(xs + k + 48), va);
+        __m512 r0 = top, r1 = top, r2 = top, r3 = top;
+        for (size_t i = n - 1; i-- > 0;) {
+            const __m512 c = _mm512_set1_ps(coefficients[i]);
+            r0 = _mm512_fmadd_ps(r0, t0, c);
+            r1 = _mm512_fmadd_ps(r1, t1, c);
+            r2 = _mm512_fmadd_ps(r2, t2, c);
+            r3 = _mm512_fmadd_ps(r3, t3, c);
+        }
+        _mm512_storeu_ps(out + k, r0);
+        _mm512_storeu_ps(out + k + 16, r1);
+        _mm512_storeu_ps(out + k + 32, r2);
+        _mm512_storeu_ps(out + k + 48, r3);
+    }
+
+    for (; k + 16 <= count; k += 16) {
+        __m512 t0 = _mm512_sub_ps(_mm512_loadu_ps(xs + k), va);
+        __m512 r0 = top;
+        for (size_t i = n - 1; i-- > 0;) {
+            r0 = _mm512_fmadd_ps(r0, t0, _mm512_set1_ps(coefficients[i]));
+        }
+        _mm512_storeu_ps(out + k, r0);
+    }
+
+    for (; k < count; k++) {
+        out[k] = horner_point(coefficients, n, a, xs[k]);
+    }
+}
+
+#endif //POLYNOMIALC_X86_DISPATCH
+
+
+// ===== DISPATCH =====
+
+HornerKernel select_horner_kernel() {
+#ifdef POLYNOMIALC_X86_DISPATCH
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        return horner_avx512;
+    }
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        return horner_avx2;
+    }
+#endif
+    return horner_scalar<double>;
+}
+
+HornerFloatKernel select_horner_float_kernel() {
+#ifdef POLYNOMIALC_X86_DISPATCH
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        return horner_float_avx512;
+    }
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        return horner_float_avx2;
+    }
+#endif
+    return horner_scalar<float>;
+}
+
+ClenshawKernel select_clenshaw_kernel() {
+#ifdef POLYNOMIALC_X86_DISPATCH
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        return clenshaw_avx2;
+    }
+#endif
+    return clenshaw_scalar;
+}
+
+DifferenceKernel select_difference_kernel() {
+#ifdef POLYNOMIALC_X86_DISPATCH
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return difference_avx2;
+    }
+#endif
+    return difference_scalar;
+}
+
+} // namespace
+
+
+void horner_batch(const double* coefficients, size_t n, double a, const double* xs, double* out,
+                  size_t count) {
+    if (n == 0) {
+        for (size_t k = 0; k < count; k++) {
+            out[k] = 0;
+        }
+        return;
+    }
+
+    static const HornerKernel kernel = select_horner_kernel();
+    polynomialc_internal::count(PolynomialCounter::flops, 2 * (n - 1) * count);
+    kernel(coefficients, n, a, xs, out, count);
+}
+
+void horner_batch(const float* coefficients, size_t n, float a, const float* xs, float* out, size_t count) {
+    if (n == 0) {
+        for (size_t k = 0; k < count; k++) {
+            out[k] = 0;
+        }
+        return;
+    }
+
+    static const HornerFloatKernel kernel = select_horner_float_kernel();
+    polynomialc_internal::count(PolynomialCounter::flops, 2 * (n - 1) * count);
+    kernel(coefficients, n, a, xs, out, count);
+}
+
+double clenshaw_point(const double* coefficients, size_t n, double u) {
+    // b_k = c_k + 2u b_(k+1) - b_(k+2), and the sum is c_0 + u b_1 - b_2.
+    double b1 = 0;
+    double b2 = 0;
+    for (size_t k = n; k-- > 1;) {
+        const double b0 = coefficients[k] + 2 * u * b1 - b2;
+        b2 = b1;
+        b1 = b0;
+    }
+    return coefficients[0] + u * b1 - b2;
+}
+
+void clenshaw_batch(const double* coefficients, size_t n, double scale, double shift, const double* xs,
+                    double* out, size_t count) {
+    static const ClenshawKernel kernel = select_clenshaw_kernel();
+    polynomialc_internal::count(PolynomialCounter::flops, 4 * n * count);
+    kernel(coefficients, n, scale, shift, xs, out, count);
+}
+
+void difference_steps(double* table, size_t degree, double* out, size_t steps) {
+    static const DifferenceKernel kernel = select_difference_kernel();
+    count(PolynomialCounter::flops, degree * difference_lanes * steps);
+    kernel(table, degree, out, steps);
+}
+
+void horner_derivatives(const double* coefficients, size_t n, double t, double& value, double& first,
+                        double& second) {
+    // Synthetic division carried three levels deep: value = p(t), first = p'(t), second = p''(t) / 2.
+    value = 0;
+    first = 0;
+    second = 0;
+    count(PolynomialCounter::flops, 6 * n);
+    for (size_t i = n; i-- > 0;) {
+        second = second * t + first;
+        first = first * t + value;
+        value = value * t + coefficients[i];
+    }
+    second *= 2;
+}
+
+} // namespace polynomialc_internal
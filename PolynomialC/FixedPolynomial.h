@@ -0,0 +1,198 @@
+//
+// A polynomial whose degree is part of its type.  The coefficients live in a std::array, every
+// operation is constexpr, and evaluation is a Horner loop the compiler fully unrolls, so a
+// FixedPolynomial can be used in hot loops (or at compile time) where the dynamically sized
+// Polynomial would get in the way:
+//
+//     constexpr FixedPolynomial<2> p({1, 2, 3});          // 3x^2 + 2x + 1
+//     constexpr FixedPolynomial<3> q = p * FixedPolynomial<1>({-1, 1});
+//     static_assert(q.solve(2) == 17);
+//
+// The degree of a product, derivative or integral is computed at compile time.  Like the Polynomial
+// operators, polynomials with different values of a meet at the higher-degree one's (the left one's
+// on a tie), and the other one is rewritten around it (see recenter).  FixedPolynomial
+// converts to and from Polynomial, so the rest of the library can be used at the edges.
+//
+
+#ifndef POLYNOMIALC_FIXEDPOLYNOMIAL_H
+#define POLYNOMIALC_FIXEDPOLYNOMIAL_H
+
+#include "PolynomialC.h"
+
+#include <array>
+#include <cstddef>
+#include <stdexcept>
+#include <utility>
+
+template <size_t N, typename T = double>
+class FixedPolynomial {
+    // coefficient_list[i] is the coefficient of (x - a)^i, like the coefficient list of a Polynomial.
+    // Top coefficients may be 0; the degree is an upper bound.
+    array<T, N + 1> coefficient_list{};
+    T a = 0;
+
+    // Horner's scheme written as a fold, so there is no loop left for the compiler to keep.
+    template <size_t... I>
+    constexpr T horner(T t, index_sequence<I...>) const {
+        T result = 0;
+        ((result = result * t + coefficient_list[N - I]), ...);
+        return result;
+    }
+
+    template <size_t M, typename U> friend class FixedPolynomial;
+
+public:
+    static constexpr size_t degree = N;
+
+    // Class Constructors
+    constexpr FixedPolynomial() = default;
+
+    constexpr FixedPolynomial(const array<T, N + 1>& set_coefficient_list, T set_a=0)
+        : coefficient_list(set_coefficient_list), a(set_a) {}
+
+    // Takes the coefficients of a Polynomial; throws if its degree is above N.
+    explicit FixedPolynomial(const Polynomial& polynomial) : a((T) polynomial.get_a()) {
+        span<const double> source = polynomial.coefficients();
+        if (source.size() > N + 1) {
+            throw invalid_argument("The polynomial does not fit in a FixedPolynomial of this degree.");
+        }
+        for (size_t i = 0; i < source.size(); i++) {
+            coefficient_list[i] = (T) source[i];
+        }
+    }
+
+    // Class Getters
+    constexpr const array<T, N + 1>& get_coefficients() const { return coefficient_list; }
+    constexpr T get_a() const { return a; }
+    constexpr T operator[](size_t i) const { return i <= N ? coefficient_list[i] : T(0); }
+
+    // Conversion back to a (trimmed) Polynomial.
+    Polynomial to_polynomial() const {
+        return Polynomial(vector<double>(coefficient_list.begin(), coefficient_list.end()), (double) a);
+    }
+
+    explicit operator Polynomial() const {
+        return to_polynomial();
+    }
+
+    // Class Functions
+    constexpr T solve(T x) const {
+        return horner(x - a, make_index_sequence<N + 1>{});
+    }
+
+    constexpr T operator()(T x) const {
+        return solve(x);
+    }
+
+    constexpr FixedPolynomial<(N > 0 ? N - 1 : 0), T> differentiate() const {
+        FixedPolynomial<(N > 0 ? N - 1 : 0), T> derivative;
+        derivative.a = a;
+        for (size_t i = 1; i <= N; i++) {
+            derivative.coefficient_list[i - 1] = coefficient_list[i] * T(i);
+        }
+        return derivative;
+    }
+
+    constexpr FixedPolynomial<N + 1, T> integrate(T c=0) const {
+        FixedPolynomial<N + 1, T> integral;
+        integral.a = a;
+        integral.coefficient_list[0] = c;
+        for (size_t i = 0; i <= N; i++) {
+            integral.coefficient_list[i + 1] = coefficient_list[i] / T(i + 1);
+        }
+        return integral;
+    }
+
+    // The same polynomial written around new_a, with repeated synthetic division.
+    constexpr FixedPolynomial recenter(T new_a) const {
+        FixedPolynomial result = *this;
+        const T shift = new_a - a;
+        for (size_t i = 0; i < N; i++) {
+            for (size_t j = N; j-- > i;) {
+                result.coefficient_list[j] += shift * result.coefficient_list[j + 1];
+            }
+        }
+        result.a = new_a;
+        return result;
+    }
+
+    // Class Interactions with other fixed polynomials
+    template <size_t M>
+    constexpr FixedPolynomial<N + M, T> operator*(const FixedPolynomial<M, T>& other) const {
+        if (a != other.a) {
+            return N >= M ? *this * other.recenter(a) : recenter(other.a) * other;
+        }
+        FixedPolynomial<N + M, T> product;
+        product.a = a;
+        for (size_t i = 0; i <= N; i++) {
+            for (size_t j = 0; j <= M; j++) {
+                product.coefficient_list[i + j] += coefficient_list[i] * other.coefficient_list[j];
+            }
+        }
+        return product;
+    }
+
+    template <size_t M>
+    constexpr FixedPolynomial<(N > M ? N : M), T> operator+(const FixedPolynomial<M, T>& other) const {
+        return combine(other, T(1));
+    }
+
+    template <size_t M>
+    constexpr FixedPolynomial<(N > M ? N : M), T> operator-(const FixedPolynomial<M, T>& other) const {
+        return combine(other, T(-1));
+    }
+
+    // Class Interactions with constants
+    constexpr FixedPolynomial operator*(T x) const {
+        FixedPolynomial result = *this;
+        for (T& coefficient : result.coefficient_list) {
+            coefficient *= x;
+        }
+        return result;
+    }
+
+    constexpr FixedPolynomial operator/(T x) const {
+        FixedPolynomial result = *this;
+        for (T& coefficient : result.coefficient_list) {
+            coefficient /= x;
+        }
+        return result;
+    }
+
+    constexpr FixedPolynomial operator-() const {
+        return *this * T(-1);
+    }
+
+    constexpr bool operator==(const FixedPolynomial& other) const = default;
+
+private:
+    template <size_t M>
+    constexpr FixedPolynomial<(N > M ? N : M), T> combine(const FixedPolynomial<M, T>& other, T sign) const {
+        if (a != other.a) {
+            return N >= M ? combine(other.recenter(a), sign) : recenter(other.a).combine(other, sign);
+        }
+        FixedPolynomial<(N > M ? N : M), T> result;
+        result.a = a;
+        for (size_t i = 0; i <= N; i++) {
+            result.coefficient_list[i] += coefficient_list[i];
+        }
+        for (size_t j = 0; j <= M; j++) {
+            result.coefficient_list[j] += sign * other.coefficient_list[j];
+        }
+        return result;
+    }
+};
+
+template <size_t N, typename T>
+constexpr FixedPolynomial<N, T> operator*(T x, const FixedPolynomial<N, T>& polynomial) {
+    return polynomial * x;
+}
+
+// FixedPolynomial(array<double, 3>{1, 2, 3}) is a FixedPolynomial<2, double>.
+template <typename T, size_t Terms>
+FixedPolynomial(const array<T, Terms>&) -> FixedPolynomial<Terms - 1, T>;
+
+template <typename T, size_t Terms>
+FixedPolynomial(const array<T, Terms>&, T) -> FixedPolynomial<Terms - 1, T>;
+
+#endif //POLYNOMIALC_FIXEDPOLYNOMIAL_H
@@ -0,0 +1,254 @@
+//
+// The grid evaluator: forward-difference stepping of low-degree polynomials, with regular rebuilds of
+// the difference table from Horner's scheme, and blocks of Horner's scheme for everything else.
+//
+
+#include "GridEvaluator.h"
+#include "Kernels.h"
+
+#include <algorithm>
+#include <cmath>
+using namespace std;
+
+static_assert(GridEvaluator::lanes == polynomialc_internal::difference_lanes &&
+              GridEvaluator::max_difference_degree == polynomialc_internal::max_difference_degree,
+              "GridEvaluator and the difference kernel must agree on the table layout.");
+static_assert(GridEvaluator::max_difference_degree == 3, "seed() writes the differences of cubics at most.");
+
+namespace {
+
+// ===== HELPER FUNCTIONS =====
+
+// The table is seeded with every difference accurate to an ulp of its own size (see seed()).  From
+// then on, each step rounds rows 0 ... degree - 1 once, and an error in row k (from the seed or from a
+// step) reaches the value R steps later at most C(R, k) times, so with differences no larger than the
+// values the error after R steps is at most 2 * sum(C(R, k)) ulps of the largest value, k = 1 ...
+// degree.  The table is rebuilt before that passes 2^drift_bits ulps: the values are then within
+// 2^-39 (about 2e-12) of the size of the polynomial on the grid, and measured within 2^12 ulps of
+// solve().
+const int drift_bits = 14;
+const size_t max_reseed_steps = 4096;
+
+// Points of the grid solved at once by the Horner path.
+const size_t horner_block = 256;
+
+double drift(size_t steps, size_t degree) {
+    // 2 * sum(C(steps, k)) for k = 1 ... degree.
+    double total = 0;
+    double binomial = 1;
+    for (size_t k = 1; k <= degree && k <= steps; k++) {
+        binomial = binomial * double(steps - k + 1) / double(k);
+        total += 2 * binomial;
+    }
+    return total;
+}
+
+size_t reseed_interval(size_t degree) {
+    // The largest number of steps whose drift stays within the bound, by bisection (the drift grows
+    // with the number of steps).
+    const double limit = ldexp(1.0, drift_bits);
+    size_t low = 1;
+    size_t high = max_reseed_steps;
+    while (low < high) {
+        const size_t middle = (low + high + 1) / 2;
+        if (drift(middle, degree) <= limit) {
+            low = middle;
+        } else {
+            high = middle - 1;
+        }
+    }
+    return low;
+}
+
+} // namespace
+
+
+
+
+
+// ===== CONSTRUCTORS =====
+
+
+/* Grid Evaluator Constructor
+ *
+ * Prepares to stream the values of a polynomial at x0, x0 + h, x0 + 2h, and so on.  A table of forward
+ * differences turns each value into degree additions, but it has to be rebuilt from the Taylor
+ * coefficients at the next points every few steps to keep its rounding errors small, and the higher
+ * the degree, the sooner: every 4096 steps up to degree 1, 127 at degree 2 and 36 at degree 3 (a step
+ * is lanes values).  From degree 4 on the rebuilds cost more than the SIMD Horner kernel, so higher
+ * degrees (and keyword polynomials) are solved in blocks with evaluate() instead.
+ *
+ * Parameters: The polynomial, which is copied (Polynomial), the first value of x (Double), the
+ * distance between two values of x.  (Double)
+ */
+GridEvaluator::GridEvaluator(const Polynomial& polynomial, double x0, double h)
+        : polynomial(polynomial), x0(x0), h(h), table(), staged(), staged_offset(lanes) {
+    span<const double> coefficients = polynomial.coefficients();
+    size_t n = coefficients.size();
+    while (n > 1 && coefficients[n - 1] == 0) {
+        n--;
+    }
+    degree = n > 0 ? n - 1 : 0;
+    reseed_steps = reseed_interval(degree);
+    differences = polynomial.keyword == PolynomialKeyword::none && n > 0 && degree <= max_difference_degree;
+    steps_left = 0;
+    next_index = 0;
+}
+
+
+
+
+
+// ===== CLASS GETTERS =====
+
+
+/* Get X0
+ *
+ * Returns: The first value of x of the grid.  (Double)
+ */
+double GridEvaluator::get_x0() const {
+    return x0;
+}
+
+
+/* Get H
+ *
+ * Returns: The distance between two values of x of the grid.  (Double)
+ */
+double GridEvaluator::get_h() const {
+    return h;
+}
+
+
+/* Position
+ *
+ * Returns: The index i of the next value, which is at x0 + i * h.  (Size)
+ */
+size_t GridEvaluator::position() const {
+    return next_index - (lanes - staged_offset);
+}
+
+
+/* Uses Differences
+ *
+ * Returns: Whether the values are stepped with forward differences (true) or solved with Horner's
+ * scheme (false).  (Boolean)
+ */
+bool GridEvaluator::uses_differences() const {
+    return differences;
+}
+
+
+
+
+
+// ===== CLASS FUNCTIONS =====
+
+
+void GridEvaluator::seed() {
+    // Row k of lane l is difference k of the lane's values, with the lane's step s = lanes * h.  It is
+    // found from the Taylor coefficients c_i of the polynomial at the lane's next point, as the sum of
+    // c_i * s^i * k! * S(i, k) (S being the Stirling numbers of the second kind), so every difference is
+    // accurate relative to its own size.  The formulas cover differences up to the third.  Differencing the values instead would leave each difference
+    // with an error of the size of the values, which the steps then add up C(R, k) times.
+    const double s = double(lanes) * h;
+    span<const double> coefficients = polynomial.coefficients();
+    const double c3 = degree == 3 ? coefficients[3] : 0.0;
+    for (size_t l = 0; l < lanes; l++) {
+        const double t = x0 + double(next_index + l) * h - polynomial.get_a();
+        double c0, c1, c2;
+        polynomialc_internal::horner_derivatives(coefficients.data(), degree + 1, t, c0, c1, c2);
+        c2 /= 2;
+        table[l] = c0;
+        table[lanes + l] = s * (c1 + s * (c2 + s * c3));
+        table[2 * lanes + l] = s * s * (2 * c2 + 6 * s * c3);
+        table[3 * lanes + l] = 6 * s * s * s * c3;
+    }
+    steps_left = reseed_steps;
+}
+
+
+void GridEvaluator::advance(double* out, size_t steps) {
+    // Writes the values of steps steps (lanes consecutive points each), rebuilding the table whenever
+    // it runs out.
+    while (steps > 0) {
+        if (steps_left == 0) {
+            seed();
+        }
+        const size_t run = min(steps, steps_left);
+        polynomialc_internal::difference_steps(table, degree, out, run);
+        out += run * lanes;
+        steps -= run;
+        steps_left -= run;
+        next_index += run * lanes;
+    }
+}
+
+
+/* Fill
+ *
+ * Writes the next values of the grid into a buffer and moves on by its size, so a long grid can be
+ * streamed through one small buffer.  Values stepped with forward differences are within 2^-39 of
+ * the size of the polynomial on the grid of solve() (or of the size of its differences, on grids
+ * coarse enough for them to be larger); values solved with Horner's scheme are those of evaluate().
+ *
+ * Parameters: Where to write the values.  (Span of doubles)
+ * Returns: None.
+ */
+void GridEvaluator::fill(span<double> out) {
+    size_t written = 0;
+    while (staged_offset < lanes && written < out.size()) {
+        out[written++] = staged[staged_offset++];
+    }
+
+    if (!differences) {
+        double xs[horner_block];
+        while (written < out.size()) {
+            const size_t length = min(horner_block, out.size() - written);
+            for (size_t k = 0; k < length; k++) {
+                xs[k] = x0 + double(next_index + k) * h;
+            }
+            polynomial.evaluate(span<const double>(xs, length), out.subspan(written, length));
+            written += length;
+            next_index += length;
+        }
+        return;
+    }
+
+    const size_t steps = (out.size() - written) / lanes;
+    advance(out.data() + written, steps);
+    written += steps * lanes;
+    if (written < out.size()) {
+        // The last step goes through the staging buffer, and what does not fit waits for the next call.
+        advance(staged, 1);
+        staged_offset = 0;
+        while (written < out.size()) {
+            out[written++] = staged[staged_offset++];
+        }
+    }
+}
+
+
+/* Next
+ *
+ * Returns: The next value of the grid, moving on by one.  (Double)
+ */
+double GridEvaluator::next() {
+    double value;
+    fill(span<double>(&value, 1));
+    return value;
+}
+
+
+/* Seek
+ *
+ * Moves to any point of the grid.  The difference table is rebuilt at the next value.
+ *
+ * Parameters: The index i of the next value, which is at x0 + i * h.  (Size)
+ * Returns: None.
+ */
+void GridEvaluator::seek(size_t index) {
+    next_index = index;
+    staged_offset = lanes;
+    steps_left = 0;
+}
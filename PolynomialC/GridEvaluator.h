@@ -0,0 +1,65 @@
+//
+// Streams the values of a polynomial on a uniform grid x0, x0 + h, x0 + 2h, ... into caller buffers,
+// for plots, signal synthesis and lookup tables.  Polynomials of degree 3 or less are stepped with a
+// table of forward differences, so each value costs degree additions instead of a Horner evaluation;
+// the table is rebuilt from the Taylor coefficients at regular intervals so the rounding errors of the
+// additions cannot build up.  The stepped values are within 2^-39 (about 2e-12) of the size of the
+// polynomial on the grid of solve(); the others are those of evaluate().
+//
+
+#ifndef POLYNOMIALC_GRIDEVALUATOR_H
+#define POLYNOMIALC_GRIDEVALUATOR_H
+
+#include "PolynomialC.h"
+
+#include <cstddef>
+#include <span>
+
+class GridEvaluator {
+public:
+    // The grid is walked as this many interleaved sub-grids (lane l holds the points l, l + lanes, ...
+    // of every block), so the additions of one step are independent and vectorize.
+    static const size_t lanes = 8;
+
+    // Higher degrees are solved with Horner's scheme, which is cheaper for them (see the constructor).
+    static const size_t max_difference_degree = 3;
+
+private:
+    Polynomial polynomial;
+    double x0;
+    double h;
+
+    // The forward differences of every lane, difference k of lane l at table[k * lanes + l], and the
+    // number of steps they can still take before they are rebuilt.
+    double table[(max_difference_degree + 1) * lanes];
+    size_t degree;
+    size_t reseed_steps;
+    size_t steps_left;
+    bool differences;
+
+    // The grid index of lane 0 at the next step, and the values of a step that did not fit the
+    // caller's buffer.
+    size_t next_index;
+    double staged[lanes];
+    size_t staged_offset;
+
+    void seed();
+    void advance(double* out, size_t steps);
+
+public:
+    // Class Constructors
+    GridEvaluator(const Polynomial& polynomial, double x0, double h);
+
+    // Class Getters
+    double get_x0() const;
+    double get_h() const;
+    size_t position() const;
+    bool uses_differences() const;
+
+    // Class Functions
+    void fill(span<double> out);
+    double next();
+    void seek(size_t index);
+};
+
+#endif //POLYNOMIALC_GRIDEVALUATOR_H
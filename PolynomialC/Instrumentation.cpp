@@ -0,0 +1,227 @@
+//
+// The per-thread counters behind Instrumentation.h, and their snapshots and exports.
+//
+
+#include "Instrumentation.h"
+
+#include <atomic>
+#include <cstdio>
+#include <mutex>
+#include <vector>
+using namespace std;
+
+namespace {
+
+// ===== HELPERS =====
+
+const char* const operation_names[polynomial_operation_count] = {
+    "series", "solve", "evaluate", "evaluate_many", "interpolate", "evaluate_grid", "differentiate", "integrate",
+    "power", "recenter", "compose", "compositional_inverse", "find_zero", "roots", "real_roots",
+    "isolate_real_roots", "divide", "gcd", "display", "add", "subtract", "multiply", "scale"
+};
+
+const char* const counter_names[polynomial_counter_count] = {
+    "flops", "allocations", "allocated_bytes", "zero_iterations", "trim_scans", "trimmed_terms"
+};
+
+#ifdef POLYNOMIALC_INSTRUMENTATION
+
+// Adds every counter of one snapshot to another, or subtracts it.
+void accumulate(PolynomialStatistics& total, const PolynomialStatistics& part, bool subtract) {
+    for (size_t i = 0; i < polynomial_operation_count; i++) {
+        if (subtract) {
+            total.operations[i].calls -= part.operations[i].calls;
+            total.operations[i].nanoseconds -= part.operations[i].nanoseconds;
+        } else {
+            total.operations[i].calls += part.operations[i].calls;
+            total.operations[i].nanoseconds += part.operations[i].nanoseconds;
+        }
+    }
+    for (size_t i = 0; i < polynomial_counter_count; i++) {
+        total.counters[i] = subtract ? total.counters[i] - part.counters[i] : total.counters[i] + part.counters[i];
+    }
+}
+
+// The counters of one thread.  Only the owning thread writes them, with a relaxed load and store
+// (no locked instruction), while snapshots read them from other threads.
+struct ThreadCounters {
+    atomic<uint64_t> calls[polynomial_operation_count] = {};
+    atomic<uint64_t> nanoseconds[polynomial_operation_count] = {};
+    atomic<uint64_t> counters[polynomial_counter_count] = {};
+
+    ThreadCounters();
+    ~ThreadCounters();
+
+    static void add(atomic<uint64_t>& counter, uint64_t amount) {
+        counter.store(counter.load(memory_order_relaxed) + amount, memory_order_relaxed);
+    }
+
+    void read_into(PolynomialStatistics& total) const {
+        PolynomialStatistics part;
+        for (size_t i = 0; i < polynomial_operation_count; i++) {
+            part.operations[i].calls = calls[i].load(memory_order_relaxed);
+            part.operations[i].nanoseconds = nanoseconds[i].load(memory_order_relaxed);
+        }
+        for (size_t i = 0; i < polynomial_counter_count; i++) {
+            part.counters[i] = counters[i].load(memory_order_relaxed);
+        }
+        accumulate(total, part, false);
+    }
+};
+
+// Every live thread's counters, what the threads that have exited counted, and the totals at the
+// last reset.  The registry is never destroyed, so threads that exit after main() can still
+// unregister.
+struct Registry {
+    mutex lock;
+    vector<ThreadCounters*> threads;
+    PolynomialStatistics retired;
+    PolynomialStatistics baseline;
+};
+
+Registry& registry() {
+    static Registry* instance = new Registry();
+    return *instance;
+}
+
+ThreadCounters::ThreadCounters() {
+    Registry& shared = registry();
+    lock_guard<mutex> guard(shared.lock);
+    shared.threads.push_back(this);
+}
+
+ThreadCounters::~ThreadCounters() {
+    Registry& shared = registry();
+    lock_guard<mutex> guard(shared.lock);
+    read_into(shared.retired);
+    erase(shared.threads, this);
+}
+
+ThreadCounters& thread_counters() {
+    thread_local ThreadCounters counters;
+    return counters;
+}
+
+PolynomialStatistics totals(Registry& shared) {
+    // Called with the registry locked.
+    PolynomialStatistics total = shared.retired;
+    for (const ThreadCounters* counters : shared.threads) {
+        counters->read_into(total);
+    }
+    return total;
+}
+
+#endif
+
+} // namespace
+
+
+
+
+
+// ===== HOOKS =====
+
+#ifdef POLYNOMIALC_INSTRUMENTATION
+
+void polynomialc_internal::count(PolynomialCounter counter, uint64_t amount) {
+    ThreadCounters::add(thread_counters().counters[size_t(counter)], amount);
+}
+
+void polynomialc_internal::count_operation(PolynomialOperation operation, uint64_t nanoseconds) {
+    ThreadCounters& counters = thread_counters();
+    ThreadCounters::add(counters.calls[size_t(operation)], 1);
+    ThreadCounters::add(counters.nanoseconds[size_t(operation)], nanoseconds);
+}
+
+#endif
+
+
+
+
+
+// ===== SNAPSHOTS =====
+
+const char* operation_name(PolynomialOperation operation) {
+    return operation_names[size_t(operation)];
+}
+
+const char* counter_name(PolynomialCounter counter) {
+    return counter_names[size_t(counter)];
+}
+
+PolynomialStatistics polynomial_statistics() {
+#ifdef POLYNOMIALC_INSTRUMENTATION
+    Registry& shared = registry();
+    lock_guard<mutex> guard(shared.lock);
+    PolynomialStatistics statistics = totals(shared);
+    accumulate(statistics, shared.baseline, true);
+    statistics.enabled = true;
+    return statistics;
+#else
+    return PolynomialStatistics();
+#endif
+}
+
+void reset_polynomial_statistics() {
+    // The counters themselves belong to their threads, so a reset only moves the zero point.
+#ifdef POLYNOMIALC_INSTRUMENTATION
+    Registry& shared = registry();
+    lock_guard<mutex> guard(shared.lock);
+    shared.baseline = totals(shared);
+#endif
+}
+
+
+/* To JSON
+ *
+ * Writes the snapshot as a JSON object: enabled, then the calls and nanoseconds of every operation
+ * that was called at least once, then every counter.
+ *
+ * Returns: The JSON text.  (String)
+ */
+string PolynomialStatistics::to_json() const {
+    string json = string("{\"enabled\": ") + (enabled ? "true" : "false") + ", \"operations\": {";
+    bool first = true;
+    for (size_t i = 0; i < polynomial_operation_count; i++) {
+        if (operations[i].calls == 0) {
+            continue;
+        }
+        json += (first ? "\"" : ", \"") + string(operation_names[i]) + "\": {\"calls\": " +
+                to_string(operations[i].calls) + ", \"nanoseconds\": " + to_string(operations[i].nanoseconds) + "}";
+        first = false;
+    }
+    json += "}";
+    for (size_t i = 0; i < polynomial_counter_count; i++) {
+        json += ", \"" + string(counter_names[i]) + "\": " + to_string(counters[i]);
+    }
+    return json + "}";
+}
+
+
+/* To Prometheus
+ *
+ * Writes the snapshot in the Prometheus text exposition format: polynomialc_calls_total and
+ * polynomialc_seconds_total with an operation label, then one polynomialc_<counter>_total per counter.
+ *
+ * Returns: The exposition text.  (String)
+ */
+string PolynomialStatistics::to_prometheus() const {
+    string text = "# HELP polynomialc_calls_total Calls of each Polynomial operation.\n"
+                  "# TYPE polynomialc_calls_total counter\n";
+    for (size_t i = 0; i < polynomial_operation_count; i++) {
+        text += "polynomialc_calls_total{operation=\"" + string(operation_names[i]) + "\"} " +
+                to_string(operations[i].calls) + "\n";
+    }
+    text += "# HELP polynomialc_seconds_total Time spent in each Polynomial operation.\n"
+            "# TYPE polynomialc_seconds_total counter\n";
+    char seconds[32];
+    for (size_t i = 0; i < polynomial_operation_count; i++) {
+        snprintf(seconds, sizeof(seconds), "%.9f", double(operations[i].nanoseconds) * 1e-9);
+        text += "polynomialc_seconds_total{operation=\"" + string(operation_names[i]) + "\"} " + seconds + "\n";
+    }
+    for (size_t i = 0; i < polynomial_counter_count; i++) {
+        const string name = "polynomialc_" + string(counter_names[i]) + "_total";
+        text += "# TYPE " + name + " counter\n" + name + " " + to_string(counters[i]) + "\n";
+    }
+    return text;
+}
@@ -0,0 +1,109 @@
+//
+// Optional instrumentation of the library: how many times each public Polynomial method was called
+// and how long it took, plus counters of floating-point operations, coefficient allocations, zero()
+// iterations and trailing-zero scans.  It is compiled in only when POLYNOMIALC_INSTRUMENTATION is
+// defined (cmake -DPOLYNOMIALC_INSTRUMENTATION=ON); otherwise every hook is an empty inline function
+// and the snapshots are all zeros.
+//
+//     reset_polynomial_statistics();
+//     run_model();
+//     PolynomialStatistics statistics = polynomial_statistics();
+//     cout << statistics.to_json();           // or statistics.to_prometheus()
+//
+// Every thread counts into its own counters, so the hooks never contend; a snapshot adds up the
+// counters of every thread (including the ones that have exited).
+//
+
+#ifndef POLYNOMIALC_INSTRUMENTATION_H
+#define POLYNOMIALC_INSTRUMENTATION_H
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// The timed operations.  The operators are grouped by kind: add is + and +=, divide is /, %, their
+// compound forms and divmod, and scale is every operation with a number.
+enum class PolynomialOperation : unsigned char {
+    series, solve, evaluate, evaluate_many, interpolate, evaluate_grid, differentiate, integrate, power,
+    recenter, compose, compositional_inverse, find_zero, roots, real_roots, isolate_real_roots, divide,
+    gcd, display, add, subtract, multiply, scale
+};
+
+// The counters that are not tied to an operation.
+//  - flops: the floating-point operations of Horner's scheme, forward differences, schoolbook and
+//    sparse products, FFT butterflies and long division (nominal counts, 2 per multiply-add).
+//  - allocations, allocated_bytes: coefficient lists taken from the global heap (arenas and custom
+//    resources keep their own counts, see PolynomialMemory.h).
+//  - zero_iterations: the iterations of find_zero() and zero().
+//  - trim_scans, trimmed_terms: the scans for zero top terms after an operation, and the terms removed.
+enum class PolynomialCounter : unsigned char {
+    flops, allocations, allocated_bytes, zero_iterations, trim_scans, trimmed_terms
+};
+
+const size_t polynomial_operation_count = size_t(PolynomialOperation::scale) + 1;
+const size_t polynomial_counter_count = size_t(PolynomialCounter::trimmed_terms) + 1;
+
+const char* operation_name(PolynomialOperation operation);
+const char* counter_name(PolynomialCounter counter);
+
+
+// A snapshot of every counter since the last reset.  Times are inclusive: an operation that calls
+// another public method (real_roots calls roots, for one) counts that time too.
+struct PolynomialStatistics {
+    struct Operation {
+        uint64_t calls = 0;
+        uint64_t nanoseconds = 0;
+    };
+
+    bool enabled = false;
+    std::array<Operation, polynomial_operation_count> operations{};
+    std::array<uint64_t, polynomial_counter_count> counters{};
+
+    const Operation& operation(PolynomialOperation operation) const { return operations[size_t(operation)]; }
+    uint64_t counter(PolynomialCounter counter) const { return counters[size_t(counter)]; }
+
+    std::string to_json() const;
+    std::string to_prometheus() const;
+};
+
+// Adds up the counters of every thread since the last reset.
+PolynomialStatistics polynomial_statistics();
+
+// Starts every counter over from zero.
+void reset_polynomial_statistics();
+
+
+// The hooks the library calls.  The end user is not supposed to call these directly.
+namespace polynomialc_internal {
+#ifdef POLYNOMIALC_INSTRUMENTATION
+    void count(PolynomialCounter counter, uint64_t amount);
+    void count_operation(PolynomialOperation operation, uint64_t nanoseconds);
+
+    // Counts one call of an operation, and the time until the end of the scope.
+    class ScopedTimer {
+        PolynomialOperation operation;
+        std::chrono::steady_clock::time_point start;
+
+    public:
+        explicit ScopedTimer(PolynomialOperation operation)
+            : operation(operation), start(std::chrono::steady_clock::now()) {}
+        ~ScopedTimer() {
+            const auto elapsed = std::chrono::steady_clock::now() - start;
+            count_operation(operation, uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+        }
+        ScopedTimer(const ScopedTimer&) = delete;
+        ScopedTimer& operator=(const ScopedTimer&) = delete;
+    };
+#else
+    inline void count(PolynomialCounter, uint64_t) {}
+
+    class ScopedTimer {
+    public:
+        explicit ScopedTimer(PolynomialOperation) {}
+    };
+#endif
+}
+
+#endif //POLYNOMIALC_INSTRUMENTATION_H
@@ -0,0 +1,393 @@
+//
+// Real root isolation with Descartes' rule of signs and Vincent-Collins-Akritas bisection.
+//
+
+#include "Kernels.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <mutex>
+using namespace std;
+
+namespace polynomialc_internal {
+namespace {
+
+// Bisection gives up on an interval after this many halvings; only a multiple root or a cluster of
+// roots too close together for double precision gets that deep.
+const unsigned int isolation_max_depth = 128;
+// Subintervals are only handed to other threads when the polynomial is big enough to pay for it.
+const size_t parallel_isolation_degree = 32;
+const unsigned int refine_max_iterations = 200;
+
+// The outcome of a Descartes test: the interval holds no root, exactly one, possibly several, or the
+// rounding errors are too large to tell.
+enum class RootCount { none, one, several, uncertain };
+
+// Replaces c_i by c_i * factor^i in both values and magnitudes (with |factor| for the magnitudes),
+// then multiplies both by the same power of two so the largest magnitude is close to 1.  Only the
+// roots matter here, so the common factor is dropped; tracking the exponents separately keeps
+// factor^i from overflowing at high degrees.
+void scale_variable(vector<double>& values, vector<double>& magnitudes, double factor) {
+    const size_t n = values.size();
+    int factor_exponent;
+    const double factor_mantissa = frexp(factor, &factor_exponent);
+
+    vector<long> exponents(n);
+    double power_mantissa = 1;
+    long power_exponent = 0;
+    long top = numeric_limits<long>::min();
+    for (size_t i = 0; i < n; i++) {
+        values[i] *= power_mantissa;
+        magnitudes[i] *= fabs(power_mantissa);
+        exponents[i] = power_exponent + long(factor_exponent) * long(i);
+        if (magnitudes[i] != 0) {
+            top = max(top, long(ilogb(magnitudes[i])) + exponents[i]);
+        }
+
+        int exponent;
+        power_mantissa = frexp(power_mantissa * factor_mantissa, &exponent);
+        power_exponent += exponent;
+    }
+    if (top == numeric_limits<long>::min()) {
+        return;
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        int shift = int(max(-2200L, min(2200L, exponents[i] - top)));
+        values[i] = ldexp(values[i], shift);
+        magnitudes[i] = ldexp(magnitudes[i], shift);
+    }
+}
+
+void shift_by_one(vector<double>& values, vector<double>& magnitudes) {
+    taylor_shift_horner(values.data(), values.size(), 1.0);
+    taylor_shift_horner(magnitudes.data(), magnitudes.size(), 1.0);
+}
+
+// A first-order bound on the relative rounding error of the Descartes test and of Horner's scheme
+// for a polynomial with n coefficients.
+double rounding(size_t n) {
+    return double(2 * n + 8) * numeric_limits<double>::epsilon();
+}
+
+// What the searches need to know about p at one point.
+struct PointValue {
+    int sign;           // the sign of p(x): -1, 0 or 1
+    double correction;  // the Newton correction p(x) / p'(x)
+    bool negligible;    // whether |p(x)| is within its own rounding error of 0
+};
+
+// Evaluates p at x.  Points outside [-1, 1] go through the reversed polynomial in 1 / x, so high
+// degrees cannot overflow.
+PointValue evaluate_point(const double* coefficients, size_t n, double x) {
+    const size_t degree = n - 1;
+    double value = 0;
+    double derivative = 0;
+    double magnitude = 0;
+    double correction;
+    int sign_flip = 1;
+
+    if (fabs(x) <= 1) {
+        for (size_t i = n; i-- > 0;) {
+            derivative = derivative * x + value;
+            value = value * x + coefficients[i];
+            magnitude = magnitude * fabs(x) + fabs(coefficients[i]);
+        }
+        correction = value / derivative;
+    } else {
+        // p(x) = x^d q(y) and p'(x) = x^(d - 1) (d q(y) - y q'(y)) with y = 1 / x.
+        double y = 1 / x;
+        for (size_t i = 0; i < n; i++) {
+            derivative = derivative * y + value;
+            value = value * y + coefficients[i];
+            magnitude = magnitude * fabs(y) + fabs(coefficients[i]);
+        }
+        correction = x * value / (double(degree) * value - y * derivative);
+        if (x < 0 && degree % 2 == 1) {
+            sign_flip = -1;
+        }
+    }
+
+    int sign = value > 0 ? 1 : value < 0 ? -1 : 0;
+    return {sign * sign_flip, correction, fabs(value) <= rounding(n) * magnitude};
+}
+
+// Bisects [low, high] until every piece holds no root or exactly one.
+class Isolator {
+    const double* coefficients;
+    size_t n;
+    TaskGroup* group;
+    double tolerance;
+    mutex lock;
+
+    void add(double low, double high, bool isolated) {
+        lock_guard<mutex> guard(lock);
+        found.push_back({low, high, isolated});
+    }
+
+    bool is_root(double x) const {
+        return evaluate_point(coefficients, n, x).sign == 0;
+    }
+
+    bool negligible(double x) const {
+        return evaluate_point(coefficients, n, x).negligible;
+    }
+
+    // Counts the sign changes in the coefficients of (1 + s)^d q(1 / (1 + s)), where
+    // q(s) = p(low + (high - low) * s) maps [low, high] onto [0, 1].  By Descartes' rule this bounds
+    // the number of roots in (low, high), and has the same parity: 0 means none and 1 means exactly
+    // one.  Each coefficient is built straight from p together with a bound on its rounding error, so
+    // a sign that cannot be trusted is reported as uncertain rather than miscounted.
+    RootCount variations(double low, double high) const {
+        thread_local vector<double> values;
+        thread_local vector<double> magnitudes;
+        values.assign(coefficients, coefficients + n);
+        magnitudes.resize(n);
+        for (size_t i = 0; i < n; i++) {
+            magnitudes[i] = fabs(values[i]);
+        }
+
+        // When low is not 0 the substitution is done as r(v) = p(low * v), then r(v + 1), then
+        // v = (width / low) * s, so every step stays in range.
+        if (low == 0) {
+            scale_variable(values, magnitudes, high - low);
+        } else {
+            scale_variable(values, magnitudes, low);
+            shift_by_one(values, magnitudes);
+            scale_variable(values, magnitudes, (high - low) / low);
+        }
+        // Roots at the ends are reported separately and are not counted by the rule anyway.
+        if (is_root(low)) {
+            values[0] = magnitudes[0] = 0;
+        }
+        reverse(values.begin(), values.end());
+        reverse(magnitudes.begin(), magnitudes.end());
+        shift_by_one(values, magnitudes);
+        if (is_root(high)) {
+            values[0] = magnitudes[0] = 0;
+        }
+
+        // A coefficient within its error bound of 0 could have either sign.  The fewest sign changes
+        // come from skipping those coefficients; the most are tracked for the sequence ending on each
+        // sign.
+        const double error = rounding(n);
+        unsigned int fewest = 0;
+        double previous = 0;
+        int most[2] = {-1, -1};  // indexed by whether the sequence so far ends on a positive sign
+        for (size_t i = 0; i < n; i++) {
+            if (magnitudes[i] == 0) {
+                continue;
+            }
+            bool certain = fabs(values[i]) > error * magnitudes[i];
+            bool first = most[0] < 0 && most[1] < 0;
+            int next[2] = {-1, -1};
+            for (int sign = 0; sign < 2; sign++) {
+                if (certain && sign != int(values[i] > 0)) {
+                    continue;
+                }
+                int change = most[1 - sign] < 0 ? -1 : most[1 - sign] + 1;
+                next[sign] = first ? 0 : max(most[sign], change);
+            }
+            most[0] = next[0];
+            most[1] = next[1];
+
+            if (certain) {
+                if (previous != 0 && (values[i] > 0) != (previous > 0)) {
+                    fewest++;
+                }
+                previous = values[i];
+            }
+        }
+        unsigned int count = (unsigned int) max(0, max(most[0], most[1]));
+        if (fewest != count && fewest < 2) {
+            return RootCount::uncertain;
+        }
+        return count == 0 ? RootCount::none : count == 1 ? RootCount::one : RootCount::several;
+    }
+
+public:
+    vector<RealRootInterval> found;
+
+    Isolator(const double* coefficients, size_t n, TaskGroup* group, double tolerance)
+        : coefficients(coefficients), n(n), group(group), tolerance(tolerance) {}
+
+    void bisect(double low, double high, unsigned int depth) {
+        RootCount count = variations(low, high);
+        if (count == RootCount::none) {
+            return;
+        }
+        if (count == RootCount::one) {
+            add(low, high, true);
+            return;
+        }
+
+        // Splitting stops when it cannot help: the interval is as narrow as asked for (or as double
+        // precision allows).
+        double middle = low + (high - low) / 2;
+        if (depth >= isolation_max_depth || high - low <= tolerance || !(middle > low && middle < high)) {
+            add(low, high, false);
+            return;
+        }
+
+        // The split point is moved off any spot where p is lost in its rounding error, since the
+        // halves could not be told apart there.  When p is lost everywhere tried (as around a
+        // multiple root) and the signs were uncertain, no amount of splitting will help either.
+        const double fractions[] = {0.5, 0.4375, 0.5625, 0.375, 0.625};
+        bool found_split = false;
+        for (double fraction : fractions) {
+            double point = low + (high - low) * fraction;
+            if (point > low && point < high && !negligible(point)) {
+                middle = point;
+                found_split = true;
+                break;
+            }
+        }
+        if (!found_split && count == RootCount::uncertain) {
+            add(low, high, false);
+            return;
+        }
+
+        // A root exactly at the split point belongs to neither open half, so it is reported on its own.
+        if (is_root(middle)) {
+            add(middle, middle, true);
+        }
+
+        if (group != nullptr) {
+            group->run([this, middle, high, depth] { bisect(middle, high, depth + 1); });
+        } else {
+            bisect(middle, high, depth + 1);
+        }
+        bisect(low, middle, depth + 1);
+    }
+};
+
+// Shrinks an interval holding exactly one root to at most tolerance wide.  Newton steps are taken
+// while they land inside the bracket and keep halving it; otherwise the bracket is bisected.
+RealRootInterval refine(const double* coefficients, size_t n, RealRootInterval interval, double tolerance) {
+    const int low_sign = evaluate_point(coefficients, n, interval.low).sign;
+    const int high_sign = evaluate_point(coefficients, n, interval.high).sign;
+    if (low_sign == 0) {
+        return {interval.low, interval.low, true};
+    }
+    if (high_sign == 0) {
+        return {interval.high, interval.high, true};
+    }
+    if (low_sign == high_sign) {
+        // Rounding in the end points hid the sign change; the interval is left as it is.
+        return interval;
+    }
+
+    double low = interval.low;
+    double high = interval.high;
+    double x = low + (high - low) / 2;
+    double previous_width = high - low;
+    for (unsigned int iteration = 0; iteration < refine_max_iterations && high - low > tolerance; iteration++) {
+        PointValue point = evaluate_point(coefficients, n, x);
+        if (point.sign == 0) {
+            return {x, x, true};
+        }
+        if (point.sign == low_sign) {
+            low = x;
+        } else {
+            high = x;
+        }
+
+        double width = high - low;
+        double middle = low + width / 2;
+        if (!(middle > low && middle < high)) {
+            break;
+        }
+        double next = x - point.correction;
+        if (!(next > low && next < high) || width > previous_width / 2) {
+            next = middle;
+        }
+        previous_width = width;
+        x = next;
+    }
+    return {low, high, true};
+}
+
+} // namespace
+
+
+vector<RealRootInterval> isolate_real_roots(const double* coefficients, size_t n, double low, double high,
+                                            double tolerance, unsigned int threads) {
+    while (n > 0 && coefficients[n - 1] == 0) {
+        n--;
+    }
+    if (n == 0) {
+        // Every point is a root of the zero polynomial.
+        return {{low, high, false}};
+    }
+    if (n == 1) {
+        return {};
+    }
+    const size_t degree = n - 1;
+
+    // Every root lies within Fujiwara's bound, so the search never needs to look further out.
+    double bound = 0;
+    const double log_top = log(fabs(coefficients[degree]));
+    for (size_t k = 1; k <= degree; k++) {
+        double c = fabs(coefficients[degree - k]);
+        if (c == 0) {
+            continue;
+        }
+        if (k == degree) {
+            c /= 2;
+        }
+        bound = max(bound, exp((log(c) - log_top) / double(k)));
+    }
+    bound = min(2.0625 * bound, numeric_limits<double>::max() / 4);
+    low = max(low, -bound);
+    high = min(high, bound);
+    if (!(low <= high)) {
+        return {};
+    }
+
+    vector<RealRootInterval> found;
+    if (evaluate_point(coefficients, n, low).sign == 0) {
+        found.push_back({low, low, true});
+    }
+    if (high == low) {
+        return found;
+    }
+    if (evaluate_point(coefficients, n, high).sign == 0) {
+        found.push_back({high, high, true});
+    }
+
+    const bool parallel = resolve_threads(threads) > 1 && degree > parallel_isolation_degree;
+    TaskGroup group(ThreadPool::global());
+    Isolator isolator(coefficients, n, parallel ? &group : nullptr, tolerance);
+    isolator.bisect(low, high, 0);
+    group.wait();
+
+    vector<RealRootInterval>& pieces = isolator.found;
+    ThreadPool::global().parallel_for(pieces.size(), parallel ? resolve_threads(threads) : 1,
+                                      [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            if (pieces[i].isolated && pieces[i].low != pieces[i].high) {
+                pieces[i] = refine(coefficients, n, pieces[i], tolerance);
+            }
+        }
+    });
+
+    found.insert(found.end(), pieces.begin(), pieces.end());
+    sort(found.begin(), found.end(), [](const RealRootInterval& first, const RealRootInterval& second) {
+        return first.low < second.low;
+    });
+
+    // Neighbouring intervals that could not be told apart are reported as one.
+    vector<RealRootInterval> merged;
+    for (const auto& interval : found) {
+        if (!merged.empty() && !merged.back().isolated && !interval.isolated && interval.low <= merged.back().high) {
+            merged.back().high = max(merged.back().high, interval.high);
+        } else {
+            merged.push_back(interval);
+        }
+    }
+    return merged;
+}
+
+} // namespace polynomialc_internal
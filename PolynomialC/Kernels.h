@@ -0,0 +1,163 @@
+//
+// Internal numeric kernels shared by the Polynomial class.  The end user is not supposed to call
+// these directly; they work on raw coefficient arrays so that they can be reused by every part of
+// the library without copying.
+//
+
+#ifndef POLYNOMIALC_KERNELS_H
+#define POLYNOMIALC_KERNELS_H
+
+#include <complex>
+#include <cstddef>
+#include <vector>
+
+namespace polynomialc_internal {
+    // The series built by the keyword constructor.  ln is the series of ln(x) around x = 1.
+    enum class SeriesTable { sine, cosine, euler, ln };
+
+    // Returns the first terms coefficients of a series (fewer when the remaining ones underflow).
+    // The tables are built once, grown on demand, and shared by every thread.
+    std::vector<double> series_coefficients(SeriesTable table, size_t terms);
+
+    // Evaluates the function a series represents (sin, cos, e^x or ln) at x.  The argument is first
+    // reduced to a small range (a multiple of pi / 2, a power of 2, or a mantissa and an exponent),
+    // where a short polynomial of 10 to 15 terms is accurate to within a few ulps.
+    double series_evaluate(SeriesTable table, double x);
+
+    // Evaluates sum(coefficients[i] * (x - a)^i) at count contiguous points using Horner's scheme.
+    // The SIMD width (AVX-512, AVX2 or scalar) is picked once from the features of the running CPU.
+    void horner_batch(const double* coefficients, size_t n, double a, const double* xs, double* out,
+                      size_t count);
+    // The same in float, with twice the points per SIMD instruction.
+    void horner_batch(const float* coefficients, size_t n, float a, const float* xs, float* out, size_t count);
+
+    // Steps a table of forward differences: row k holds difference k of difference_lanes interleaved
+    // grids (table[k * difference_lanes + l] for lane l), for up to max_difference_degree + 1 rows.
+    // Each of the steps writes row 0 (difference_lanes values) to out, then adds row k + 1 to row k
+    // for every k below degree.  AVX2 is used when the running CPU has it.
+    const size_t difference_lanes = 8;
+    const size_t max_difference_degree = 3;
+    void difference_steps(double* table, size_t degree, double* out, size_t steps);
+
+    // Evaluates the Chebyshev series sum(coefficients[k] * T_k(u)), u = x * scale - shift, at count
+    // contiguous points with Clenshaw's recurrence, dispatched like horner_batch.
+    double clenshaw_point(const double* coefficients, size_t n, double u);
+    void clenshaw_batch(const double* coefficients, size_t n, double scale, double shift, const double* xs,
+                        double* out, size_t count);
+
+    // Evaluates sum(coefficients[i] * t^i) and its first and second derivatives in one Horner pass.
+    void horner_derivatives(const double* coefficients, size_t n, double t, double& value, double& first,
+                            double& second);
+
+    // Size cutoffs of the multiplication engine.  Operands shorter than karatsuba_cutoff use the
+    // schoolbook product; products with at least fft_cutoff terms (and both operands at least
+    // fft_min_operand long) use FFT convolution; everything in between uses Karatsuba.
+    // The values are the measured crossovers of random dense operands on x86-64 (g++ -O2).
+    // The fast algorithms are used unless more than 1 in fast_multiply_decayed_share of an operand's
+    // nonzero coefficients (after an exact power-of-two rescaling of x) sit over
+    // 2^fast_multiply_max_spread below its largest one, see multiply().
+    // Longer operands with at most sparse_product_ratio * (n + m - 1) pairs of nonzero terms are
+    // multiplied term by term over their nonzero coefficients instead.
+    const size_t karatsuba_cutoff = 32;
+    const size_t fft_cutoff = 512;
+    const size_t fft_min_operand = 128;
+    const int fast_multiply_max_spread = 20;
+    const size_t fast_multiply_decayed_share = 8;
+    const size_t sparse_product_ratio = 4;
+
+    // Multiplies a (n coefficients) by b (m coefficients) and writes the n + m - 1 coefficients of
+    // the product to out, which must not overlap the inputs.  The algorithm is picked from the
+    // operand sizes.
+    void multiply(const double* a, size_t n, const double* b, size_t m, double* out);
+
+    // Same as multiply, but always with Karatsuba or FFT for long operands, even when their coefficients
+    // span a wide range.  The error is then only small relative to the size of the operands (see
+    // multiply()), which is what divisions, subproduct trees and changes of variable need.
+    void multiply_fast(const double* a, size_t n, const double* b, size_t m, double* out);
+
+    // Same as multiply, but only the lowest count coefficients of the product are written to out.
+    // Terms of a and b at or above count cannot reach them and are skipped.
+    void multiply_low(const double* a, size_t n, const double* b, size_t m, double* out, size_t count);
+
+    // multiply_low with multiply_fast for long operands, for series that only need an error small
+    // relative to the size of the operands (reciprocals, compositions).
+    void multiply_fast_low(const double* a, size_t n, const double* b, size_t m, double* out, size_t count);
+
+    // Divisions whose quotient and divisor both have at least newton_division_cutoff terms use the
+    // Newton reciprocal; shorter ones use long division, which is faster there (measured like the
+    // multiplication cutoffs).
+    const size_t newton_division_cutoff = 1024;
+
+    // Writes the first count coefficients of the power series 1 / (b[0] + b[1] x + ...) to out, where
+    // b has m coefficients and b[0] is not 0.  Newton's iteration makes it cost a few products of
+    // count terms.
+    void reciprocal_series(const double* b, size_t m, double* out, size_t count);
+
+    // Divides a (n coefficients) by b (m coefficients, b[m - 1] not 0) and writes the n - m + 1
+    // coefficients of the quotient (none when n < m) and the m - 1 coefficients of the remainder.
+    // Long quotients by long divisors go through the reciprocal of the reversed divisor, in
+    // O(M(n)) steps where M(n) is the cost of a product; the others use long division.
+    void divide(const double* a, size_t n, const double* b, size_t m, double* quotient, double* remainder);
+
+    // Finds every complex root of sum(coefficients[i] * x^i) with the Aberth-Ehrlich iteration.  The
+    // per-root updates of high-degree polynomials are spread over up to threads threads (0 = all).
+    // The roots are then made real or exact conjugate pairs, within their rounding error.
+    std::vector<std::complex<double>> aberth_roots(const double* coefficients, size_t n, unsigned int threads);
+
+    // Rewrites sum(coefficients[i] * t^i) in place as a polynomial in (t - shift).  Polynomials with at
+    // least taylor_shift_cutoff coefficients are split in halves, p = low + t^m * high, which are
+    // shifted on their own and recombined with one product by (t + shift)^m, in O(M(n) log n) steps;
+    // shorter ones use repeated synthetic division, in O(n^2) steps.
+    const size_t taylor_shift_cutoff = 256;
+    void taylor_shift(double* coefficients, size_t n, double shift);
+
+    // The value of a two polynomials with different centers are combined around: the longer one keeps
+    // its a (the first one on a tie) and only the other one is rewritten.  A short polynomial is moved
+    // exactly up to rounding, while a long series (a keyword one, say) diverges away from its center.
+    template <typename T>
+    T common_center(size_t first_size, T first_a, size_t second_size, T second_a) {
+        return first_size >= second_size ? first_a : second_a;
+    }
+
+    // Writes the first count coefficients of sum(p[i] * q(t)^i) to out, where p has n coefficients and
+    // q has m; the whole composition has (n - 1)(m - 1) + 1.  The Brent-Kung scheme takes about
+    // 2 sqrt(n) products of at most count terms, plus n sums of scaled baby steps.
+    void compose(const double* p, size_t n, const double* q, size_t m, double* out, size_t count);
+
+    // Writes the first count coefficients of the series g with f(g(s)) = s to out, where f has m
+    // coefficients, f[0] is 0 and f[1] is not.  Newton's iteration makes it cost a few compositions.
+    void revert_series(const double* f, size_t m, double* out, size_t count);
+
+    // An interval [low, high] found by isolate_real_roots.  isolated is false when the bisection ran
+    // out of precision (a multiple root or a tight cluster) and the interval may hold several roots.
+    struct RealRootInterval {
+        double low;
+        double high;
+        bool isolated;
+    };
+
+    // Isolates every real root of sum(coefficients[i] * t^i) in [low, high] with Descartes' rule of
+    // signs and Vincent-Collins-Akritas bisection, then shrinks each interval to at most tolerance
+    // wide.  Subintervals of high-degree polynomials are bisected as tasks on the shared pool unless
+    // threads is 1.  The intervals are returned in ascending order.
+    std::vector<RealRootInterval> isolate_real_roots(const double* coefficients, size_t n, double low, double high,
+                                                     double tolerance, unsigned int threads);
+
+    // The individual algorithms behind multiply(), exposed for benchmarks and accuracy checks.
+    void multiply_schoolbook(const double* a, size_t n, const double* b, size_t m, double* out);
+    void multiply_karatsuba(const double* a, size_t n, const double* b, size_t m, double* out);
+    void multiply_fft(const double* a, size_t n, const double* b, size_t m, double* out);
+    void multiply_sparse(const double* a, size_t n, const double* b, size_t m, double* out);
+
+    // The individual algorithms behind taylor_shift(), with the same arguments.  The synthetic divisions
+    // add terms of one sign only when shift and the coefficients are positive, so root isolation uses
+    // them directly.
+    void taylor_shift_horner(double* coefficients, size_t n, double shift);
+    void taylor_shift_divide_conquer(double* coefficients, size_t n, double shift);
+
+    // The individual algorithms behind divide(), with the same arguments (n >= m).
+    void divide_long(const double* a, size_t n, const double* b, size_t m, double* quotient, double* remainder);
+    void divide_newton(const double* a, size_t n, const double* b, size_t m, double* quotient, double* remainder);
+}
+
+#endif //POLYNOMIALC_KERNELS_H
@@ -0,0 +1,447 @@
+//
+// Polynomial multiplication engine: schoolbook, Karatsuba and real-FFT convolution.
+//
+
+#include "Kernels.h"
+#include "Instrumentation.h"
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <limits>
+#include <vector>
+using namespace std;
+
+namespace polynomialc_internal {
+namespace {
+
+// ===== HELPERS =====
+
+void schoolbook_accumulate(const double* a, size_t n, const double* b, size_t m, double* out) {
+    // The inner loop walks out and b contiguously so the compiler can vectorize it.
+    count(PolynomialCounter::flops, 2 * n * m);
+    for (size_t i = 0; i < n; i++) {
+        const double ai = a[i];
+        if (ai == 0) {
+            continue;
+        }
+        for (size_t j = 0; j < m; j++) {
+            out[i + j] += ai * b[j];
+        }
+    }
+}
+
+// Multiplies two operands of equal length n into out (2n - 1 terms).  scratch must hold at least
+// 4n doubles; it is reused by every level of the recursion.
+void karatsuba_equal(const double* a, const double* b, size_t n, double* out, double* scratch) {
+    if (n < karatsuba_cutoff) {
+        fill(out, out + 2 * n - 1, 0.0);
+        schoolbook_accumulate(a, n, b, n, out);
+        return;
+    }
+
+    // a = a0 + x^low * a1 and b = b0 + x^low * b1, where the upper halves are the longer ones.
+    const size_t low = n / 2;
+    const size_t high = n - low;
+
+    double* a_sum = scratch;
+    double* b_sum = a_sum + high;
+    double* middle = b_sum + high;
+    double* next_scratch = middle + 2 * high - 1;
+
+    // z0 = a0 * b0 goes to the bottom of out, z2 = a1 * b1 goes to the top.
+    karatsuba_equal(a, b, low, out, next_scratch);
+    out[2 * low - 1] = 0;
+    karatsuba_equal(a + low, b + low, high, out + 2 * low, next_scratch);
+
+    // z1 = (a0 + a1) * (b0 + b1) - z0 - z2 is added to the middle of out.
+    for (size_t i = 0; i < high; i++) {
+        a_sum[i] = a[low + i] + (i < low ? a[i] : 0);
+        b_sum[i] = b[low + i] + (i < low ? b[i] : 0);
+    }
+    karatsuba_equal(a_sum, b_sum, high, middle, next_scratch);
+    for (size_t i = 0; i < 2 * low - 1; i++) {
+        middle[i] -= out[i];
+    }
+    for (size_t i = 0; i < 2 * high - 1; i++) {
+        middle[i] -= out[2 * low + i];
+    }
+    for (size_t i = 0; i < 2 * high - 1; i++) {
+        out[low + i] += middle[i];
+    }
+}
+
+// Iterative radix-2 FFT.  roots holds exp(-2 * pi * i * k / size) for k < size / 2.
+void fft(complex<double>* data, size_t size, const complex<double>* roots, bool inverse) {
+    for (size_t i = 1, j = 0; i < size; i++) {
+        size_t bit = size >> 1;
+        for (; j & bit; bit >>= 1) {
+            j ^= bit;
+        }
+        j ^= bit;
+        if (i < j) {
+            swap(data[i], data[j]);
+        }
+    }
+
+    for (size_t length = 2; length <= size; length <<= 1) {
+        // size / 2 butterflies, each a complex multiply and two complex additions.
+        count(PolynomialCounter::flops, 5 * size);
+        const size_t half = length / 2;
+        const size_t step = size / length;
+        for (size_t start = 0; start < size; start += length) {
+            for (size_t k = 0; k < half; k++) {
+                complex<double> w = inverse ? conj(roots[k * step]) : roots[k * step];
+                complex<double> u = data[start + k];
+                complex<double> v = data[start + k + half] * w;
+                data[start + k] = u + v;
+                data[start + k + half] = u - v;
+            }
+        }
+    }
+}
+
+const complex<double>* fft_roots(size_t size) {
+    // The twiddle factors are computed directly with cos/sin (no recurrence) to keep the FFT error
+    // bound tight, and cached per thread because consecutive products usually share a size.
+    thread_local vector<complex<double>> roots;
+    if (roots.size() != size / 2) {
+        roots.resize(size / 2);
+        const double pi = 3.14159265358979323846;
+        for (size_t k = 0; k < size / 2; k++) {
+            double angle = -2.0 * pi * double(k) / double(size);
+            roots[k] = complex<double>(cos(angle), sin(angle));
+        }
+    }
+    return roots.data();
+}
+
+int largest_exponent(const double* values, size_t count) {
+    // The binary exponent of the largest magnitude, kept where 2^-exponent is a normal double (0 for
+    // an operand of zeros).
+    double largest = 0;
+    for (size_t i = 0; i < count; i++) {
+        largest = max(largest, fabs(values[i]));
+    }
+    if (largest == 0 || !isfinite(largest)) {
+        return 0;
+    }
+    return max(-1000, min(1000, ilogb(largest)));
+}
+
+// Picks an exact power-of-two substitution x -> 2^shift * x that flattens the coefficient
+// magnitudes of both operands, then reports whether the fast algorithms suit the flattened operands.
+// Their error is bounded relative to the norms of the operands, which is all a product of ordinary
+// operands needs, so a few small coefficients (or cancellations in an earlier product) do not count.
+// Operands that really decay, where more than 1 in fast_multiply_decayed_share of the nonzero
+// coefficients still sit over 2^fast_multiply_max_spread below the largest after the substitution
+// (such as the 1/i! keyword series, whose decay is faster than any power of two), stay on
+// schoolbook, which is accurate term by term.
+bool fast_multiply_safe(const double* a, size_t n, const double* b, size_t m, int& shift) {
+    const double* operands[2] = {a, b};
+    const size_t sizes[2] = {n, m};
+
+    // A least-squares fit of the binary exponents against the power of x gives the decay rate.
+    double count = 0, sum_i = 0, sum_e = 0, sum_ii = 0, sum_ie = 0;
+    for (int k = 0; k < 2; k++) {
+        for (size_t i = 0; i < sizes[k]; i++) {
+            double c = operands[k][i];
+            if (!isfinite(c)) {
+                return false;
+            }
+            if (c == 0) {
+                continue;
+            }
+            double e = ilogb(c);
+            count += 1;
+            sum_i += double(i);
+            sum_e += e;
+            sum_ii += double(i) * double(i);
+            sum_ie += double(i) * e;
+        }
+    }
+    double denominator = count * sum_ii - sum_i * sum_i;
+    double slope = denominator > 0 ? (count * sum_ie - sum_i * sum_e) / denominator : 0.0;
+    shift = -int(lround(max(-512.0, min(512.0, slope))));
+
+    int top = 0;
+    for (int k = 0; k < 2; k++) {
+        long highest = numeric_limits<long>::min();
+        for (size_t i = 0; i < sizes[k]; i++) {
+            if (operands[k][i] != 0) {
+                highest = max(highest, long(ilogb(operands[k][i])) + long(shift) * long(i));
+            }
+        }
+        if (highest == numeric_limits<long>::min()) {
+            continue;
+        }
+        if (highest < -900 || highest > 900) {
+            return false;
+        }
+
+        size_t nonzero = 0;
+        size_t decayed = 0;
+        for (size_t i = 0; i < sizes[k]; i++) {
+            if (operands[k][i] != 0) {
+                nonzero++;
+                if (long(ilogb(operands[k][i])) + long(shift) * long(i) < highest - fast_multiply_max_spread) {
+                    decayed++;
+                }
+            }
+        }
+        if (decayed * fast_multiply_decayed_share > nonzero) {
+            return false;
+        }
+        top += int(max(highest, 0L));
+    }
+
+    // The scaled product must not overflow either.
+    return top + 64 < 1000;
+}
+
+} // namespace
+
+
+// ===== ALGORITHMS =====
+
+void multiply_schoolbook(const double* a, size_t n, const double* b, size_t m, double* out) {
+    if (n == 0 || m == 0) {
+        return;
+    }
+    fill(out, out + n + m - 1, 0.0);
+    schoolbook_accumulate(a, n, b, m, out);
+}
+
+void multiply_karatsuba(const double* a, size_t n, const double* b, size_t m, double* out) {
+    if (n < m) {
+        swap(a, b);
+        swap(n, m);
+    }
+    if (m == 0) {
+        return;
+    }
+    if (m < karatsuba_cutoff) {
+        multiply_schoolbook(a, n, b, m, out);
+        return;
+    }
+
+    vector<double> scratch(4 * m + 256);
+    if (n == m) {
+        karatsuba_equal(a, b, n, out, scratch.data());
+        return;
+    }
+
+    // An unbalanced product is split into blocks of the shorter operand's length.
+    fill(out, out + n + m - 1, 0.0);
+    vector<double> block(2 * m - 1);
+    for (size_t start = 0; start < n; start += m) {
+        size_t length = min(m, n - start);
+        if (length == m) {
+            karatsuba_equal(a + start, b, m, block.data(), scratch.data());
+        } else {
+            multiply(a + start, length, b, m, block.data());
+        }
+        for (size_t i = 0; i < length + m - 1; i++) {
+            out[start + i] += block[i];
+        }
+    }
+}
+
+void multiply_sparse(const double* a, size_t n, const double* b, size_t m, double* out) {
+    if (n == 0 || m == 0) {
+        return;
+    }
+    fill(out, out + n + m - 1, 0.0);
+    vector<size_t> nonzero_b;
+    for (size_t j = 0; j < m; j++) {
+        if (b[j] != 0) {
+            nonzero_b.push_back(j);
+        }
+    }
+    count(PolynomialCounter::flops, 2 * nonzero_b.size() * n);
+    for (size_t i = 0; i < n; i++) {
+        const double ai = a[i];
+        if (ai == 0) {
+            continue;
+        }
+        for (size_t j : nonzero_b) {
+            out[i + j] += ai * b[j];
+        }
+    }
+}
+
+void multiply_fft(const double* a, size_t n, const double* b, size_t m, double* out) {
+    if (n == 0 || m == 0) {
+        return;
+    }
+
+    const size_t result_size = n + m - 1;
+    size_t size = 1;
+    while (size < result_size) {
+        size <<= 1;
+    }
+    if (size < 2) {
+        size = 2;
+    }
+
+    // Both real operands are packed into one complex signal z = a + ib, so a single forward
+    // transform yields both spectra: A[k] * B[k] = (Z[k]^2 - conj(Z[-k])^2) / 4i.  The rounding
+    // errors of the transform then scale with the larger operand, so both are first brought to a
+    // largest coefficient near 1 by exact powers of two (undone on the product).
+    const int a_exponent = largest_exponent(a, n);
+    const int b_exponent = largest_exponent(b, m);
+    const double a_scale = ldexp(1.0, -a_exponent);
+    const double b_scale = ldexp(1.0, -b_exponent);
+    vector<complex<double>> z(size);
+    for (size_t i = 0; i < n; i++) {
+        z[i].real(a[i] * a_scale);
+    }
+    for (size_t i = 0; i < m; i++) {
+        z[i].imag(b[i] * b_scale);
+    }
+
+    const complex<double>* roots = fft_roots(size);
+    fft(z.data(), size, roots, false);
+
+    vector<complex<double>> product(size);
+    const complex<double> quarter_i(0, -0.25);
+    for (size_t k = 0; k < size; k++) {
+        complex<double> zk = z[k];
+        complex<double> zm = conj(z[(size - k) & (size - 1)]);
+        product[k] = (zk * zk - zm * zm) * quarter_i;
+    }
+
+    fft(product.data(), size, roots, true);
+    const int exponent = a_exponent + b_exponent;
+    if (exponent >= -1000 && exponent <= 1000) {
+        const double scale = ldexp(1.0 / double(size), exponent);
+        for (size_t i = 0; i < result_size; i++) {
+            out[i] = product[i].real() * scale;
+        }
+    } else {
+        for (size_t i = 0; i < result_size; i++) {
+            out[i] = ldexp(product[i].real() / double(size), exponent);
+        }
+    }
+}
+
+
+// ===== DISPATCH =====
+
+void multiply(const double* a, size_t n, const double* b, size_t m, double* out) {
+    if (n == 0 || m == 0) {
+        return;
+    }
+
+    if (min(n, m) < karatsuba_cutoff) {
+        multiply_schoolbook(a, n, b, m, out);
+        return;
+    }
+
+    // Operands that are mostly zeros (such as x^4000 + 3x^2 + 1) are multiplied over their nonzero
+    // terms only, which is both faster and exact term by term.
+    const size_t nonzero_a = (size_t) count_if(a, a + n, [](double c) { return c != 0; });
+    const size_t nonzero_b = (size_t) count_if(b, b + m, [](double c) { return c != 0; });
+    if (nonzero_a * nonzero_b <= sparse_product_ratio * (n + m - 1)) {
+        multiply_sparse(a, n, b, m, out);
+        return;
+    }
+
+    int shift = 0;
+    if (!fast_multiply_safe(a, n, b, m, shift)) {
+        multiply_schoolbook(a, n, b, m, out);
+        return;
+    }
+
+    // The operands are flattened with the exact substitution x -> 2^shift * x, multiplied, and the
+    // substitution is undone on the product.
+    vector<double> scaled_a(a, a + n);
+    vector<double> scaled_b(b, b + m);
+    if (shift != 0) {
+        for (size_t i = 0; i < n; i++) {
+            scaled_a[i] = ldexp(scaled_a[i], shift * int(i));
+        }
+        for (size_t i = 0; i < m; i++) {
+            scaled_b[i] = ldexp(scaled_b[i], shift * int(i));
+        }
+    }
+
+    if (n + m - 1 >= fft_cutoff && min(n, m) >= fft_min_operand) {
+        multiply_fft(scaled_a.data(), n, scaled_b.data(), m, out);
+    } else {
+        multiply_karatsuba(scaled_a.data(), n, scaled_b.data(), m, out);
+    }
+
+    if (shift != 0) {
+        for (size_t i = 0; i < n + m - 1; i++) {
+            out[i] = ldexp(out[i], -shift * int(i));
+        }
+    }
+}
+
+void multiply_fast(const double* a, size_t n, const double* b, size_t m, double* out) {
+    if (n == 0 || m == 0) {
+        return;
+    }
+    if (min(n, m) < karatsuba_cutoff) {
+        multiply_schoolbook(a, n, b, m, out);
+    } else if (n + m - 1 >= fft_cutoff && min(n, m) >= fft_min_operand) {
+        multiply_fft(a, n, b, m, out);
+    } else {
+        multiply_karatsuba(a, n, b, m, out);
+    }
+}
+
+void multiply_low(const double* a, size_t n, const double* b, size_t m, double* out, size_t count) {
+    n = min(n, count);
+    m = min(m, count);
+    if (n == 0 || m == 0) {
+        fill(out, out + count, 0.0);
+        return;
+    }
+
+    const size_t full_size = n + m - 1;
+    if (full_size <= count) {
+        multiply(a, n, b, m, out);
+        fill(out + full_size, out + count, 0.0);
+        return;
+    }
+
+    // Small truncated products only compute the kept terms; larger ones compute the full product
+    // with the fast algorithms and drop the top.
+    if (min(n, m) < karatsuba_cutoff) {
+        fill(out, out + count, 0.0);
+        for (size_t i = 0; i < n; i++) {
+            const double ai = a[i];
+            if (ai == 0) {
+                continue;
+            }
+            const size_t length = min(m, count - i);
+            polynomialc_internal::count(PolynomialCounter::flops, 2 * length);
+            for (size_t j = 0; j < length; j++) {
+                out[i + j] += ai * b[j];
+            }
+        }
+        return;
+    }
+
+    vector<double> full(full_size);
+    multiply(a, n, b, m, full.data());
+    copy(full.begin(), full.begin() + count, out);
+}
+
+void multiply_fast_low(const double* a, size_t n, const double* b, size_t m, double* out, size_t count) {
+    n = min(n, count);
+    m = min(m, count);
+    if (min(n, m) < karatsuba_cutoff) {
+        multiply_low(a, n, b, m, out, count);
+        return;
+    }
+    vector<double> full(n + m - 1);
+    multiply_fast(a, n, b, m, full.data());
+    const size_t kept = min(count, full.size());
+    copy(full.begin(), full.begin() + kept, out);
+    fill(out + kept, out + count, 0.0);
+}
+
+} // namespace polynomialc_internal
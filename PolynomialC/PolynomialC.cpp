@@ -3,121 +3,380 @@
 //
 
 #include "PolynomialC.h"
+#include "GridEvaluator.h"
+#include "Instrumentation.h"
+#include "Kernels.h"
+#include "SparsePolynomial.h"
+#include "SubproductTree.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <locale>
+#include <string_view>
+#include <utility>
 
 // ===== HELPER FUNCTIONS =====
 
-double factorial(int x) {
-    double result = 1;
+template <typename List>
+void remove_top_zero_terms(List& coefficient_list) {
+    // If the constants for the upper terms are 0, they are dropped from the constant list.
+    const size_t size = coefficient_list.size();
+    while (!coefficient_list.empty() && coefficient_list.back() == 0) {
+        coefficient_list.pop_back();
+    }
+    polynomialc_internal::count(PolynomialCounter::trim_scans, 1);
+    polynomialc_internal::count(PolynomialCounter::trimmed_terms, size - coefficient_list.size());
+}
+
+void add_terms(CoefficientList& target, span<const double> source, double sign) {
+    // The target grows with empty terms if the source has more terms, then sign * source is added.
+    if (target.size() < source.size()) {
+        target.resize(source.size(), 0.0);
+    }
+    for (size_t i = 0; i < source.size(); i++) {
+        target[i] += sign * source[i];
+    }
+    remove_top_zero_terms(target);
+}
 
-    for (int i = 1; i <= x; i++) {
-        result *= i;
+size_t product_size(span<const double> first, span<const double> second) {
+    // The product of polynomials with n and m terms has n + m - 1 terms (none if either is empty).
+    if (first.empty() || second.empty()) {
+        return 0;
+    }
+    return first.size() + second.size() - 1;
+}
+
+double common_center(const Polynomial& first, const Polynomial& second) {
+    // Polynomials with different values of a are combined around the longer one's (see Kernels.h).
+    return polynomialc_internal::common_center(first.coefficients().size(), first.get_a(),
+                                               second.coefficients().size(), second.get_a());
+}
+
+PolynomialKeyword parse_keyword(const string& name) {
+    // The names accepted by the keyword constructor and Polynomial::series.
+    if (name == "sine" || name == "sin") {
+        return PolynomialKeyword::sine;
+    } else if (name == "cosine" || name == "cos") {
+        return PolynomialKeyword::cosine;
+    } else if (name == "euler" || name == "e^x" || name == "e") {
+        return PolynomialKeyword::euler;
+    } else if (name == "ln" || name == "lnx" || name == "log" || name == "logx") {
+        return PolynomialKeyword::ln;
+    }
+    throw invalid_argument(name + " is not a valid keyword.");
+}
+
+polynomialc_internal::SeriesTable keyword_table(PolynomialKeyword keyword) {
+    // Maps the keyword stored by the keyword constructor to its series.
+    using polynomialc_internal::SeriesTable;
+    switch (keyword) {
+        case PolynomialKeyword::sine:
+            return SeriesTable::sine;
+        case PolynomialKeyword::cosine:
+            return SeriesTable::cosine;
+        case PolynomialKeyword::euler:
+            return SeriesTable::euler;
+        default:
+            return SeriesTable::ln;
+    }
+}
+
+CoefficientList raise_to_power(span<const double> base, unsigned int x, size_t max_terms) {
+    // Any polynomial to the 0th power is 1.
+    if (x == 0) {
+        return {1};
+    }
+
+    CoefficientList truncated_base(base.first(min(base.size(), max_terms)));
+    remove_top_zero_terms(truncated_base);
+    if (truncated_base.empty()) {
+        return truncated_base;
+    }
+
+    // The bits of x are walked from the top: every bit squares the result, and every set bit also
+    // multiplies it by the base once more.
+    int bit = 31;
+    while (!((x >> bit) & 1)) {
+        bit--;
+    }
+
+    // Low powers of low-degree polynomials stay in the inline storage of the lists.
+    CoefficientList result = truncated_base;
+    CoefficientList product;
+    for (bit--; bit >= 0; bit--) {
+        product.resize(min(product_size(result, result), max_terms));
+        polynomialc_internal::multiply_low(result.data(), result.size(), result.data(), result.size(),
+                                           product.data(), product.size());
+        remove_top_zero_terms(product);
+        swap(result, product);
+
+        if ((x >> bit) & 1) {
+            product.resize(min(product_size(result, truncated_base), max_terms));
+            polynomialc_internal::multiply_low(result.data(), result.size(), truncated_base.data(),
+                                               truncated_base.size(), product.data(), product.size());
+            remove_top_zero_terms(product);
+            swap(result, product);
+        }
     }
 
     return result;
 }
 
-void remove_top_zero_terms(vector<double>& coefficient_list) {
-    // If the constants for the upper terms are 0, they are dropped from the constant list.
-    while (coefficient_list[coefficient_list.size() - 1] == 0) {
-        coefficient_list.erase(coefficient_list.end() - 1);
+CoefficientList compose_terms(span<const double> outer, double a, span<const double> inner, size_t max_terms) {
+    // p(q) = sum(c_i * (q - a)^i), so the outer polynomial's a comes off the inner one's constant.
+    CoefficientList shifted(inner);
+    if (shifted.empty()) {
+        shifted.resize(1, 0.0);
+    }
+    shifted[0] -= a;
+
+    size_t size = 0;
+    if (!outer.empty()) {
+        size = shifted.size() < 2 ? 1 : (outer.size() - 1) * (shifted.size() - 1) + 1;
     }
+    CoefficientList result(min(size, max_terms), 0.0);
+    polynomialc_internal::compose(outer.data(), outer.size(), shifted.data(), shifted.size(), result.data(),
+                                  result.size());
+    remove_top_zero_terms(result);
+    return result;
 }
 
-void Polynomial::hidden_display(const string& set_keyword) const {
-    if (!coefficient_list.empty()) {
-        if (set_keyword != "simple") {
-            for (int i = 0; i < coefficient_list.size(); i++) {
-                // If the user wants to see a reduced representation of the polynomial, all terms with
-                // 0 as their coefficient will be hidden.
-                if (coefficient_list[i] == 0 && set_keyword == "reduced") {
-                    continue;
-                }
+// The text sinks of the formatter.  Each one takes the pieces of text with append() and the
+// coefficients with number().
+class StringSink {
+    string& text;
+    bool round_trip;
 
-                if (a == 0) {
-                    cout << "(" << coefficient_list[i] << " * x^" << i << ")";
-                } else if (a > 0) {
-                    cout << "(" << coefficient_list[i] << " * (x - " << a << ")^" << i << ")";
-                } else {
-                    cout << "(" << coefficient_list[i] << " * (x + " << a * -1 << ")^" << i << ")";
-                }
+public:
+    StringSink(string& text, bool round_trip) : text(text), round_trip(round_trip) {}
 
+    void append(const char* piece, size_t size) {
+        text.append(piece, size);
+    }
 
-                if (check_ahead(i) || set_keyword != "reduced") {
-                    cout << " + ";
-                }
+    void number(double value) {
+        char digits[32];
+        const to_chars_result result = round_trip ? to_chars(digits, digits + sizeof(digits), value)
+                                                  : to_chars(digits, digits + sizeof(digits), value,
+                                                             chars_format::general, 6);
+        append(digits, size_t(result.ptr - digits));
+    }
+};
 
-            }
-        } else {
-            for (int i = coefficient_list.size() - 1; i >= 0; i--) {
-                // All 0 terms will be hidden in a simple display.
-                if (coefficient_list[i] == 0) {
-                    continue;
-                }
+class BufferSink {
+    char* next;
+    char* last;
+    bool round_trip;
 
-                // If the coefficient is an integer, then it will be appended next to x instead of
-                // being displayed as multiplied by x.
-                if (floor(coefficient_list[i]) == ceil(coefficient_list[i])) {
-                    if (coefficient_list[i] != 1 || i == 0) {
-                        cout << coefficient_list[i];
-                    }
-                    if (i > 0) {
-                        if (a == 0) {
-                            cout << "x";
-                        } else if (a > 0) {
-                            cout << "(x - " << a << ")";
-                        } else {
-                            cout << "(x + " << a * -1 << ")";
-                        }
-                    }
-                    if (i > 1) {
-                        cout << "^" << i;
-                    }
-                } else {
-                    if (coefficient_list[i] != 1 || i == 0) {
-                        cout << "(" << coefficient_list[i] << ")";
-                    }
-                    if (i > 0) {
-                        if (a == 0) {
-                            cout << " * x";
-                        } else if (a > 0) {
-                            cout << " * (x - " << a << ")";
-                        } else {
-                            cout << " * (x + " << a * -1 << ")";
-                        }
-                    }
-                    if (i > 1) {
-                        cout << "^" << i;
-                    }
-                }
+public:
+    bool overflow = false;
 
-                if (check_behind(i)) {
-                    cout << " + ";
-                }
+    BufferSink(char* first, char* last, bool round_trip) : next(first), last(last), round_trip(round_trip) {}
+
+    char* end() const { return next; }
+
+    void append(const char* piece, size_t size) {
+        if (overflow || size > size_t(last - next)) {
+            overflow = true;
+            return;
+        }
+        memcpy(next, piece, size);
+        next += size;
+    }
+
+    void number(double value) {
+        if (overflow) {
+            return;
+        }
+        const to_chars_result result = round_trip ? to_chars(next, last, value)
+                                                  : to_chars(next, last, value, chars_format::general, 6);
+        if (result.ec != errc()) {
+            overflow = true;
+            return;
+        }
+        next = result.ptr;
+    }
+};
+
+// Collects the text in a local buffer and hands it to the stream in large writes.  Numbers follow the
+// stream's precision and fixed or scientific flags, like operator<< on a double would; other flags
+// and locales go through the stream itself.
+class StreamSink {
+    ostream& out;
+    bool round_trip;
+    bool plain;
+    chars_format style;
+    int precision;
+    char buffer[4096];
+    size_t used = 0;
+
+public:
+    StreamSink(ostream& out, bool round_trip) : out(out), round_trip(round_trip) {
+        const ios::fmtflags flags = out.flags();
+        const ios::fmtflags floatfield = flags & ios::floatfield;
+        plain = !(flags & (ios::showpos | ios::showpoint | ios::uppercase)) &&
+                floatfield != (ios::fixed | ios::scientific) && out.getloc() == locale::classic();
+        style = floatfield == ios::fixed ? chars_format::fixed
+                : floatfield == ios::scientific ? chars_format::scientific : chars_format::general;
+        precision = int(out.precision());
+    }
+
+    ~StreamSink() {
+        flush();
+    }
+
+    void flush() {
+        out.write(buffer, streamsize(used));
+        used = 0;
+    }
+
+    void append(const char* piece, size_t size) {
+        if (size > sizeof(buffer) - used) {
+            flush();
+            if (size > sizeof(buffer)) {
+                out.write(piece, streamsize(size));
+                return;
             }
         }
+        memcpy(buffer + used, piece, size);
+        used += size;
+    }
+
+    void number(double value) {
+        if (!round_trip && !plain) {
+            flush();
+            out << value;
+            return;
+        }
+        char digits[64];
+        const to_chars_result result = round_trip ? to_chars(digits, digits + sizeof(digits), value)
+                                                  : to_chars(digits, digits + sizeof(digits), value, style,
+                                                             precision);
+        if (result.ec != errc()) {
+            // A long fixed-point number; the stream formats it instead.
+            flush();
+            out << value;
+            return;
+        }
+        append(digits, size_t(result.ptr - digits));
+    }
+};
+
+template <typename Sink>
+void append_text(Sink& sink, string_view text) {
+    sink.append(text.data(), text.size());
+}
+
+template <typename Sink>
+void append_exponent(Sink& sink, size_t i) {
+    char digits[24];
+    const to_chars_result result = to_chars(digits, digits + sizeof(digits), i);
+    sink.append(digits, size_t(result.ptr - digits));
+}
+
+template <typename Sink>
+void write_base(Sink& sink, double a) {
+    // x, (x - a) or (x + |a|).
+    if (a == 0) {
+        append_text(sink, "x");
     } else {
-        cout << "There are no terms in this polynomial.";
+        append_text(sink, a > 0 ? "(x - " : "(x + ");
+        sink.number(fabs(a));
+        append_text(sink, ")");
     }
 }
 
-bool Polynomial::check_behind(int index) const {
-    // This function checks if there is a lesser term of the polynomial before the current one.
-    for (int i = index - 1; i >= 0; i--) {
-        if (coefficient_list[i] != 0) {
-            return true;
+template <typename Sink>
+void write_simple_term(Sink& sink, double coefficient, size_t i, double a, bool& first) {
+    // One nonzero term of the simple display, preceded by " + " unless it is the first one.
+    if (!first) {
+        append_text(sink, " + ");
+    }
+    first = false;
+
+    // If the coefficient is an integer, then it will be appended next to x instead of being
+    // displayed as multiplied by x.
+    const bool integer = floor(coefficient) == ceil(coefficient);
+    if (coefficient != 1 || i == 0) {
+        if (integer) {
+            sink.number(coefficient);
+        } else {
+            append_text(sink, "(");
+            sink.number(coefficient);
+            append_text(sink, ")");
+        }
+    }
+    if (i > 0) {
+        if (!integer) {
+            append_text(sink, " * ");
         }
+        write_base(sink, a);
+    }
+    if (i > 1) {
+        append_text(sink, "^");
+        append_exponent(sink, i);
     }
-    return false;
 }
 
-bool Polynomial::check_ahead(int index) const {
-    // This function checks if there is a greater term of the polynomial before the current one.
-    for (int i = index; i < coefficient_list.size() - 1; i++) {
-        if (coefficient_list[i] != 0) {
-            return true;
+template <typename Sink>
+void write_terms(Sink& sink, span<const double> coefficients, double a, DisplayMode mode) {
+    // Writes the polynomial in one pass over its coefficients: the terms are joined with " + " as
+    // they are written, so no term has to look at the others.
+    if (coefficients.empty()) {
+        append_text(sink, "There are no terms in this polynomial.");
+        return;
+    }
+
+    bool first = true;
+    if (mode != DisplayMode::simple) {
+        for (size_t i = 0; i < coefficients.size(); i++) {
+            // If the user wants to see a reduced representation of the polynomial, all terms with 0 as
+            // their coefficient will be hidden.
+            if (coefficients[i] == 0 && mode == DisplayMode::reduced) {
+                continue;
+            }
+            if (!first) {
+                append_text(sink, " + ");
+            }
+            first = false;
+
+            append_text(sink, "(");
+            sink.number(coefficients[i]);
+            append_text(sink, " * ");
+            write_base(sink, a);
+            append_text(sink, "^");
+            append_exponent(sink, i);
+            append_text(sink, ")");
+        }
+        return;
+    }
+
+    for (size_t i = coefficients.size(); i-- > 0;) {
+        // All 0 terms will be hidden in a simple display.
+        if (coefficients[i] != 0) {
+            write_simple_term(sink, coefficients[i], i, a, first);
         }
     }
-    return false;
+}
+
+DisplayMode display_mode(const string& keyword) {
+    if (keyword == "simple") {
+        return DisplayMode::simple;
+    }
+    return keyword == "reduced" ? DisplayMode::reduced : DisplayMode::all;
+}
+
+void Polynomial::move_center(double new_a) {
+    // Rewrites the coefficients in powers of (x - new_a) without changing the function, so a keyword
+    // polynomial keeps its keyword.
+    if (new_a == a) {
+        return;
+    }
+    polynomialc_internal::taylor_shift(coefficient_list.data(), coefficient_list.size(), new_a - a);
+    a = new_a;
 }
 
 
@@ -128,9 +387,9 @@ bool Polynomial::check_ahead(int index) const {
  * The default constructor creates a polynomial with a constant of 0.
  */
 Polynomial::Polynomial() {
-    coefficient_list = {0};
+    coefficient_list.resize(1, 0);
     a = 0;
-    keyword = "";
+    keyword = PolynomialKeyword::none;
 }
 
 
@@ -140,16 +399,39 @@ Polynomial::Polynomial() {
  */
 Polynomial::Polynomial(vector<double> set_coefficient_list, double set_a=0) {
     remove_top_zero_terms(set_coefficient_list);
-    coefficient_list = set_coefficient_list;
+    coefficient_list.assign(set_coefficient_list);
     a = set_a;
-    keyword = "";
+    keyword = PolynomialKeyword::none;
+}
+
+
+/* Resource Constructor
+ *
+ * Same as the list constructor, but the coefficient list allocates from the given memory resource
+ * instead of the thread's current one (see PolynomialMemory.h).  The polynomial keeps using the
+ * resource for its whole life, so the resource has to outlive it.
+ *
+ * Parameters: The coefficients (Span of doubles), the value of a (Double), the memory resource to
+ * allocate from.  (Memory resource pointer)
+ */
+Polynomial::Polynomial(span<const double> set_coefficient_list, double set_a, pmr::memory_resource* resource)
+    : coefficient_list(resource) {
+    while (!set_coefficient_list.empty() && set_coefficient_list.back() == 0) {
+        set_coefficient_list = set_coefficient_list.first(set_coefficient_list.size() - 1);
+    }
+    coefficient_list.assign(set_coefficient_list);
+    a = set_a;
+    keyword = PolynomialKeyword::none;
 }
 
 
 /* Keyword Constructor
  *
  * The keyword constructor creates special sequences of polynomials that are meant to represent
- * non-polynomial functions such as sine(x) and e^x.  These approximations are accurate to 100 terms.
+ * non-polynomial functions such as sine(x) and e^x.  The coefficients come from tables that are built
+ * once per process and shared by every keyword polynomial, so constructing one only copies them.
+ * Terms that would underflow to 0 (past about 1/170!) are left out, so sine, cosine and e^x stop
+ * at about 170 terms.  Use Polynomial::series to choose a different number of terms than 1000.
  *
  * Parameters: A keyword for a specific non-polynomial function.  (String)
  * - "sine" or "sin": Creates a polynomial that is a representation for sine.
@@ -157,62 +439,34 @@ Polynomial::Polynomial(vector<double> set_coefficient_list, double set_a=0) {
  * - "euler", "e^x", or "e": Creates a polynomial that is a representation for e^x.
  * - "ln", "lnx", "log", or "logx": Creates a polynomial that is a representation for ln(x).
  */
-Polynomial::Polynomial(const string& keyword) {
-    bool negative = false;
-    double value = 0;
-    int precision = 1000;
-    a = 0;
+Polynomial::Polynomial(const string& keyword) : Polynomial(series(keyword, 1000)) {
+    // Only the full series carries its keyword, and with it the range-reduced evaluation.
+    this->keyword = parse_keyword(keyword);
+}
 
-    if (keyword == "sine" || keyword == "sin") {
-        this->keyword = "sine";
-        for (int i = 0; i < precision; i++) {
-            if (i % 2 == 1) {
-                value = 1.0f / factorial(i);
-                if (negative) {
-                    value *= -1;
-                }
-                coefficient_list.push_back(value);
-                negative = !negative;
-            } else {
-                coefficient_list.push_back(0);
-            }
-        }
-    } else if (keyword == "cosine" || keyword == "cos") {
-        this->keyword = "cosine";
-        for (int i = 0; i < precision; i++) {
-            if (i % 2 == 0) {
-                value = 1.0f / factorial(i);
-                if (negative) {
-                    value *= -1;
-                }
-                coefficient_list.push_back(value);
-                negative = !negative;
-            } else {
-                coefficient_list.push_back(0);
-            }
-        }
-    } else if (keyword == "euler" || keyword == "e^x" || keyword == "e") {
-        this->keyword = "euler";
-        for (int i = 0; i < precision; i++) {
-            value = 1.0f / factorial(i);
-            coefficient_list.push_back(value);
-        }
-    } else if (keyword == "ln" || keyword == "lnx" || keyword == "log" || keyword == "logx") {
-        this->keyword = "ln";
-        coefficient_list.push_back(0);
-        a = 1;
-        for (int i = 1; i < precision; i++) {
-            value = 1.0f / float(i);
-            if (negative) {
-                value *= -1;
-            }
-            coefficient_list.push_back(value);
-            negative = !negative;
-        }
-    } else {
-        throw invalid_argument(keyword + " is not a valid keyword.");
+
+/* Series
+ *
+ * Creates the coefficients of the keyword constructor's polynomials, but with a chosen maximum number
+ * of terms.  Fewer terms make the polynomial cheaper to multiply, differentiate or raise to a power.
+ * Unlike a keyword polynomial, a series polynomial is an ordinary polynomial: it is solved as written,
+ * so its values, derivative and roots all agree with its coefficients.
+ *
+ * Parameters: A keyword for a specific non-polynomial function (String, see the keyword constructor),
+ * the maximum number of terms in the approximation.  (Unsigned Integer)
+ * Returns: The series polynomial.  (Polynomial)
+ */
+Polynomial Polynomial::series(const string& keyword, unsigned int terms) {
+    polynomialc_internal::ScopedTimer timer(PolynomialOperation::series);
+
+    const PolynomialKeyword function = parse_keyword(keyword);
+    Polynomial result;
+    if (function == PolynomialKeyword::ln) {
+        result.a = 1;
     }
-    remove_top_zero_terms(coefficient_list);
+    result.coefficient_list.assign(
+        polynomialc_internal::series_coefficients(keyword_table(function), terms));
+    return result;
 }
 
 
@@ -224,12 +478,26 @@ Polynomial::Polynomial(const string& keyword) {
 
 /* Get coefficients
  *
- * Returns the coefficient list for this polynomial as a vector of doubles.
+ * Returns a copy of the coefficient list for this polynomial as a vector of doubles.  Use
+ * coefficients() to read the coefficients without copying them.
  *
  * Parameters: None.
  * Returns: The list of coefficients for the polynomial.  (Vector of doubles)
  */
 vector<double> Polynomial::get_coefficients() const {
+    return coefficient_list.to_vector();
+}
+
+
+/* Coefficients
+ *
+ * Returns a read-only view of the coefficient list, for passing the coefficients on without a copy.
+ * The view stays valid until the polynomial is changed or destroyed.
+ *
+ * Parameters: None.
+ * Returns: The coefficients for the polynomial.  (Span of doubles)
+ */
+span<const double> Polynomial::coefficients() const {
     return coefficient_list;
 }
 
@@ -242,7 +510,9 @@ vector<double> Polynomial::get_coefficients() const {
  * Returns: None.
  */
 void Polynomial::set_coefficients(vector<double> new_coefficients) {
-    coefficient_list = new_coefficients;
+    coefficient_list.assign(new_coefficients);
+    // A polynomial with new coefficients no longer represents the keyword function.
+    keyword = PolynomialKeyword::none;
 }
 
 
@@ -267,6 +537,19 @@ double Polynomial::get_a() const {
  */
 void Polynomial::set_a(double new_a) {
     a = new_a;
+    keyword = PolynomialKeyword::none;
+}
+
+
+/* Get resource
+ *
+ * Returns the memory resource the coefficient list allocates from once it outgrows the inline storage.
+ *
+ * Parameters: None.
+ * Returns: The memory resource of the polynomial.  (Memory resource pointer)
+ */
+pmr::memory_resource* Polynomial::get_resource() const {
+    return coefficient_list.resource();
 }
 
 
@@ -275,24 +558,214 @@ void Polynomial::set_a(double new_a) {
 
 /* Solve
  *
- * The solve function takes an input for x and solves the polynomial using the value for x.
+ * The solve function takes an input for x and solves the polynomial using the value for x, with
+ * Horner's scheme in double precision.  Polynomials made by the keyword constructor (and not changed
+ * since) are solved by reducing x to a small range and evaluating a short series there, which is
+ * accurate for any value of x.  See BasicPolynomial.h for float, long double and double-double
+ * polynomials.
  *
  * Parameters: The value for x used to solve the polynomial.  (Double)
- * Returns: The value of the polynomial.  (Long Double)
+ * Returns: The value of the polynomial.  (Double)
  */
-long double Polynomial::solve(double x) const {
-    long double result = 0;
-    for (int i = 0; i < coefficient_list.size(); i++) {
-        if (keyword == "ln" && x > 2) {
-            result -= (coefficient_list[i] * pow((1.0 / x) - a, i));
-        } else {
-            result += (coefficient_list[i] * pow(x - a, i));
-        }
+double Polynomial::solve(double x) const {
+    polynomialc_internal::ScopedTimer timer(PolynomialOperation::solve);
+
+    // Keyword polynomials are evaluated with a short range-reduced approximation of their function,
+    // which is faster and stays accurate far from the center of the series.
+    if (keyword != PolynomialKeyword::none) {
+        return polynomialc_internal::series_evaluate(keyword_table(keyword), x);
+    }
+
+    const double t = x - a;
+    double result = 0;
+    for (size_t i = coefficient_list.size(); i-- > 0;) {
+        result = result * t + coefficient_list[i];
     }
+    polynomialc_internal::count(PolynomialCounter::flops, 2 * coefficient_list.size());
     return result;
 }
 
 
+/* Evaluate
+ *
+ * The evaluate function solves the polynomial at many values of x at once.  It uses Horner's scheme
+ * and evaluates several points per instruction with AVX-512 or AVX2 when the CPU supports them,
+ * falling back to a scalar loop otherwise.  This is much faster than calling solve() in a loop.
+ *
+ * Accuracy: with n coefficients, every result (like solve()) differs from the exact value by at most
+ * (2n + 2) * 2^-53 * sum(|c_i| * |x - a|^i).  When all terms share a sign (for example x >= a with
+ * non-negative coefficients) that sum is |p(x)|, so the result is within 2n + 2 ulps of it.
+ *
+ * Parameters: The values of x to solve for (Span of doubles), where to write the results
+ * (Span of doubles, same size as the values of x).
+ * Returns: None.
+ */
+void Polynomial::evaluate(span<const double> xs, span<double> out) const {
+    polynomialc_internal::ScopedTimer timer(PolynomialOperation::evaluate);
+
+    if (xs.size() != out.size()) {
+        throw invalid_argument("Polynomial evaluate size mismatch.");
+    }
+
+    if (keyword != PolynomialKeyword::none) {
+        polynomialc_internal::SeriesTable table = keyword_table(keyword);
+        for (size_t k = 0; k < xs.size(); k++) {
+            out[k] = polynomialc_internal::series_evaluate(table, xs[k]);
+        }
+        return;
+    }
+
+    polynomialc_internal::horner_batch(coefficient_list.data(), coefficient_list.size(), a,
+                                       xs.data(), out.data(), xs.size());
+}
+
+
+/* Evaluate (Strided)
+ *
+ * Same as evaluate, but reads every x_stride-th value of xs and writes every out_stride-th value of
+ * out.  This lets the function work on interleaved data such as columns of a table.
+ *
+ * Parameters: The values of x (Span of doubles), the distance between two values of x (Size),
+ * where to write the results (Span of doubles), the distance between two results (Size).
+ * Returns: None.
+ */
+void Polynomial::evaluate(span<const double> xs, size_t x_stride, span<double> out,
+                          size_t out_stride) const {
+    polynomialc_internal::ScopedTimer timer(PolynomialOperation::evaluate);
+
+    if (x_stride == 0 || out_stride == 0) {
+        throw invalid_argument("Polynomial evaluate stride must be positive.");
+    }
+
+    size_t count = (xs.size() + x_stride - 1) / x_stride;
+    if (count != (out.size() + out_stride - 1) / out_stride) {
+        throw invalid_argument("Polynomial evaluate size mismatch.");
+    }
+
+    if (keyword != PolynomialKeyword::none) {
+        polynomialc_internal::SeriesTable table = keyword_table(keyword);
+        for (size_t k = 0; k < count; k++) {
+            out[k * out_stride] = polynomialc_internal::series_evaluate(table, xs[k * x_stride]);
+        }
+        return;
+    }
+
+    // The strided values are packed into small contiguous blocks so the SIMD kernel can be reused.
+    const size_t block_size = 256;
+    double x_block[block_size];
+    double out_block[block_size];
+    for (size_t start = 0; start < count; start += block_size) {
+        size_t length = min(block_size, count - start);
+        for (size_t k = 0; k < length; k++) {
+            x_block[k] = xs[(start + k) * x_stride];
+        }
+        polynomialc_internal::horner_batch(coefficient_list.data(), coefficient_list.size(), a,
+                                           x_block, out_block, length);
+        for (size_t k = 0; k < length; k++) {
+            out[(start + k) * out_stride] = out_block[k];
+        }
+    }
+}
+
+
+/* Evaluate Many
+ *
+ * Solves the polynomial at many values of x, like evaluate, with the values split over threads.  Every
+ * value comes from Horner's scheme, so the results match evaluate.  A remainder tree takes fewer steps
+ * for very long polynomials, but is only accurate for values of x - a close to 0; to use one, build a
+ * SubproductTree over the values and call the other overload.
+ *
+ * Parameters: The values of x to solve for (Span of doubles), the number of threads to use, where 0
+ * uses every hardware thread.  (Unsigned Integer)
+ * Returns: The value of the polynomial at every value of x, in the same order.  (Vector of doubles)
+ */
+vector<double> Polynomial::evaluate_many(span<const double> xs, unsigned int threads) const {
+    polynomialc_internal::ScopedTimer timer(PolynomialOperation::evaluate_many);
+
+    vector<double> values(xs.size());
+    const size_t n = coefficient_list.size();
+
+    // Horner's scheme, with the values split in blocks over the threads when there is enough work.
+    const unsigned int used = polynomialc_internal::resolve_threads(threads);
+    if (used > 1 && n * xs.size() >= (size_t(1) << 20)) {
+        polynomialc_internal::ThreadPool::global().parallel_for(xs.size(), used, [&](size_t begin, size_t end) {
+            evaluate(xs.subspan(begin, end - begin), span<double>(values).subspan(begin, end - begin));
+        });
+    } else {
+        evaluate(xs, values);
+    }
+    return values;
+}
+
+
+/* Evaluate Many (Tree)
+ *
+ * Solves the polynomial at every point of a subproduct tree with the remainder tree, in O(M(n) log n)
+ * steps instead of the O(n^2) of Horner's scheme, and one set of points can be reused for many
+ * polynomials.  A polynomial with a nonzero a is first rewritten around 0 (which loses accuracy for
+ * long polynomials; build the tree on the values of x - a instead), and keyword polynomials are solved
+ * point by point.  See SubproductTree::evaluate for the accuracy of the tree.
+ *
+ * Parameters: The tree over the values of x.  (SubproductTree)
+ * Returns: The value of the polynomial at every point of the tree, in the order of the points.
+ * (Vector of doubles)
+ */
+vector<double> Polynomial::evaluate_many(const SubproductTree& tree) const {
+    polynomialc_internal::ScopedTimer timer(PolynomialOperation::evaluate_many);
+
+    if (keyword != PolynomialKeyword::none) {
+        vector<double> values(tree.size());
+        evaluate(tree.points(), values);
+        return values;
+    }
+    if (a == 0) {
+        return tree.evaluate(coefficients());
+    }
+    vector<double> centered(coefficient_list.begin(), coefficient_list.end());
+    polynomialc_internal::taylor_shift(centered.data(), centered.size(), -a);
+    return tree.evaluate(span<const double>(centered));
+}
+
+
+/* Interpolate
+ *
+ * Creates the polynomial of degree below n that goes through n points (x_i, y_i), with a subproduct
+ * tree over the values of x (see SubproductTree::interpolate) in O(M(n) log n) steps.  To interpolate
+ * many sets of values of y at the same values of x, build a SubproductTree once instead.  In double
+ * precision the coefficients are only accurate for up to about 16 points.
+ *
+ * Parameters: The values of x, which must be distinct (Span of doubles), the values of y (Span of
+ * doubles, same size), the number of threads used for the tree, where 0 uses every hardware thread.
+ * (Unsigned Integer)
+ * Returns: The interpolating polynomial, with a = 0.  (Polynomial)
+ */
+Polynomial Polynomial::interpolate(span<const double> xs, span<const double> ys, unsigned int threads) {
+    polynomialc_internal::ScopedTimer timer(PolynomialOperation::interpolate);
+
+    if (xs.size() != ys.size()) {
+        throw invalid_argument("Polynomial interpolate size mismatch.");
+    }
+    return SubproductTree(xs, threads).interpolate(ys);
+}
+
+
+/* Evaluate Grid
+ *
+ * Solves the polynomial at the evenly spaced values x0, x0 + h, x0 + 2h, and so on, one per element of
+ * out.  Low-degree polynomials are stepped with forward differences, a few additions per value; see
+ * GridEvaluator.h, which also streams longer grids through a small buffer.
+ *
+ * Parameters: The first value of x (Double), the distance between two values of x (Double), where to
+ * write the results.  (Span of doubles)
+ * Returns: None.
+ */
+void Polynomial::evaluate_grid(double x0, double h, span<double> out) const {
+    polynomialc_internal::ScopedTimer timer(PolynomialOperation::evaluate_grid);
+
+    GridEvaluator(*this, x0, h).fill(out);
+}
+
+
 /* Differentiate
  *
  * The differentiate function creates a new polynomial that is a derivative of the current polynomial.
@@ -301,12 +774,15 @@ long double Polynomial::solve(double x) const {
  * Returns: The derivative of the current polynomial.  (Polynomial)
  */
 Polynomial Polynomial::differentiate() const {
-    vector<double> diff_coefficient_list;
-    for (int i = 1; i < coefficient_list.size(); i++) {
-        diff_coefficient_list.push_back(coefficient_list[i] * i);
+    polynomialc_internal::ScopedTimer timer(PolynomialOperation::differentiate);
+
+    // The derivative is built in place, and keeps the same value of a as the polynomial.
+    Polynomial derivative;
+    derivative.a = a;
+    derivative.coefficient_list.resize(coefficient_list.empty() ? 0 : coefficient_list.size() - 1);
+    for (size_t i = 1; i < coefficient_list.size(); i++) {
+        derivative.coefficient_list[i - 1] = coefficient_list[i] * (double) i;
     }
-
-    Polynomial derivative(diff_coefficient_list);
     return derivative;
 }
 
@@ -319,105 +795,572 @@ Polynomial Polynomial::differentiate() const {
  * Returns: The integral of the current polynomial.  (Polynomial)
  */
 Polynomial Polynomial::integrate(double c) {
-    vector<double> int_coefficient_list = {c};
-    for (int i = 0; i < coefficient_list.size(); i++) {
-        int_coefficient_list.push_back(coefficient_list[i] / (i + 1));
+    polynomialc_internal::ScopedTimer timer(PolynomialOperation::integrate);
+
+    // The integral is built in place, and keeps the same value of a as the polynomial.
+    Polynomial integral;
+    integral.a = a;
+    integral.coefficient_list.resize(coefficient_list.size() + 1);
+    integral.coefficient_list[0] = c;
+    for (size_t i = 0; i < coefficient_list.size(); i++) {
+        integral.coefficient_list[i + 1] = coefficient_list[i] / (double) (i + 1);
     }
 
-    remove_top_zero_terms(int_coefficient_list);
-
-    Polynomial integral(int_coefficient_list);
+    remove_top_zero_terms(integral.coefficient_list);
     return integral;
 }
 
 
 /* Power
  *
- * The power function raises the entire polynomial to a power.
+ * The power function raises the entire polynomial to a power.  It squares the polynomial repeatedly
+ * (binary exponentiation), so raising to the xth power takes about log2(x) products instead of x - 1.
  *
  * Parameters: The power to raise the polynomial.  (Unsigned Integer)
  * Returns: The raised polynomial.  (Polynomial)
  */
-Polynomial Polynomial::power(unsigned int x) {
-    if (x == 0) {
-        vector<double> null_coefficient = {1};
-        Polynomial null_polynomial(null_coefficient);
-        return null_polynomial;
-    }
+Polynomial Polynomial::power(unsigned int x) const {
+    polynomialc_internal::ScopedTimer timer(PolynomialOperation::power);
+
+    Polynomial raised;
+    raised.a = a;
+    raised.coefficient_list = raise_to_power(coefficient_list, x, SIZE_MAX);
+    return raised;
+}
+
+
+/* Truncated Power
+ *
+ * Raises the polynomial to a power, but drops every term above max_degree from each intermediate
+ * product.  This is much faster when only the first terms of a series are needed, because the
+ * products never grow past max_degree + 1 terms.
+ *
+ * Parameters: The power to raise the polynomial (Unsigned Integer), the highest power of x to keep.
+ * (Unsigned Integer)
+ * Returns: The raised polynomial up to and including the max_degree term.  (Polynomial)
+ */
+Polynomial Polynomial::power(unsigned int x, unsigned int max_degree) const {
+    polynomialc_internal::ScopedTimer timer(PolynomialOperation::power);
+
+    Polynomial raised;
+    raised.a = a;
+    raised.coefficient_list = raise_to_power(coefficient_list, x, size_t(max_degree) + 1);
+    return raised;
+}
+
+
+/* Recenter
+ *
+ * Creates the same polynomial written around another center: the coefficients of x - new_a instead of
+ * x - a, found with a Taylor shift.  Polynomials with 256 or more coefficients are shifted by
+ * splitting them in halves and recombining the halves with a fast product by a power of
+ * (x - new_a + (new_a - a)), in O(n log^2 n) steps; shorter ones use repeated synthetic division.
+ * Either way the error of every coefficient is within a small multiple of 2^-53 times the largest
+ * coefficient of the result.  Recentering far from the old center makes the coefficients grow
+ * quickly (by up to (1 + |new_a - a|)^n), and solving the result then cancels them.  Series from the
+ * keyword constructor only converge near their center, so their coefficients overflow when they are
+ * moved past it (ln, for one, cannot be rewritten around 0); they are still solved exactly.
+ *
+ * Parameters: The new value of a.  (Double)
+ * Returns: The same polynomial with a = new_a.  (Polynomial)
+ */
+Polynomial Polynomial::recenter(double new_a) const {
+    polynomialc_internal::ScopedTimer timer(PolynomialOperation::recenter);
+
+    Polynomial result(*this);
+    result.move_center(new_a);
+    return result;
+}
+
+
+/* Compose
+ *
+ * Substitutes another polynomial for x: p.compose(q) is p(q(x)), written around the inner polynomial's
+ * value of a.  The Brent-Kung scheme splits p into about sqrt(n) blocks of sqrt(n) terms, so the
+ * composition costs about 2 sqrt(n) fast products instead of the n products of substituting q into
+ * each term, and the blocks themselves are only sums of the powers of q.  Like the other uses of the
+ * fast products, the error of every coefficient is small relative to the size of the powers of q it
+ * is made of.  Keyword polynomials are composed through their series.
+ *
+ * Parameters: The polynomial to substitute for x.  (Polynomial)
+ * Returns: The composition p(q(x)).  (Polynomial)
+ */
+Polynomial Polynomial::compose(const Polynomial& inner) const {
+    polynomialc_internal::ScopedTimer timer(PolynomialOperation::compose);
+
+    Polynomial composed;
+    composed.a = inner.a;
+    composed.coefficient_list = compose_terms(coefficient_list, a, inner.coefficient_list, SIZE_MAX);
+    return composed;
+}
+
+
+/* Truncated Compose
+ *
+ * Composes two polynomials like compose, but drops every term above max_degree from each intermediate
+ * product.  This is much faster when only the first terms of p(q(x)) around the inner polynomial's a
+ * are needed, because the products never grow past max_degree + 1 terms.
+ *
+ * Parameters: The polynomial to substitute for x (Polynomial), the highest power of x to keep.
+ * (Unsigned Integer)
+ * Returns: The composition p(q(x)) up to and including the max_degree term.  (Polynomial)
+ */
+Polynomial Polynomial::compose(const Polynomial& inner, unsigned int max_degree) const {
+    polynomialc_internal::ScopedTimer timer(PolynomialOperation::compose);
+
+    Polynomial composed;
+    composed.a = inner.a;
+    composed.coefficient_list = compose_terms(coefficient_list, a, inner.coefficient_list,
+                                              size_t(max_degree) + 1);
+    return composed;
+}
+
 
-    Polynomial self(coefficient_list);
-    auto duplicate = self;
+/* Compositional Inverse
+ *
+ * Reverts the polynomial as a power series: for q(x) = b0 + b1 (x - a) + ... with b1 not 0, finds the
+ * series r around b0 with q(r(y)) = y up to the max_degree term (so r(b0) = a).  The series is found
+ * with Newton's iteration, which doubles the number of correct terms with each composition.  It only
+ * converges near b0, so r is only an accurate inverse of q close to b0.
+ *
+ * Parameters: The highest power of (y - b0) to keep.  (Unsigned Integer)
+ * Returns: The inverse series, with a = b0.  (Polynomial)
+ */
+Polynomial Polynomial::compositional_inverse(unsigned int max_degree) const {
+    polynomialc_internal::ScopedTimer timer(PolynomialOperation::compositional_inverse);
 
-    for (int i = 0; i < (x - 1); i++) {
-        self *= duplicate;
+    if (coefficient_list.size() < 2 || coefficient_list[1] == 0) {
+        throw invalid_argument("Only a polynomial with a nonzero linear term can be inverted.");
     }
 
-    return self;
+    // With f(t) = b1 t + b2 t^2 + ..., q(a + t) = b0 + f(t), so r(y) = a + g(y - b0) where f(g(s)) = s.
+    vector<double> f = coefficient_list.to_vector();
+    f[0] = 0;
+    Polynomial inverse;
+    inverse.a = coefficient_list[0];
+    inverse.coefficient_list.resize(size_t(max_degree) + 1, 0.0);
+    polynomialc_internal::revert_series(f.data(), f.size(), inverse.coefficient_list.data(),
+                                        inverse.coefficient_list.size());
+    inverse.coefficient_list[0] = a;
+    remove_top_zero_terms(inverse.coefficient_list);
+    return inverse;
 }
 
 
 /* Zero
  *
  * The zero function finds a value of x that will result in the polynomial returning 0 if such an
- * x exists.
+ * x exists.  See find_zero for how the zero is found.
  *
  * Parameters: An initial guess for where the zero is (Double), a tolerance value determining how
  * close can the result be before a zero is declared to be found.  (Double)
  * Returns: The value of x that will result in the polynomial returning 0.  (Double)
  */
 double Polynomial::zero(double guess, double tolerance) const {
-    double increment = 1.0;
-    Polynomial derivative = differentiate();
-    long double result = solve(guess);
-    long double derivative_result = derivative.solve(guess);
-    bool converging = false;
-    bool diverging = false;
-
-    while (result >= tolerance || result <= -tolerance) {
-        // If the polynomial only consists of a constant term, then the loop will terminate early
-        // in order to prevent an infinite loop where the function fails to converge.
-        if (coefficient_list.size() <= 1) {
+    return find_zero(guess, tolerance).root;
+}
+
+
+/* Find Zero
+ *
+ * Finds a zero of the polynomial near a guess with a safeguarded Halley/Newton iteration.  The
+ * polynomial and its first two derivatives come from one Horner pass per step.  Once the iteration
+ * has seen the polynomial on both sides of 0, the zero is bracketed and any step that leaves the
+ * bracket is replaced by bisection, so the search cannot run away.  A step that does not shrink
+ * |p(x)| before a bracket is found (Newton's method can cycle, as on x^3 - 2x + 2 from 0) makes the
+ * search look for one at the ends of the range that holds every real zero, a + -(1 + max|c_i / c_n|);
+ * polynomials of odd degree always change sign there.  Simple zeros usually take fewer than 10 steps.
+ * The search stops after max_iterations steps even if no zero was found (for example when the
+ * polynomial has no real zeros), and reports the best value of x it saw.
+ *
+ * Parameters: An initial guess for where the zero is (Double), the largest |p(x)| accepted as a zero
+ * (Double), the maximum number of steps.  (Unsigned Integer)
+ * Returns: The zero and how the search went.  (ZeroResult)
+ * - root: The value of x found.
+ * - residual: The value of the polynomial at root.
+ * - iterations: How many steps were taken.
+ * - converged: Whether root is a zero (|p(root)| <= tolerance, or root could not be improved further).
+ * - bracketed: Whether the search found values of x on both sides of the zero.
+ */
+ZeroResult Polynomial::find_zero(double guess, double tolerance, unsigned int max_iterations) const {
+    polynomialc_internal::ScopedTimer timer(PolynomialOperation::find_zero);
+
+    const double epsilon = numeric_limits<double>::epsilon();
+    const double not_seen = numeric_limits<double>::quiet_NaN();
+    ZeroResult result = {guess, 0, 0, false, false};
+
+    // A constant polynomial is either 0 everywhere or nowhere, so there is nothing to search for.
+    if (coefficient_list.size() <= 1) {
+        result.residual = coefficient_list.empty() ? 0 : coefficient_list[0];
+        result.converged = fabs(result.residual) <= tolerance;
+        return result;
+    }
+
+    double x = guess;
+    double best = guess;
+    double best_residual = numeric_limits<double>::infinity();
+    double positive_side = not_seen;
+    double negative_side = not_seen;
+    double previous_residual = numeric_limits<double>::infinity();
+    bool bound_tried = false;
+
+    for (unsigned int iteration = 1; iteration <= max_iterations; iteration++) {
+        result.iterations = iteration;
+        polynomialc_internal::count(PolynomialCounter::zero_iterations, 1);
+
+        double value, first, second;
+        polynomialc_internal::horner_derivatives(coefficient_list.data(), coefficient_list.size(),
+                                                 x - a, value, first, second);
+        if (fabs(value) < fabs(best_residual)) {
+            best = x;
+            best_residual = value;
+        }
+        if (fabs(value) <= tolerance) {
+            result.converged = true;
             break;
         }
-        
-        if ((result * derivative_result) > 0) {
-            // If the result and the derivative have the same sign, then the guess is going towards 0.
-            guess -= increment;
-            diverging = true;
+
+        // The latest values of x with a positive and a negative result bracket a zero.
+        if (value > 0) {
+            positive_side = x;
         } else {
-            // If the result and the derivative are different signs, then the guess is going away from 0.
-            guess += increment;
-            converging = true;
+            negative_side = x;
         }
 
-        // If the guess changed directions on its path to 0, then the guess is close to 0 but not close
-        // enough.  Therefore, the guess must increase its precision to find the zero.
-        if (converging && diverging) {
-            converging = false;
-            diverging = false;
-            increment /= 2;
+        // Without progress or a bracket, the ends of the range of the real zeros may give one.
+        if (!bound_tried && fabs(value) >= fabs(previous_residual)
+            && (isnan(positive_side) || isnan(negative_side))) {
+            bound_tried = true;
+            const size_t n = coefficient_list.size();
+            double bound = 0;
+            for (size_t i = 0; i + 1 < n; i++) {
+                bound = max(bound, fabs(coefficient_list[i] / coefficient_list[n - 1]));
+            }
+            for (double end : {a - (1 + bound), a + (1 + bound)}) {
+                const double end_value = solve(end);
+                if (end_value > 0 && isnan(positive_side)) {
+                    positive_side = end;
+                } else if (end_value < 0 && isnan(negative_side)) {
+                    negative_side = end;
+                }
+            }
+        }
+        previous_residual = value;
+        result.bracketed = !isnan(positive_side) && !isnan(negative_side);
+        double low = min(positive_side, negative_side);
+        double high = max(positive_side, negative_side);
+        if (result.bracketed && high - low <= 2 * epsilon * max(fabs(low), fabs(high))) {
+            result.converged = true;
+            break;
+        }
+
+        // Halley's step converges cubically, but is only trusted while it stays close to Newton's.
+        double next = x;
+        if (first != 0 && isfinite(first)) {
+            double newton = value / first;
+            double correction = 1 - newton * second / (2 * first);
+            next = x - (correction >= 0.5 && correction <= 2 ? newton / correction : newton);
+        }
+
+        if (result.bracketed) {
+            if (!(next > low && next < high)) {
+                next = low + (high - low) / 2;
+            }
+        } else if (next == x || !isfinite(next)) {
+            // A flat spot with no bracket yet: step away from it.
+            next = x + max(1.0, fabs(x)) / 2;
+        }
+
+        // A step below the rounding error of x cannot improve the zero any further.
+        if (fabs(next - x) <= 2 * epsilon * fabs(x) || next == x) {
+            x = next;
+            result.converged = true;
+            break;
+        }
+        x = next;
+    }
+
+    result.root = result.converged ? x : best;
+    double first, second;
+    polynomialc_internal::horner_derivatives(coefficient_list.data(), coefficient_list.size(),
+                                             result.root - a, result.residual, first, second);
+    return result;
+}
+
+
+/* Roots
+ *
+ * Finds every root of the polynomial, including complex ones, with the Aberth-Ehrlich method: all
+ * roots are refined at the same time, each one pushed away from the others so they cannot converge
+ * to the same root.  For polynomials of degree 64 or more the work of each step is split across
+ * threads.  A root with multiplicity k is listed k times.  The complex roots come in exact conjugate
+ * pairs, and a root whose imaginary part is within the error that rounding leaves in it is put on the
+ * real axis.  That error is eps * sum(|c_i| |z|^i) / |p'(z)| times the degree, so the roots of an
+ * ill-conditioned polynomial (like (x - 1)(x - 2)...(x - 20)) are real but only accurate to it.
+ *
+ * Parameters: The number of threads to use, where 0 uses every hardware thread.  (Unsigned Integer)
+ * Returns: The roots sorted by real part, then imaginary part.  (Vector of complex doubles)
+ */
+vector<complex<double>> Polynomial::roots(unsigned int threads) const {
+    polynomialc_internal::ScopedTimer timer(PolynomialOperation::roots);
+
+    vector<complex<double>> found = polynomialc_internal::aberth_roots(coefficient_list.data(),
+                                                                      coefficient_list.size(), threads);
+    for (auto& root : found) {
+        root += a;
+    }
+    sort(found.begin(), found.end(), [](const complex<double>& first, const complex<double>& second) {
+        return first.real() != second.real() ? first.real() < second.real() : first.imag() < second.imag();
+    });
+    return found;
+}
+
+
+/* Real Roots
+ *
+ * Finds every real root of the polynomial.  This runs roots() and keeps the roots whose imaginary
+ * part is negligible, dropping that imaginary part.  roots() already puts every root that rounding
+ * cannot tell from a real one on the real axis, so the tolerance only matters for roots known to
+ * better accuracy than that.
+ *
+ * Parameters: The largest imaginary part (relative to the size of the root, for roots bigger than 1)
+ * treated as 0 (Double), the number of threads to use, where 0 uses every hardware thread.
+ * (Unsigned Integer)
+ * Returns: The real roots in ascending order.  (Vector of doubles)
+ */
+vector<double> Polynomial::real_roots(double imaginary_tolerance, unsigned int threads) const {
+    polynomialc_internal::ScopedTimer timer(PolynomialOperation::real_roots);
+
+    vector<double> found;
+    for (const auto& root : roots(threads)) {
+        if (fabs(root.imag()) <= imaginary_tolerance * max(1.0, abs(root))) {
+            found.push_back(root.real());
+        }
+    }
+    sort(found.begin(), found.end());
+    return found;
+}
+
+
+/* Isolate Real Roots
+ *
+ * Finds every real root of the polynomial between low and high, each in its own interval.  The range
+ * is bisected, and Descartes' rule of signs tells for each piece whether it holds no root, exactly
+ * one, or possibly more (in which case it is bisected again).  Each interval with one root is then
+ * shrunk to at most tolerance wide.  Unlike real_roots(), no root can be missed or found twice, up
+ * to the rounding of the sign tests in double precision.  For polynomials of degree above 32 the
+ * pieces are spread over threads.
+ *
+ * Parameters: The ends of the range to search, which may be infinite (Doubles), the widest interval
+ * accepted (Double), the number of threads to use, where 0 uses every hardware thread and 1 keeps all
+ * the work on the calling thread.  (Unsigned Integer)
+ * Returns: The intervals in ascending order.  (Vector of RootIntervals)
+ * - low, high: The ends of the interval.  They are equal when the root was hit exactly.
+ * - isolated: Whether the interval holds exactly one root.  An interval that could not be split
+ *   further within double precision (a multiple root or a tight cluster of roots) is reported with
+ *   isolated set to false.
+ */
+vector<RootInterval> Polynomial::isolate_real_roots(double low, double high, double tolerance,
+                                                    unsigned int threads) const {
+    polynomialc_internal::ScopedTimer timer(PolynomialOperation::isolate_real_roots);
+
+    if (!(low <= high)) {
+        throw invalid_argument("The low end of the range must not be above the high end.");
+    }
+    if (!(tolerance >= 0)) {
+        throw invalid_argument("The tolerance must not be negative.");
+    }
+
+    vector<RootInterval> found;
+    for (const auto& interval : polynomialc_internal::isolate_real_roots(coefficient_list.data(),
+                                                                         coefficient_list.size(), low - a,
+                                                                         high - a, tolerance, threads)) {
+        found.push_back({interval.low + a, interval.high + a, interval.isolated});
+    }
+    return found;
+}
+
+
+/* Divmod
+ *
+ * Divides the polynomial by another one, giving the quotient and the remainder (of lower degree than
+ * the divisor).  Long quotients by long divisors (1024 or more terms each) are computed with the
+ * reciprocal of the reversed divisor, found by Newton's iteration on top of fast multiplication, so
+ * the division costs a few products instead of the O(n^2) steps of long division; the error of that
+ * path is small relative to the size of the coefficients, like a Karatsuba or FFT product.  Shorter
+ * divisions use long division.
+ *
+ * Parameters: The divisor.  With another value of a, the shorter of the two polynomials is first
+ * rewritten around the other one's a (see the Polynomial + Polynomial operator).  (Polynomial)
+ * Returns: The quotient and the remainder.  (DivisionResult)
+ */
+DivisionResult Polynomial::divmod(const Polynomial& divisor) const {
+    if (a != divisor.a) {
+        const double center = common_center(*this, divisor);
+        return center == a ? divmod(divisor.recenter(center)) : recenter(center).divmod(divisor);
+    }
+
+    polynomialc_internal::ScopedTimer timer(PolynomialOperation::divide);
+
+    // Top zero terms are ignored, so a divisor of 0 is an empty list.
+    size_t n = coefficient_list.size();
+    size_t m = divisor.coefficient_list.size();
+    while (n > 0 && coefficient_list[n - 1] == 0) {
+        n--;
+    }
+    while (m > 0 && divisor.coefficient_list[m - 1] == 0) {
+        m--;
+    }
+    if (m == 0) {
+        throw invalid_argument("Polynomial division by zero.");
+    }
+
+    DivisionResult result;
+    result.quotient.a = a;
+    result.remainder.a = a;
+    result.quotient.coefficient_list.resize(n >= m ? n - m + 1 : 0);
+    result.remainder.coefficient_list.resize(m - 1);
+    polynomialc_internal::divide(coefficient_list.data(), n, divisor.coefficient_list.data(), m,
+                                 result.quotient.coefficient_list.data(),
+                                 result.remainder.coefficient_list.data());
+    remove_top_zero_terms(result.quotient.coefficient_list);
+    remove_top_zero_terms(result.remainder.coefficient_list);
+    return result;
+}
+
+
+/* GCD
+ *
+ * Finds the greatest common divisor of two polynomials with Euclid's algorithm.  In floating point a
+ * remainder is rarely exactly 0, so the polynomials are kept scaled to a largest coefficient of 1, and
+ * the top terms of every remainder that are below the tolerance (relative to that scale) are dropped;
+ * a remainder with nothing left ends the algorithm.  The result is monic (its highest coefficient is
+ * 1), and is 1 when the polynomials share no factor.
+ *
+ * Parameters: The other polynomial, the shorter of the two rewritten around the other one's a first
+ * if they differ (Polynomial), the size below which a coefficient counts as 0, relative to the
+ * largest coefficient of the dividend.  (Double)
+ * Returns: The greatest common divisor.  (Polynomial)
+ */
+Polynomial Polynomial::gcd(const Polynomial& other, double tolerance) const {
+    if (a != other.a) {
+        const double center = common_center(*this, other);
+        return center == a ? gcd(other.recenter(center), tolerance) : recenter(center).gcd(other, tolerance);
+    }
+
+    polynomialc_internal::ScopedTimer timer(PolynomialOperation::gcd);
+
+    // Drops the top terms at or below limit, then scales what is left to a largest coefficient of 1.
+    auto normalize = [](Polynomial& polynomial, double limit) {
+        CoefficientList& list = polynomial.coefficient_list;
+        while (!list.empty() && fabs(list.back()) <= limit) {
+            list.pop_back();
+        }
+        double largest = 0;
+        for (double coefficient : list) {
+            largest = max(largest, fabs(coefficient));
+        }
+        for (double& coefficient : list) {
+            coefficient /= largest;
         }
+    };
+    auto largest_of = [](const Polynomial& polynomial) {
+        double largest = 0;
+        for (double coefficient : polynomial.coefficient_list) {
+            largest = max(largest, fabs(coefficient));
+        }
+        return largest;
+    };
+
+    Polynomial first = *this;
+    Polynomial second = other;
+    first.keyword = PolynomialKeyword::none;
+    second.keyword = PolynomialKeyword::none;
+    normalize(first, tolerance * largest_of(first));
+    normalize(second, tolerance * largest_of(second));
+    while (!second.coefficient_list.empty()) {
+        // first is scaled to a largest coefficient of 1, so the tolerance applies as it is.
+        Polynomial remainder = first.divmod(second).remainder;
+        normalize(remainder, tolerance);
+        first = std::move(second);
+        second = std::move(remainder);
+    }
 
-        result = solve(guess);
-        derivative_result = derivative.solve(guess);
+    if (first.coefficient_list.empty()) {
+        return Polynomial({0}, a);
     }
-    return guess;
+    first /= first.coefficient_list.back();
+    return first;
 }
 
 
 /* Display
  *
- * The display function displays the polynomial in a more human-friendly format.
+ * The display function displays the polynomial in a more human-friendly format, followed by a new
+ * line, on the standard output or on another stream.  The text is built in one pass over the terms
+ * and written to the stream in large blocks, and the stream is not flushed.
  *
  * Parameters: A keyword for how the terms should be displayed.  (String)
  * - all: Display all terms from ascending order, even those with 0 as their coefficient.
  * - reduced: Display all terms from ascending order excluding those with 0 as their coefficient.
  * - simple: Display all terms from descending order as orderly as possible.
+ * Or: The stream to write to (Output Stream), how the terms should be displayed (DisplayMode),
+ * whether to write every coefficient with as many digits as it takes to read it back exactly instead
+ * of the stream's precision.  (Boolean)
  * Returns: None.
  */
 void Polynomial::display(const string& set_keyword) const {
-    hidden_display(set_keyword);
-    cout << endl;
+    display(cout, display_mode(set_keyword));
+}
+
+void Polynomial::display(ostream& out, DisplayMode mode, bool round_trip) const {
+    polynomialc_internal::ScopedTimer timer(PolynomialOperation::display);
+
+    StreamSink sink(out, round_trip);
+    write_terms(sink, coefficient_list, a, mode);
+    sink.append("\n", 1);
+}
+
+
+/* Format
+ *
+ * Writes the polynomial as text (see display) into a new string, at the end of an existing string,
+ * or into a character buffer, with std::to_chars.  Coefficients are written like the default
+ * operator<< on a double (6 significant digits), or with the fewest digits that read back to exactly
+ * the same double when round_trip is set.
+ *
+ * Parameters: How the terms should be displayed (DisplayMode), whether the coefficients are written
+ * to read back exactly.  (Boolean)
+ * Returns: The text.  (String)
+ * Or: The string to append to (String), then the same parameters.
+ * Returns: None.
+ * Or: The first and one past the last character of the buffer (Character pointers), then the same
+ * parameters.
+ * Returns: One past the last character written, and errc() or errc::value_too_large when the buffer
+ * was too small (then the contents of the buffer are unspecified).  (std::to_chars_result)
+ */
+string Polynomial::format(DisplayMode mode, bool round_trip) const {
+    string text;
+    format(text, mode, round_trip);
+    return text;
+}
+
+void Polynomial::format(string& text, DisplayMode mode, bool round_trip) const {
+    polynomialc_internal::ScopedTimer timer(PolynomialOperation::display);
+
+    StringSink sink(text, round_trip);
+    write_terms(sink, coefficient_list, a, mode);
+}
+
+to_chars_result Polynomial::format(char* first, char* last, DisplayMode mode, bool round_trip) const {
+    polynomialc_internal::ScopedTimer timer(PolynomialOperation::display);
+
+    BufferSink sink(first, last, round_trip);
+    write_terms(sink, coefficient_list, a, mode);
+    if (sink.overflow) {
+        return {last, errc::value_too_large};
+    }
+    return {sink.end(), errc()};
 }
 
 
@@ -427,157 +1370,199 @@ void Polynomial::display(const string& set_keyword) const {
 // ===== CLASS INTERACTIONS WITH OTHER POLYNOMIALS =====
 
 
-/* Polynomial + Polynomial operator
+/* Polynomial += Polynomial operator
  *
- * The sum of two polynomials will result in a polynomial with the sum of the constants in both
- * polynomials.
+ * Adds the constants of another polynomial to this polynomial's constants, in place.  The coefficient
+ * list only grows (once) when the other polynomial has more terms.  With different values of a, the
+ * shorter polynomial is first rewritten around the longer one's (see the Polynomial + Polynomial
+ * operator).
  *
  * Parameters: Another polynomial.  (Polynomial)
- * Returns: The summed-up polynomial.  (Polynomial)
+ * Returns: This polynomial.  (Polynomial)
  */
-Polynomial Polynomial::operator+(const Polynomial &other) {
-    // The function checks if the two polynomials could be added together.  If not, an error is raised.
+Polynomial& Polynomial::operator+=(const Polynomial &other) {
+    polynomialc_internal::ScopedTimer timer(PolynomialOperation::add);
+
+    // Polynomials with different centers meet at the longer one's.
     if (a != other.a) {
-        cerr << "[PolynomialC/ERROR]" << endl <<
-                "These two polynomials have different values of 'a'." << endl <<
-                "Current polynomial value of a: " << a << endl <<
-                "Other polynomial value of a: " << other.a << endl <<
-                "Adding these two polynomials together would result in a mathematically" << endl <<
-                "incorrect polynomial." << endl;
-        throw invalid_argument("Polynomial a mismatch.");
-    }
-
-    auto new_coefficient_list = coefficient_list;
-    int constant_count = new_coefficient_list.size();
-    int other_constant_count = other.coefficient_list.size();
-
-    // If the other polynomial has more terms than the current polynomial, empty terms are added to
-    // the polynomial.
-    if (constant_count < other_constant_count) {
-        for (int i = other_constant_count - constant_count + 1; i < other_constant_count; i++) {
-            new_coefficient_list.push_back(0);
-        }
+        move_center(common_center(*this, other));
     }
-
-    // The constants from the other polynomial is added to the current polynomial.
-    for (int i = 0; i < new_coefficient_list.size(); i++) {
-        new_coefficient_list[i] += other.coefficient_list[i];
+    if (a != other.a) {
+        add_terms(coefficient_list, other.recenter(a).coefficient_list, 1);
+    } else {
+        add_terms(coefficient_list, other.coefficient_list, 1);
     }
+    keyword = PolynomialKeyword::none;
+    return *this;
+}
 
-    // If the constants for the upper terms are 0, they are dropped from the constant list.
-    remove_top_zero_terms(new_coefficient_list);
 
-    Polynomial new_polynomial(new_coefficient_list);
-    return new_polynomial;
-}
+/* Polynomial -= Polynomial operator
+ *
+ * Subtracts the constants of another polynomial from this polynomial's constants, in place.  With
+ * different values of a, the shorter polynomial is first rewritten around the longer one's (see the
+ * Polynomial + Polynomial operator).
+ *
+ * Parameters: Another polynomial.  (Polynomial)
+ * Returns: This polynomial.  (Polynomial)
+ */
+Polynomial& Polynomial::operator-=(const Polynomial &other) {
+    polynomialc_internal::ScopedTimer timer(PolynomialOperation::subtract);
 
-void Polynomial::operator+=(const Polynomial &other) {
-    // The function checks if the two polynomials could be added together.  If not, an error is raised.
+    // Polynomials with different centers meet at the longer one's.
     if (a != other.a) {
-        cerr << "[PolynomialC/ERROR]" << endl <<
-             "These two polynomials have different values of 'a'." << endl <<
-             "Current polynomial value of a: " << a << endl <<
-             "Other polynomial value of a: " << other.a << endl <<
-             "Adding these two polynomials together would result in a mathematically" << endl <<
-             "incorrect polynomial." << endl;
-        throw invalid_argument("Polynomial a mismatch.");
-    }
-
-    int constant_count = coefficient_list.size();
-    int other_constant_count = other.coefficient_list.size();
-
-    // If the other polynomial has more terms than the current polynomial, empty terms are added to
-    // the polynomial.
-    if (constant_count < other_constant_count) {
-        for (int i = other_constant_count - constant_count + 1; i < other_constant_count; i++) {
-            coefficient_list.push_back(0);
-        }
+        move_center(common_center(*this, other));
     }
-
-    // The constants from the other polynomial is added to the current polynomial.
-    for (int i = 0; i < coefficient_list.size(); i++) {
-        coefficient_list[i] += other.coefficient_list[i];
+    if (a != other.a) {
+        add_terms(coefficient_list, other.recenter(a).coefficient_list, -1);
+    } else {
+        add_terms(coefficient_list, other.coefficient_list, -1);
     }
-
-    // If the constants for the upper terms are 0, they are dropped from the constant list.
-    remove_top_zero_terms(coefficient_list);
+    keyword = PolynomialKeyword::none;
+    return *this;
 }
 
 
-/* Polynomial - Polynomial operator
+/* Polynomial *= Polynomial operator
  *
- * The difference of two polynomials will result in a polynomial with the difference of the constants
- * in both polynomials.
+ * Multiplies this polynomial by another polynomial (see the Polynomial * Polynomial operator), with
+ * the shorter one first rewritten around the longer one's a when they differ.
  *
  * Parameters: Another polynomial.  (Polynomial)
- * Returns: The subtracted polynomial.  (Polynomial)
+ * Returns: This polynomial.  (Polynomial)
  */
-Polynomial Polynomial::operator-(const Polynomial &other) {
-    // The function checks if the two polynomials could be subtracted.  If not, an error is raised.
+Polynomial& Polynomial::operator*=(const Polynomial& other) {
+    // Polynomials with different centers meet at the longer one's.
     if (a != other.a) {
-        cerr << "[PolynomialC/ERROR]" << endl <<
-             "These two polynomials have different values of 'a'." << endl <<
-             "Current polynomial value of a: " << a << endl <<
-             "Other polynomial value of a: " << other.a << endl <<
-             "Adding these two polynomials together would result in a mathematically" << endl <<
-             "incorrect polynomial." << endl;
-        throw invalid_argument("Polynomial a mismatch.");
-    }
-
-    auto new_coefficient_list = coefficient_list;
-    int constant_count = new_coefficient_list.size();
-    int other_constant_count = other.coefficient_list.size();
-
-    // If the other polynomial has more terms than the current polynomial, empty terms are added to
-    // the polynomial.
-    if (constant_count < other_constant_count) {
-        for (int i = other_constant_count - constant_count + 1; i < other_constant_count; i++) {
-            new_coefficient_list.push_back(0);
+        move_center(common_center(*this, other));
+        if (a != other.a) {
+            return *this *= other.recenter(a);
         }
     }
 
-    // The constants from the other polynomial is added to the current polynomial.
-    for (int i = 0; i < new_coefficient_list.size(); i++) {
-        new_coefficient_list[i] -= other.coefficient_list[i];
+    polynomialc_internal::ScopedTimer timer(PolynomialOperation::multiply);
+
+    // The product is written to a new buffer which then replaces the old coefficient list.  Products
+    // of low-degree polynomials fit in the inline storage and do not allocate.
+    CoefficientList product(product_size(coefficient_list, other.coefficient_list), 0);
+    polynomialc_internal::multiply(coefficient_list.data(), coefficient_list.size(),
+                                   other.coefficient_list.data(), other.coefficient_list.size(),
+                                   product.data());
+    remove_top_zero_terms(product);
+    coefficient_list = std::move(product);
+    keyword = PolynomialKeyword::none;
+    return *this;
+}
+
+
+/* Polynomial Copy and Move Operations
+ *
+ * A copied polynomial gets its own coefficient list, from the thread's current memory resource.  A
+ * moved polynomial hands its coefficient list (and its resource) over without copying it, and is left
+ * as an empty (zero) polynomial.  Assignment keeps the resource of the assigned polynomial, so the
+ * coefficients are copied when the two polynomials use different resources.
+ *
+ * Parameters: Another polynomial.  (Polynomial)
+ * Returns: This polynomial (assignment only).  (Polynomial)
+ */
+Polynomial::Polynomial(const Polynomial& other) = default;
+Polynomial::Polynomial(Polynomial&& other) noexcept
+    : coefficient_list(std::move(other.coefficient_list)), a(other.a),
+      keyword(exchange(other.keyword, PolynomialKeyword::none)) {}
+Polynomial& Polynomial::operator=(const Polynomial& other) = default;
+
+Polynomial& Polynomial::operator=(Polynomial&& other) {
+    // The keyword goes with the coefficients, or a moved-from sine would still evaluate as sin(x).
+    if (this == &other) {
+        return *this;
     }
+    coefficient_list = std::move(other.coefficient_list);
+    a = other.a;
+    keyword = exchange(other.keyword, PolynomialKeyword::none);
+    return *this;
+}
 
-    // If the constants for the upper terms are 0, they are dropped from the constant list.
-    remove_top_zero_terms(new_coefficient_list);
 
-    Polynomial new_polynomial(new_coefficient_list);
-    return new_polynomial;
+/* Polynomial + Polynomial operator
+ *
+ * The sum of two polynomials will result in a polynomial with the sum of the constants in both
+ * polynomials.  When either polynomial is a temporary (such as the result of another operator), its
+ * coefficient list is reused for the sum instead of allocating a new one, so a chain like
+ * a + b * c - d only allocates once, for the product.  Polynomials with different values of a can be
+ * added: the sum is written around the a of the polynomial with more terms (the left one if they are
+ * as long), and only the other one is rewritten (see recenter).  Moving a short polynomial is exact up
+ * to rounding, while a long series, like ln around 1, would diverge if it were moved.
+ *
+ * Parameters: Two polynomials.  (Polynomial)
+ * Returns: The summed-up polynomial.  (Polynomial)
+ */
+Polynomial operator+(const Polynomial& left, const Polynomial& right) {
+    // The longer polynomial is copied so the sum fits without growing, and keeps its center.
+    if (left.coefficients().size() >= right.coefficients().size()) {
+        Polynomial sum(left);
+        sum += right;
+        return sum;
+    }
+    Polynomial sum(right);
+    sum += left;
+    return sum;
 }
 
-void Polynomial::operator-=(const Polynomial &other) {
-    // The function checks if the two polynomials could be subtracted.  If not, an error is raised.
-    if (a != other.a) {
-        cerr << "[PolynomialC/ERROR]" << endl <<
-             "These two polynomials have different values of 'a'." << endl <<
-             "Current polynomial value of a: " << a << endl <<
-             "Other polynomial value of a: " << other.a << endl <<
-             "Adding these two polynomials together would result in a mathematically" << endl <<
-             "incorrect polynomial." << endl;
-        throw invalid_argument("Polynomial a mismatch.");
-    }
-
-    int constant_count = coefficient_list.size();
-    int other_constant_count = other.coefficient_list.size();
-
-    // If the other polynomial has more terms than the current polynomial, empty terms are added to
-    // the polynomial.
-    if (constant_count < other_constant_count) {
-        for (int i = other_constant_count - constant_count + 1; i < other_constant_count; i++) {
-            coefficient_list.push_back(0);
-        }
+Polynomial operator+(Polynomial&& left, const Polynomial& right) {
+    left += right;
+    return std::move(left);
+}
+
+Polynomial operator+(const Polynomial& left, Polynomial&& right) {
+    // Only the tie between centers needs the order of the operands.
+    if (left.get_a() != right.get_a()) {
+        return left + static_cast<const Polynomial&>(right);
+    }
+    right += left;
+    return std::move(right);
+}
+
+Polynomial operator+(Polynomial&& left, Polynomial&& right) {
+    left += right;
+    return std::move(left);
+}
+
+
+/* Polynomial - Polynomial operator
+ *
+ * The difference of two polynomials will result in a polynomial with the difference of the constants
+ * in both polynomials.  Temporaries are reused, and the difference is centered, like in the
+ * Polynomial + Polynomial operator.
+ *
+ * Parameters: Two polynomials.  (Polynomial)
+ * Returns: The subtracted polynomial.  (Polynomial)
+ */
+Polynomial operator-(const Polynomial& left, const Polynomial& right) {
+    // The longer polynomial is copied so the difference fits without growing, and keeps its center.
+    if (left.coefficients().size() >= right.coefficients().size()) {
+        Polynomial difference(left);
+        difference -= right;
+        return difference;
     }
+    return -right + left;
+}
+
+Polynomial operator-(Polynomial&& left, const Polynomial& right) {
+    left -= right;
+    return std::move(left);
+}
 
-    // The constants from the other polynomial is added to the current polynomial.
-    for (int i = 0; i < coefficient_list.size(); i++) {
-        coefficient_list[i] -= other.coefficient_list[i];
+Polynomial operator-(const Polynomial& left, Polynomial&& right) {
+    // Only the tie between centers needs the order of the operands.
+    if (left.get_a() != right.get_a()) {
+        return left - static_cast<const Polynomial&>(right);
     }
+    return -std::move(right) + left;
+}
 
-    // If the constants for the upper terms are 0, they are dropped from the constant list.
-    remove_top_zero_terms(coefficient_list);
+Polynomial operator-(Polynomial&& left, Polynomial&& right) {
+    left -= right;
+    return std::move(left);
 }
 
 
@@ -586,187 +1571,218 @@ void Polynomial::operator-=(const Polynomial &other) {
  * The product of two polynomials will result in a polynomial with more powers of x than the individual
  * two polynomials.
  *
- * Parameters: Another polynomial.  (Polynomial)
+ * Small polynomials are multiplied term by term.  Medium ones use Karatsuba multiplication and large
+ * ones (512 or more terms in the product) use FFT convolution.  Compared to the exact term by term
+ * product, every coefficient of a Karatsuba or FFT product is off by at most
+ * 4 * log2(n + m) * 2^-53 * |p|* |q| (|p| being the square root of the sum of squared coefficients).
+ * Polynomials whose coefficients decay faster than any rescaling of x can even out, like the sine,
+ * cosine and e^x series, are always multiplied term by term because that bound would swamp their
+ * small high-order terms; a few small coefficients among ordinary ones do not count.  The product
+ * is centered like a sum (see the Polynomial + Polynomial operator).
+ *
+ * Parameters: Two polynomials.  (Polynomial)
  * Returns: The product of the two polynomials.  (Polynomial)
  */
-Polynomial Polynomial::operator*(const Polynomial& other) {
-    // The function checks if the two polynomials could be multiplied.  If not, an error is raised.
-    if (a != other.a) {
-        cerr << "[PolynomialC/ERROR]" << endl <<
-             "These two polynomials have different values of 'a'." << endl <<
-             "Current polynomial value of a: " << a << endl <<
-             "Other polynomial value of a: " << other.a << endl <<
-             "Adding these two polynomials together would result in a mathematically" << endl <<
-             "incorrect polynomial." << endl;
-        throw invalid_argument("Polynomial a mismatch.");
-    }
-
-    // Space is allocated for the new polynomial.
-    vector<double> new_coefficient_list;
-    int new_size = coefficient_list.size() + other.coefficient_list.size() - 1;
-    new_coefficient_list.reserve(new_size);
-    for (int i = 0; i < new_size; i++) {
-        new_coefficient_list.push_back(0);
-    }
-
-    // The content from the other polynomials is multiplied to the new polynomial.
-    for (int i = 0; i < coefficient_list.size(); i++) {
-        for (int j = 0; j < other.coefficient_list.size(); j++) {
-            new_coefficient_list[i + j] += (coefficient_list[i] * other.coefficient_list[j]);
-        }
+Polynomial operator*(const Polynomial& left, const Polynomial& right) {
+    // With different centers, the shorter operand is first rewritten around the longer one's.
+    if (left.get_a() != right.get_a()) {
+        const double center = common_center(left, right);
+        return center == left.get_a() ? left * right.recenter(center) : left.recenter(center) * right;
     }
 
-    // The polynomial is created and returned.
-    Polynomial new_polynomial(new_coefficient_list);
-    return new_polynomial;
+    polynomialc_internal::ScopedTimer timer(PolynomialOperation::multiply);
+
+    // The product is computed by the multiplication engine, which picks schoolbook, Karatsuba or FFT
+    // multiplication depending on the sizes of the two polynomials.  The product can never reuse an
+    // operand's buffer, since the engine reads both operands while writing it.
+    // The product is written straight into the new polynomial, so products of low-degree polynomials
+    // stay in its inline storage.
+    const CoefficientList& first = left.coefficient_list;
+    const CoefficientList& second = right.coefficient_list;
+    Polynomial product;
+    product.a = left.a;
+    product.coefficient_list.resize(product_size(first, second));
+    polynomialc_internal::multiply(first.data(), first.size(), second.data(), second.size(),
+                                   product.coefficient_list.data());
+    remove_top_zero_terms(product.coefficient_list);
+    return product;
 }
 
-void Polynomial::operator*=(const Polynomial& other) {
-    // The function checks if the two polynomials could be multiplied.  If not, an error is raised.
-    if (a != other.a) {
-        cerr << "[PolynomialC/ERROR]" << endl <<
-             "These two polynomials have different values of 'a'." << endl <<
-             "Current polynomial value of a: " << a << endl <<
-             "Other polynomial value of a: " << other.a << endl <<
-             "Adding these two polynomials together would result in a mathematically" << endl <<
-             "incorrect polynomial." << endl;
-        throw invalid_argument("Polynomial a mismatch.");
-    }
-
-    // Space is allocated for the new polynomial.
-    vector<double> temp;
-    int new_size = coefficient_list.size() + other.coefficient_list.size() - 1;
-    temp.reserve(new_size);
-    for (int i = 0; i < new_size; i++) {
-        temp.push_back(0);
-    }
-
-    // The content from the other polynomials is multiplied to the new polynomial.
-    for (int i = 0; i < coefficient_list.size(); i++) {
-        for (int j = 0; j < other.coefficient_list.size(); j++) {
-            temp[i + j] += (coefficient_list[i] * other.coefficient_list[j]);
-        }
-    }
 
-    // The old coefficient list is overwritten by the new coefficient list.
-    coefficient_list = temp;
+/* Polynomial /= Polynomial and Polynomial %= Polynomial Operations
+ *
+ * Replaces the polynomial with the quotient or the remainder of its division by another polynomial.
+ * See divmod for how the division is done.
+ *
+ * Parameters: The divisor.  (Polynomial)
+ * Returns: This polynomial.  (Polynomial)
+ */
+Polynomial& Polynomial::operator/=(const Polynomial& other) {
+    *this = divmod(other).quotient;
+    return *this;
+}
+
+Polynomial& Polynomial::operator%=(const Polynomial& other) {
+    *this = divmod(other).remainder;
+    return *this;
 }
 
 
-/* Polynomial Copy Operator
+/* Polynomial / Polynomial and Polynomial % Polynomial Operators
  *
- * When a polynomial is copied to another polynomial, the constant list is transferred from the old
- * polynomial to the new polynomial.
+ * The quotient and the remainder of the division of one polynomial by another.  Use divmod to get
+ * both from a single division.
  *
- * Parameters: Another polynomial.  (Polynomial)
- * Returns: The parameter polynomial.  (Polynomial)
+ * Parameters: The dividend and the divisor.  (Polynomial)
+ * Returns: The quotient or the remainder.  (Polynomial)
  */
-Polynomial& Polynomial::operator=(const Polynomial& other) = default;
+Polynomial operator/(const Polynomial& left, const Polynomial& right) {
+    return left.divmod(right).quotient;
+}
+
+Polynomial operator%(const Polynomial& left, const Polynomial& right) {
+    return left.divmod(right).remainder;
+}
 
 
 // ===== CLASS INTERACTIONS WITH NON-POLYNOMIAL OBJECTS =====
 
 
-/* Polynomial + Constant Operation
+/* Polynomial += Constant Operation
  *
  * When a constant is added to a polynomial, the constant is added to the 0th power of the polynomial.
  *
- * Parameters: The constant to add.  (Float)
- * Returns: A new polynomial with an added constant.  (Polynomial)
+ * Parameters: The constant to add.  (Double)
+ * Returns: This polynomial.  (Polynomial)
  */
-Polynomial Polynomial::operator+(const float x) {
-    auto new_coefficient_list = coefficient_list;
-    if (new_coefficient_list.empty()) {
-        new_coefficient_list.push_back(x);
-    } else {
-        new_coefficient_list[0] += x;
-    }
-    Polynomial new_polynomial(new_coefficient_list);
-    return new_polynomial;
-}
+Polynomial& Polynomial::operator+=(const double x) {
+    polynomialc_internal::ScopedTimer timer(PolynomialOperation::scale);
 
-void Polynomial::operator+=(const float x) {
     if (coefficient_list.empty()) {
         coefficient_list.push_back(x);
     } else {
         coefficient_list[0] += x;
     }
+    keyword = PolynomialKeyword::none;
+    return *this;
 }
 
 
-/* Polynomial - Constant Operation
+/* Polynomial -= Constant Operation
  *
  * When a constant is subtracted to a polynomial, the constant is subtracted from the 0th power of
  * the polynomial.
  *
- * Parameters: The constant to add.  (Float)
- * Returns: A new polynomial with an added constant.  (Polynomial)
+ * Parameters: The constant to subtract.  (Double)
+ * Returns: This polynomial.  (Polynomial)
  */
-Polynomial Polynomial::operator-(const float x) {
-    auto new_coefficient_list = coefficient_list;
-    if (new_coefficient_list.empty()) {
-        new_coefficient_list.push_back(-x);
-    } else {
-        new_coefficient_list[0] -= x;
-    }
-    Polynomial new_polynomial(new_coefficient_list);
-    return new_polynomial;
-}
+Polynomial& Polynomial::operator-=(const double x) {
+    polynomialc_internal::ScopedTimer timer(PolynomialOperation::scale);
 
-void Polynomial::operator-=(const float x) {
     if (coefficient_list.empty()) {
         coefficient_list.push_back(-x);
     } else {
         coefficient_list[0] -= x;
     }
+    keyword = PolynomialKeyword::none;
+    return *this;
 }
 
 
-/* Polynomial * Constant Operation
+/* Polynomial *= Constant Operation
  *
  * When a polynomial is multiplied by a constant, every constant in the polynomial is multiplied
  * by the magnitude of the constant.
  *
- * Parameters: The multiplicative constant.  (Float)
- * Returns: A new polynomial increased by the magnitude of the constant.
+ * Parameters: The multiplicative constant.  (Double)
+ * Returns: This polynomial.  (Polynomial)
  */
-Polynomial Polynomial::operator*(const float x) {
-    auto new_coefficient_list = coefficient_list;
-    for (auto& constant : new_coefficient_list) {
-        constant *= x;
-    }
-    Polynomial new_polynomial(new_coefficient_list);
-    return new_polynomial;
-}
+Polynomial& Polynomial::operator*=(const double x) {
+    polynomialc_internal::ScopedTimer timer(PolynomialOperation::scale);
 
-void Polynomial::operator*=(const float x) {
     for (auto& constant : coefficient_list) {
         constant *= x;
     }
+    keyword = PolynomialKeyword::none;
+    return *this;
 }
 
 
-/* Polynomial / Constant Operation
+/* Polynomial /= Constant Operation
  *
  * When a polynomial is divided by a constant, every constant in the polynomial is divided
  * by the magnitude of the constant.
  *
- * Parameters: The divisor constant.  (Float)
- * Returns: A new polynomial decreased by the magnitude of the constant.
+ * Parameters: The divisor constant.  (Double)
+ * Returns: This polynomial.  (Polynomial)
  */
-Polynomial Polynomial::operator/(const float x) {
-    auto new_coefficient_list = coefficient_list;
-    for (auto& constant : new_coefficient_list) {
-        constant /= x;
-    }
-    Polynomial new_polynomial(new_coefficient_list);
-    return new_polynomial;
-}
+Polynomial& Polynomial::operator/=(const double x) {
+    polynomialc_internal::ScopedTimer timer(PolynomialOperation::scale);
 
-void Polynomial::operator/=(const float x) {
     for (auto& constant : coefficient_list) {
         constant /= x;
     }
+    keyword = PolynomialKeyword::none;
+    return *this;
+}
+
+
+/* Polynomial and Constant Operations
+ *
+ * Adds, subtracts, multiplies or divides a polynomial and a constant, with the constant on either
+ * side (except for division).  The polynomial is taken by value: a temporary polynomial is moved in
+ * and changed in place, while any other polynomial is copied once.
+ *
+ * Parameters: A polynomial (Polynomial) and a constant.  (Double)
+ * Returns: A new polynomial.  (Polynomial)
+ */
+Polynomial operator+(Polynomial polynomial, const double x) {
+    polynomial += x;
+    return polynomial;
+}
+
+Polynomial operator+(const double x, Polynomial polynomial) {
+    polynomial += x;
+    return polynomial;
+}
+
+Polynomial operator-(Polynomial polynomial, const double x) {
+    polynomial -= x;
+    return polynomial;
+}
+
+Polynomial operator-(const double x, Polynomial polynomial) {
+    polynomial *= -1;
+    polynomial += x;
+    return polynomial;
+}
+
+Polynomial operator*(Polynomial polynomial, const double x) {
+    polynomial *= x;
+    return polynomial;
+}
+
+Polynomial operator*(const double x, Polynomial polynomial) {
+    polynomial *= x;
+    return polynomial;
+}
+
+Polynomial operator/(Polynomial polynomial, const double x) {
+    polynomial /= x;
+    return polynomial;
+}
+
+
+/* Negation Operator
+ *
+ * Flips the sign of every constant in the polynomial.
+ *
+ * Parameters: A polynomial.  (Polynomial)
+ * Returns: The negated polynomial.  (Polynomial)
+ */
+Polynomial operator-(Polynomial polynomial) {
+    polynomial *= -1;
+    return polynomial;
 }
 
 
@@ -793,9 +1809,9 @@ double Polynomial::operator[](int i) const {
  * The parentheses operator solves the polynomial given a number x.
  *
  * Parameters: The input number, x.  (Double)
- * Returns: The result of the polynomial.  (Long Double)
+ * Returns: The result of the polynomial.  (Double)
  */
-long double Polynomial::operator()(double x) const {
+double Polynomial::operator()(double x) const {
     return solve(x);
 }
 
@@ -803,12 +1819,28 @@ long double Polynomial::operator()(double x) const {
 /* Angle Bracket Operator
  *
  * The angle bracket operator allows the polynomial to be displayed without calling the display
- * function.
+ * function.  It writes the simple display (see display) to the given stream.
  *
  * Parameters: Ofstream object, the polynomial itself.
  * Returns: Ofstream object.
  */
 ostream &operator<<(ostream& out, const Polynomial& obj) {
-    obj.hidden_display("simple");
+    polynomialc_internal::ScopedTimer timer(PolynomialOperation::display);
+
+    StreamSink sink(out, false);
+    write_terms(sink, obj.coefficient_list, obj.a, DisplayMode::simple);
     return out;
 }
+
+void polynomialc_internal::write_sparse_terms(ostream& out, span<const SparseTerm> terms, double a) {
+    // The simple display over the nonzero terms only (see SparsePolynomial's angle bracket operator).
+    StreamSink sink(out, false);
+    if (terms.empty()) {
+        append_text(sink, "There are no terms in this polynomial.");
+        return;
+    }
+    bool first = true;
+    for (size_t k = terms.size(); k-- > 0;) {
+        write_simple_term(sink, terms[k].coefficient, terms[k].exponent, a, first);
+    }
+}
@@ -7,65 +7,159 @@
 
 #include <iostream>
 #include <vector>
+#include <charconv>
 #include <cmath>
+#include <complex>
+#include <span>
+#include <string>
+#include "CoefficientList.h"
+#include "Instrumentation.h"
 using namespace std;
 
+// The outcome of a zero search (see Polynomial::find_zero).
+struct ZeroResult {
+    double root;
+    double residual;
+    unsigned int iterations;
+    bool converged;
+    bool bracketed;
+};
+
+// An interval holding real roots (see Polynomial::isolate_real_roots).
+struct RootInterval {
+    double low;
+    double high;
+    bool isolated;
+};
+
+struct DivisionResult;
+class SubproductTree;
+
+// Which function a keyword polynomial represents (see the keyword constructor).  A keyword polynomial
+// that is changed in any way becomes a plain polynomial (none).
+enum class PolynomialKeyword : unsigned char { none, sine, cosine, euler, ln };
+
+// How a polynomial is written out (see Polynomial::display).
+//  - all: every term in ascending order, (c * x^i), even those with 0 as their coefficient.
+//  - reduced: the same without the terms that have 0 as their coefficient.
+//  - simple: the nonzero terms in descending order, as compactly as possible (what operator<< writes).
+enum class DisplayMode : unsigned char { all, reduced, simple };
+
 class Polynomial {
     // The Polynomial's coefficient list is a series of x's raised to the power of the ith element.
     // A coefficient list of [1, 2, 3] would equal (1 * x^0) + (2 * x^1) + (3 * x^2) = 3x^2 + 2x + 1.
-    vector<double> coefficient_list;
+    // Up to 8 coefficients are stored inside the object (see CoefficientList.h); longer lists allocate
+    // from the memory resource the polynomial was created with (see PolynomialMemory.h).
+    CoefficientList coefficient_list;
     double a;
-    string keyword;
+    PolynomialKeyword keyword;
 
     // Private helper functions (the end user is not supposed to directly call these)
-    void hidden_display(const string& set_keyword) const;
-    bool check_behind(int i) const;
-    bool check_ahead(int i) const;
+    void move_center(double new_a);
 
 public:
     // Class Constructors
     Polynomial();
     Polynomial(vector<double> set_coefficient_list, double set_a);
+    Polynomial(span<const double> set_coefficient_list, double set_a, pmr::memory_resource* resource);
     explicit Polynomial(const string& keyword);
+    static Polynomial series(const string& keyword, unsigned int terms);
 
     // Class Getters & Setters
     vector<double> get_coefficients() const;
+    span<const double> coefficients() const;
     void set_coefficients(vector<double> new_coefficients);
     double get_a() const;
     void set_a(double new_a);
+    pmr::memory_resource* get_resource() const;
 
     // Class Functions
-    long double solve(double x) const;
+    double solve(double x) const;
+    void evaluate(span<const double> xs, span<double> out) const;
+    void evaluate(span<const double> xs, size_t x_stride, span<double> out, size_t out_stride) const;
+    vector<double> evaluate_many(span<const double> xs, unsigned int threads=0) const;
+    vector<double> evaluate_many(const SubproductTree& tree) const;
+    static Polynomial interpolate(span<const double> xs, span<const double> ys, unsigned int threads=0);
+    void evaluate_grid(double x0, double h, span<double> out) const;
     Polynomial differentiate() const;
     Polynomial integrate(double c=0);
-    Polynomial power(unsigned int x);
+    Polynomial power(unsigned int x) const;
+    Polynomial power(unsigned int x, unsigned int max_degree) const;
+    Polynomial recenter(double new_a) const;
+    Polynomial compose(const Polynomial& inner) const;
+    Polynomial compose(const Polynomial& inner, unsigned int max_degree) const;
+    Polynomial compositional_inverse(unsigned int max_degree) const;
     double zero(double guess=0.0, double tolerance=1e-10) const;
+    ZeroResult find_zero(double guess=0.0, double tolerance=1e-10, unsigned int max_iterations=100) const;
+    vector<complex<double>> roots(unsigned int threads=0) const;
+    vector<double> real_roots(double imaginary_tolerance=1e-8, unsigned int threads=0) const;
+    vector<RootInterval> isolate_real_roots(double low, double high, double tolerance=1e-12,
+                                            unsigned int threads=0) const;
+    DivisionResult divmod(const Polynomial& divisor) const;
+    Polynomial gcd(const Polynomial& other, double tolerance=1e-10) const;
     void display(const string& set_keyword="all") const;
+    void display(ostream& out, DisplayMode mode=DisplayMode::all, bool round_trip=false) const;
+    string format(DisplayMode mode=DisplayMode::simple, bool round_trip=false) const;
+    void format(string& text, DisplayMode mode=DisplayMode::simple, bool round_trip=false) const;
+    to_chars_result format(char* first, char* last, DisplayMode mode=DisplayMode::simple,
+                           bool round_trip=false) const;
 
     // Class Interactions with other polynomials
-    Polynomial operator+(const Polynomial& other);
-    void operator+=(const Polynomial& other);
-    Polynomial operator-(const Polynomial& other);
-    void operator-=(const Polynomial& other);
-    Polynomial operator*(const Polynomial& other);
-    void operator*=(const Polynomial& other);
+    Polynomial& operator+=(const Polynomial& other);
+    Polynomial& operator-=(const Polynomial& other);
+    Polynomial& operator*=(const Polynomial& other);
+    Polynomial& operator/=(const Polynomial& other);
+    Polynomial& operator%=(const Polynomial& other);
+    Polynomial(const Polynomial& other);
+    Polynomial(Polynomial&& other) noexcept;
     Polynomial& operator=(const Polynomial& other);
+    Polynomial& operator=(Polynomial&& other);
 
     // Class Interactions with other data types
-    Polynomial operator+(float x);
-    void operator+=(float x);
-    Polynomial operator-(float x);
-    void operator-=(float x);
-    Polynomial operator*(float x);
-    void operator*=(float x);
-    Polynomial operator/(float x);
-    void operator/=(float x);
+    Polynomial& operator+=(double x);
+    Polynomial& operator-=(double x);
+    Polynomial& operator*=(double x);
+    Polynomial& operator/=(double x);
 
     // Miscellaneous Operations
     double operator[](int i) const;
-    long double operator()(double x) const;
+    double operator()(double x) const;
     friend ostream& operator<<(ostream& out, const Polynomial& obj);
+    friend Polynomial operator*(const Polynomial& left, const Polynomial& right);
+    template <typename Derived> friend class PolynomialExpression;
+    friend class GridEvaluator;
+    friend class PolynomialView;
 };
 
+// Interactions with other polynomials.  Temporary operands lend their coefficient lists to the result.
+Polynomial operator+(const Polynomial& left, const Polynomial& right);
+Polynomial operator+(Polynomial&& left, const Polynomial& right);
+Polynomial operator+(const Polynomial& left, Polynomial&& right);
+Polynomial operator+(Polynomial&& left, Polynomial&& right);
+Polynomial operator-(const Polynomial& left, const Polynomial& right);
+Polynomial operator-(Polynomial&& left, const Polynomial& right);
+Polynomial operator-(const Polynomial& left, Polynomial&& right);
+Polynomial operator-(Polynomial&& left, Polynomial&& right);
+Polynomial operator*(const Polynomial& left, const Polynomial& right);
+Polynomial operator/(const Polynomial& left, const Polynomial& right);
+Polynomial operator%(const Polynomial& left, const Polynomial& right);
+
+// The outcome of a polynomial division (see Polynomial::divmod): dividend = quotient * divisor +
+// remainder, with the remainder of lower degree than the divisor.
+struct DivisionResult {
+    Polynomial quotient;
+    Polynomial remainder;
+};
+
+// Interactions with other data types
+Polynomial operator+(Polynomial polynomial, double x);
+Polynomial operator+(double x, Polynomial polynomial);
+Polynomial operator-(Polynomial polynomial, double x);
+Polynomial operator-(double x, Polynomial polynomial);
+Polynomial operator*(Polynomial polynomial, double x);
+Polynomial operator*(double x, Polynomial polynomial);
+Polynomial operator/(Polynomial polynomial, double x);
+Polynomial operator-(Polynomial polynomial);
+
 
 #endif //POLYNOMIALC_POLYNOMIALC_H
@@ -0,0 +1,329 @@
+//
+// Opt-in expression templates for Polynomial arithmetic.  Wrapping the operands in lazy() makes a
+// chain of additions, subtractions and scalar multiplications or divisions build a small expression
+// object instead of a Polynomial per step; the whole chain is then computed in one pass over the
+// coefficients when it is converted to a Polynomial:
+//
+//     Polynomial p = lazy(a) * 2.0 + lazy(b) - lazy(c) / 3.0;
+//
+// Products of two expressions are computed right away by the multiplication engine, and take part
+// in the rest of the chain like any other operand.  As with the Polynomial operators, operands with
+// different values of a meet at the longer one's, and the shorter one is rewritten (into a copy of its
+// coefficients) when the expression is built.  An expression refers to the polynomials it was built
+// from, so it has to be used while they are alive and unchanged (usually in the same statement).
+//
+
+#ifndef POLYNOMIALC_POLYNOMIALEXPRESSION_H
+#define POLYNOMIALC_POLYNOMIALEXPRESSION_H
+
+#include "PolynomialC.h"
+#include "Kernels.h"
+
+#include <algorithm>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+// The base of every lazy expression.  Derived must provide:
+// - size(): the number of coefficients of the result,
+// - common_size(): how many leading coefficients every operand has, so they can be read unchecked,
+// - coefficient(i): the ith coefficient for i < common_size(),
+// - checked_coefficient(i): the ith coefficient for any i (0 past the end of an operand),
+// - center(): the value of a of the result,
+// - move_center(new_a): rewrites the expression around new_a without changing its value.
+template <typename Derived>
+class PolynomialExpression {
+public:
+    const Derived& self() const {
+        return static_cast<const Derived&>(*this);
+    }
+
+    // Computes every coefficient in a single loop: the part every operand covers is read without
+    // bounds checks (so the compiler can vectorize it), and only the tail of the longer operands is
+    // checked.  target must hold size() coefficients.
+    void evaluate_into(double* target) const {
+        const Derived& expression = self();
+        const size_t size = expression.size();
+        const size_t common = min(expression.common_size(), size);
+        for (size_t i = 0; i < common; i++) {
+            target[i] = expression.coefficient(i);
+        }
+        for (size_t i = common; i < size; i++) {
+            target[i] = expression.checked_coefficient(i);
+        }
+    }
+
+    void evaluate_into(vector<double>& out) const {
+        out.resize(self().size());
+        evaluate_into(out.data());
+    }
+
+    // The coefficients are written straight into the new polynomial's list.
+    Polynomial evaluate() const {
+        Polynomial result;
+        result.a = self().center();
+        result.coefficient_list.resize(self().size());
+        evaluate_into(result.coefficient_list.data());
+        while (!result.coefficient_list.empty() && result.coefficient_list.back() == 0) {
+            result.coefficient_list.pop_back();
+        }
+        return result;
+    }
+
+    operator Polynomial() const {
+        return evaluate();
+    }
+};
+
+
+namespace polynomialc_internal {
+    // The coefficients of an operand rewritten in powers of (x - a - shift), for move_center().
+    inline shared_ptr<const vector<double>> shifted_coefficients(const double* data, size_t length, double shift) {
+        vector<double> coefficients(data, data + length);
+        taylor_shift(coefficients.data(), coefficients.size(), shift);
+        return make_shared<const vector<double>>(std::move(coefficients));
+    }
+}
+
+
+// A polynomial used as an operand.  It only refers to the coefficients, without copying them, unless
+// it has to be rewritten around another a.
+class LazyPolynomial : public PolynomialExpression<LazyPolynomial> {
+    shared_ptr<const vector<double>> shifted;
+    const double* data;
+    size_t length;
+    double a;
+
+public:
+    explicit LazyPolynomial(const Polynomial& polynomial)
+        : data(polynomial.coefficients().data()), length(polynomial.coefficients().size()),
+          a(polynomial.get_a()) {}
+
+    span<const double> view() const { return {data, length}; }
+    size_t size() const { return length; }
+    size_t common_size() const { return length; }
+    double coefficient(size_t i) const { return data[i]; }
+    double checked_coefficient(size_t i) const { return i < length ? data[i] : 0.0; }
+    double center() const { return a; }
+    void move_center(double new_a) {
+        if (new_a != a) {
+            shifted = polynomialc_internal::shifted_coefficients(data, length, new_a - a);
+            data = shifted->data();
+            a = new_a;
+        }
+    }
+};
+
+
+// The product of two expressions, computed when the expression is built.  The coefficients are
+// shared, so the expressions built on top of a product can copy it freely.
+class LazyProduct : public PolynomialExpression<LazyProduct> {
+    shared_ptr<const vector<double>> product;
+    const double* data;
+    size_t length;
+    double a;
+
+public:
+    LazyProduct(vector<double> coefficients, double a)
+        : product(make_shared<const vector<double>>(std::move(coefficients))), data(product->data()),
+          length(product->size()), a(a) {}
+
+    span<const double> view() const { return {data, length}; }
+    size_t size() const { return length; }
+    size_t common_size() const { return length; }
+    double coefficient(size_t i) const { return data[i]; }
+    double checked_coefficient(size_t i) const { return i < length ? data[i] : 0.0; }
+    double center() const { return a; }
+    void move_center(double new_a) {
+        if (new_a != a) {
+            product = polynomialc_internal::shifted_coefficients(data, length, new_a - a);
+            data = product->data();
+            a = new_a;
+        }
+    }
+};
+
+
+// The sum or difference of two expressions, coefficient by coefficient.
+struct LazyAdd {
+    static double apply(double left, double right) { return left + right; }
+};
+
+struct LazySubtract {
+    static double apply(double left, double right) { return left - right; }
+};
+
+template <typename Left, typename Right, typename Operation>
+class LazySum : public PolynomialExpression<LazySum<Left, Right, Operation>> {
+    Left left;
+    Right right;
+
+public:
+    LazySum(const Left& left, const Right& right) : left(left), right(right) {
+        // Like the Polynomial operators, the shorter operand is rewritten around the longer one's a,
+        // once when the chain is built.
+        const double center = polynomialc_internal::common_center(left.size(), left.center(), right.size(),
+                                                                  right.center());
+        this->left.move_center(center);
+        this->right.move_center(center);
+    }
+
+    size_t size() const { return max(left.size(), right.size()); }
+    size_t common_size() const { return min(left.common_size(), right.common_size()); }
+    double coefficient(size_t i) const {
+        return Operation::apply(left.coefficient(i), right.coefficient(i));
+    }
+    double checked_coefficient(size_t i) const {
+        return Operation::apply(left.checked_coefficient(i), right.checked_coefficient(i));
+    }
+    double center() const { return left.center(); }
+    void move_center(double new_a) {
+        // Rewriting around another a is linear, so each operand is rewritten on its own.
+        left.move_center(new_a);
+        right.move_center(new_a);
+    }
+};
+
+
+// An expression multiplied or divided by a constant.
+struct LazyMultiply {
+    static double apply(double value, double factor) { return value * factor; }
+};
+
+struct LazyDivide {
+    static double apply(double value, double factor) { return value / factor; }
+};
+
+template <typename Inner, typename Operation>
+class LazyScale : public PolynomialExpression<LazyScale<Inner, Operation>> {
+    Inner inner;
+    double factor;
+
+public:
+    LazyScale(const Inner& inner, double factor) : inner(inner), factor(factor) {}
+
+    size_t size() const { return inner.size(); }
+    size_t common_size() const { return inner.common_size(); }
+    double coefficient(size_t i) const { return Operation::apply(inner.coefficient(i), factor); }
+    double checked_coefficient(size_t i) const {
+        return Operation::apply(inner.checked_coefficient(i), factor);
+    }
+    double center() const { return inner.center(); }
+    void move_center(double new_a) { inner.move_center(new_a); }
+};
+
+
+// ===== BUILDING EXPRESSIONS =====
+
+// Starts a lazy expression from a polynomial.  Temporaries are rejected, since the expression would
+// outlive them.
+inline LazyPolynomial lazy(const Polynomial& polynomial) {
+    return LazyPolynomial(polynomial);
+}
+
+LazyPolynomial lazy(Polynomial&& polynomial) = delete;
+
+template <typename Left, typename Right>
+LazySum<Left, Right, LazyAdd> operator+(const PolynomialExpression<Left>& left,
+                                        const PolynomialExpression<Right>& right) {
+    return LazySum<Left, Right, LazyAdd>(left.self(), right.self());
+}
+
+template <typename Left>
+LazySum<Left, LazyPolynomial, LazyAdd> operator+(const PolynomialExpression<Left>& left,
+                                                 const Polynomial& right) {
+    return LazySum<Left, LazyPolynomial, LazyAdd>(left.self(), LazyPolynomial(right));
+}
+
+template <typename Right>
+LazySum<LazyPolynomial, Right, LazyAdd> operator+(const Polynomial& left,
+                                                  const PolynomialExpression<Right>& right) {
+    return LazySum<LazyPolynomial, Right, LazyAdd>(LazyPolynomial(left), right.self());
+}
+
+template <typename Left, typename Right>
+LazySum<Left, Right, LazySubtract> operator-(const PolynomialExpression<Left>& left,
+                                             const PolynomialExpression<Right>& right) {
+    return LazySum<Left, Right, LazySubtract>(left.self(), right.self());
+}
+
+template <typename Left>
+LazySum<Left, LazyPolynomial, LazySubtract> operator-(const PolynomialExpression<Left>& left,
+                                                      const Polynomial& right) {
+    return LazySum<Left, LazyPolynomial, LazySubtract>(left.self(), LazyPolynomial(right));
+}
+
+template <typename Right>
+LazySum<LazyPolynomial, Right, LazySubtract> operator-(const Polynomial& left,
+                                                       const PolynomialExpression<Right>& right) {
+    return LazySum<LazyPolynomial, Right, LazySubtract>(LazyPolynomial(left), right.self());
+}
+
+template <typename Inner>
+LazyScale<Inner, LazyMultiply> operator*(const PolynomialExpression<Inner>& inner, double x) {
+    return LazyScale<Inner, LazyMultiply>(inner.self(), x);
+}
+
+template <typename Inner>
+LazyScale<Inner, LazyMultiply> operator*(double x, const PolynomialExpression<Inner>& inner) {
+    return LazyScale<Inner, LazyMultiply>(inner.self(), x);
+}
+
+template <typename Inner>
+LazyScale<Inner, LazyDivide> operator/(const PolynomialExpression<Inner>& inner, double x) {
+    return LazyScale<Inner, LazyDivide>(inner.self(), x);
+}
+
+template <typename Inner>
+LazyScale<Inner, LazyMultiply> operator-(const PolynomialExpression<Inner>& inner) {
+    return LazyScale<Inner, LazyMultiply>(inner.self(), -1);
+}
+
+// The coefficients of an operand of a product.  Polynomials and products already hold theirs; any
+// other expression is computed into storage first.
+template <typename Expression>
+span<const double> product_operand(const PolynomialExpression<Expression>& expression, vector<double>& storage) {
+    if constexpr (is_same_v<Expression, LazyPolynomial> || is_same_v<Expression, LazyProduct>) {
+        return expression.self().view();
+    } else {
+        expression.evaluate_into(storage);
+        return storage;
+    }
+}
+
+// Products cannot be fused with the rest of the chain, so they are computed by the multiplication
+// engine as soon as they are built.  Operands with different values of a are first centered like in
+// the Polynomial operator.
+template <typename Left, typename Right>
+LazyProduct operator*(const PolynomialExpression<Left>& left, const PolynomialExpression<Right>& right) {
+    const double center = polynomialc_internal::common_center(left.self().size(), left.self().center(),
+                                                              right.self().size(), right.self().center());
+    Left left_centered = left.self();
+    Right right_centered = right.self();
+    left_centered.move_center(center);
+    right_centered.move_center(center);
+
+    vector<double> left_storage;
+    vector<double> right_storage;
+    span<const double> first = product_operand(left_centered, left_storage);
+    span<const double> second = product_operand(right_centered, right_storage);
+
+    vector<double> product;
+    if (!first.empty() && !second.empty()) {
+        product.resize(first.size() + second.size() - 1);
+        polynomialc_internal::multiply(first.data(), first.size(), second.data(), second.size(), product.data());
+    }
+    return LazyProduct(std::move(product), center);
+}
+
+template <typename Left>
+LazyProduct operator*(const PolynomialExpression<Left>& left, const Polynomial& right) {
+    return left * lazy(right);
+}
+
+template <typename Right>
+LazyProduct operator*(const Polynomial& left, const PolynomialExpression<Right>& right) {
+    return lazy(left) * right;
+}
+
+#endif //POLYNOMIALC_POLYNOMIALEXPRESSION_H
@@ -0,0 +1,102 @@
+//
+// The per-thread memory resource of Polynomial coefficient lists, and the counting and arena
+// resources built on it.
+//
+
+#include "PolynomialMemory.h"
+#include "Instrumentation.h"
+using namespace std;
+
+namespace {
+
+// nullptr stands for the global heap.
+thread_local pmr::memory_resource* current_resource = nullptr;
+
+#ifdef POLYNOMIALC_INSTRUMENTATION
+
+// The global heap, counted into the instrumentation counters of the allocating thread.
+class InstrumentedHeap : public pmr::memory_resource {
+protected:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        polynomialc_internal::count(PolynomialCounter::allocations, 1);
+        polynomialc_internal::count(PolynomialCounter::allocated_bytes, bytes);
+        return pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* pointer, size_t bytes, size_t alignment) override {
+        pmr::new_delete_resource()->deallocate(pointer, bytes, alignment);
+    }
+
+    bool do_is_equal(const pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+pmr::memory_resource* global_heap() {
+    // Never destroyed, so polynomials in static storage can still free their memory at exit.
+    static InstrumentedHeap* heap = new InstrumentedHeap();
+    return heap;
+}
+
+#else
+
+pmr::memory_resource* global_heap() {
+    return pmr::new_delete_resource();
+}
+
+#endif
+
+} // namespace
+
+
+// ===== CURRENT RESOURCE =====
+
+pmr::memory_resource* polynomial_resource() {
+    return current_resource != nullptr ? current_resource : global_heap();
+}
+
+pmr::memory_resource* set_polynomial_resource(pmr::memory_resource* resource) {
+    pmr::memory_resource* previous = polynomial_resource();
+    current_resource = resource;
+    return previous;
+}
+
+PolynomialResourceScope::PolynomialResourceScope(pmr::memory_resource* resource)
+    : previous(set_polynomial_resource(resource)) {}
+
+PolynomialResourceScope::~PolynomialResourceScope() {
+    set_polynomial_resource(previous);
+}
+
+
+// ===== COUNTING RESOURCE =====
+
+CountingResource::CountingResource(pmr::memory_resource* upstream) : upstream(upstream) {}
+
+void* CountingResource::do_allocate(size_t bytes, size_t alignment) {
+    void* pointer = upstream->allocate(bytes, alignment);
+    allocation_count++;
+    byte_count += bytes;
+    return pointer;
+}
+
+void CountingResource::do_deallocate(void* pointer, size_t bytes, size_t alignment) {
+    deallocation_count++;
+    upstream->deallocate(pointer, bytes, alignment);
+}
+
+bool CountingResource::do_is_equal(const pmr::memory_resource& other) const noexcept {
+    return this == &other;
+}
+
+void CountingResource::reset() {
+    allocation_count = 0;
+    deallocation_count = 0;
+    byte_count = 0;
+}
+
+
+// ===== ARENA =====
+
+PolynomialArena::PolynomialArena(size_t initial_bytes)
+    : buffer(initial_bytes, &heap), front(&buffer), scope(&front) {}
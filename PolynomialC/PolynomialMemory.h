@@ -0,0 +1,90 @@
+//
+// Control over where Polynomial coefficient lists get their memory.  Lists longer than the inline
+// storage (see CoefficientList.h) allocate from a std::pmr::memory_resource: by default the global heap,
+// or the resource installed on the current thread by a PolynomialResourceScope or a PolynomialArena.
+// A custom allocator can be used by wrapping it in a std::pmr::memory_resource.
+//
+//     PolynomialArena arena;                       // every polynomial made in this scope uses the arena
+//     Polynomial p = (a.differentiate() * b).integrate().power(3);
+//     result = p;                                  // copied into result's own memory
+//     cout << arena.requests() << " " << arena.heap_allocations() << endl;
+//
+// A polynomial keeps the resource it was created with for its whole life, so polynomials created in
+// an arena must be destroyed before the arena is.  Moving one into a new polynomial hands the arena
+// memory over too, so results that leave the arena's scope have to be copied or assigned: assigning
+// to a polynomial created outside the arena copies the coefficients into that polynomial's own memory.
+//
+
+#ifndef POLYNOMIALC_POLYNOMIALMEMORY_H
+#define POLYNOMIALC_POLYNOMIALMEMORY_H
+
+#include <cstddef>
+#include <memory_resource>
+
+// Returns the resource new polynomials on this thread allocate from (never null).
+std::pmr::memory_resource* polynomial_resource();
+
+// Sets the resource new polynomials on this thread allocate from; nullptr restores the global heap.
+// Returns the previous resource.
+std::pmr::memory_resource* set_polynomial_resource(std::pmr::memory_resource* resource);
+
+
+// Installs a resource for new polynomials on the current thread until the end of the scope.
+class PolynomialResourceScope {
+    std::pmr::memory_resource* previous;
+
+public:
+    explicit PolynomialResourceScope(std::pmr::memory_resource* resource);
+    ~PolynomialResourceScope();
+    PolynomialResourceScope(const PolynomialResourceScope&) = delete;
+    PolynomialResourceScope& operator=(const PolynomialResourceScope&) = delete;
+};
+
+
+// A resource that forwards to another one and counts what goes through it.  The counters are not
+// synchronized, so a CountingResource should only be used by one thread at a time.
+class CountingResource : public std::pmr::memory_resource {
+    std::pmr::memory_resource* upstream;
+    size_t allocation_count = 0;
+    size_t deallocation_count = 0;
+    size_t byte_count = 0;
+
+protected:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* pointer, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+public:
+    explicit CountingResource(std::pmr::memory_resource* upstream=std::pmr::new_delete_resource());
+
+    size_t allocations() const { return allocation_count; }
+    size_t deallocations() const { return deallocation_count; }
+    size_t bytes() const { return byte_count; }
+    void reset();
+};
+
+
+// A monotonic arena for a whole computation.  While it is alive, every polynomial created on the
+// current thread takes its memory from one growing buffer; freeing is a no-op, and the buffer is
+// released in one go when the arena is destroyed.
+class PolynomialArena {
+    CountingResource heap;
+    std::pmr::monotonic_buffer_resource buffer;
+    CountingResource front;
+    PolynomialResourceScope scope;
+
+public:
+    // initial_bytes is the size of the first block taken from the heap; later blocks grow
+    // geometrically.
+    explicit PolynomialArena(size_t initial_bytes=64 * 1024);
+    PolynomialArena(const PolynomialArena&) = delete;
+    PolynomialArena& operator=(const PolynomialArena&) = delete;
+
+    // The number of coefficient lists served by the arena, and the number of blocks it took from the
+    // heap to serve them.
+    size_t requests() const { return front.allocations(); }
+    size_t heap_allocations() const { return heap.allocations(); }
+    size_t heap_bytes() const { return heap.bytes(); }
+};
+
+#endif //POLYNOMIALC_POLYNOMIALMEMORY_H
@@ -0,0 +1,453 @@
+//
+// The binary polynomial format: the writer, the stream reader, and the memory-mapped store with its
+// views.
+//
+
+#include "PolynomialStore.h"
+#include "Kernels.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+using namespace std;
+
+namespace {
+
+// ===== HELPER FUNCTIONS =====
+
+const unsigned char magic[8] = {'P', 'L', 'Y', 'C', '\r', '\n', 0x1a, '\n'};
+const uint32_t format_version = 1;
+const size_t header_size = 64;
+const size_t entry_size = 24;
+const size_t data_alignment = 64;
+
+const bool little_endian_host = endian::native == endian::little;
+
+template <typename T>
+T byte_swap(T value) {
+    unsigned char bytes[sizeof(T)];
+    memcpy(bytes, &value, sizeof(T));
+    reverse(bytes, bytes + sizeof(T));
+    memcpy(&value, bytes, sizeof(T));
+    return value;
+}
+
+// Reads and writes one little-endian number at any alignment.
+template <typename T>
+T load(const unsigned char* source) {
+    T value;
+    memcpy(&value, source, sizeof(T));
+    return little_endian_host ? value : byte_swap(value);
+}
+
+template <typename T>
+void store(unsigned char* target, T value) {
+    value = little_endian_host ? value : byte_swap(value);
+    memcpy(target, &value, sizeof(T));
+}
+
+// Where the index and the coefficients of a file are, from its header.
+struct Layout {
+    size_t count;
+    size_t index_offset;
+    size_t entry_size;
+    size_t data_offset;
+};
+
+// Checks the magic and the version, the first thing done with any header.
+void check_signature(const unsigned char* header, size_t length) {
+    if (length < header_size || memcmp(header, magic, sizeof(magic)) != 0) {
+        throw runtime_error("Not a polynomial store.");
+    }
+    if (load<uint32_t>(header + 8) != format_version) {
+        throw runtime_error("Unsupported polynomial store version.");
+    }
+}
+
+Layout read_header(const unsigned char* header, size_t length) {
+    check_signature(header, length);
+
+    Layout layout;
+    layout.entry_size = load<uint32_t>(header + 12);
+    layout.count = size_t(load<uint64_t>(header + 16));
+    layout.index_offset = size_t(load<uint64_t>(header + 24));
+    layout.data_offset = size_t(load<uint64_t>(header + 32));
+    if (load<uint64_t>(header + 40) != length) {
+        throw runtime_error("The polynomial store is truncated.");
+    }
+
+    // Every region has to lie inside the file, and the coefficients have to be aligned for doubles.
+    if (layout.entry_size < entry_size || layout.index_offset < header_size || layout.index_offset > length ||
+        layout.count > (length - layout.index_offset) / layout.entry_size ||
+        layout.data_offset < header_size || layout.data_offset > length || layout.data_offset % sizeof(double) != 0) {
+        throw runtime_error("The polynomial store header is corrupt.");
+    }
+    return layout;
+}
+
+// Makes a view of one index entry, after checking that its coefficients lie inside the file.
+PolynomialView read_entry(const unsigned char* entry, const double* data, size_t data_terms) {
+    const double a = load<double>(entry);
+    const uint64_t first = load<uint64_t>(entry + 8);
+    const uint32_t terms = load<uint32_t>(entry + 16);
+    const unsigned char keyword = entry[20];
+    if (first > data_terms || terms > data_terms - first || keyword > (unsigned char) PolynomialKeyword::ln) {
+        throw runtime_error("A polynomial store entry is corrupt.");
+    }
+    return {span<const double>(data + first, terms), a, PolynomialKeyword(keyword)};
+}
+
+polynomialc_internal::SeriesTable series_table(PolynomialKeyword keyword) {
+    using polynomialc_internal::SeriesTable;
+    switch (keyword) {
+        case PolynomialKeyword::sine:
+            return SeriesTable::sine;
+        case PolynomialKeyword::cosine:
+            return SeriesTable::cosine;
+        case PolynomialKeyword::euler:
+            return SeriesTable::euler;
+        default:
+            return SeriesTable::ln;
+    }
+}
+
+} // namespace
+
+
+
+
+
+// ===== POLYNOMIAL VIEW =====
+
+
+/* Polynomial View Constructors
+ *
+ * Views coefficients kept somewhere else, or the coefficients of a Polynomial (which must then
+ * outlive the view and not be changed while it is used).
+ *
+ * Parameters: The coefficients, lowest power first (Span of doubles), the center a (Double), the
+ * function a keyword polynomial stands for.  (PolynomialKeyword)
+ * Or: The polynomial to view.  (Polynomial)
+ */
+PolynomialView::PolynomialView(span<const double> coefficients, double a, PolynomialKeyword keyword)
+    : terms(coefficients.data()), count(coefficients.size()), a(a), keyword(keyword) {}
+
+PolynomialView::PolynomialView(const Polynomial& polynomial)
+    : PolynomialView(polynomial.coefficients(), polynomial.a, polynomial.keyword) {}
+
+
+/* Solve
+ *
+ * Solves the viewed polynomial at x, exactly like Polynomial::solve: Horner's scheme around a, or the
+ * range-reduced function of a keyword polynomial.
+ *
+ * Parameters: The value of x.  (Double)
+ * Returns: The value of the polynomial.  (Double)
+ */
+double PolynomialView::solve(double x) const {
+    if (keyword != PolynomialKeyword::none) {
+        return polynomialc_internal::series_evaluate(series_table(keyword), x);
+    }
+
+    const double t = x - a;
+    double result = 0;
+    for (size_t i = count; i-- > 0;) {
+        result = result * t + terms[i];
+    }
+    polynomialc_internal::count(PolynomialCounter::flops, 2 * count);
+    return result;
+}
+
+
+/* Evaluate
+ *
+ * Solves the viewed polynomial at many values of x with the vectorized kernel of Polynomial::evaluate.
+ *
+ * Parameters: The values of x (Span of doubles), where to write the results (Span of doubles, same
+ * size as the values of x).
+ * Returns: None.
+ */
+void PolynomialView::evaluate(span<const double> xs, span<double> out) const {
+    if (xs.size() != out.size()) {
+        throw invalid_argument("Polynomial evaluate size mismatch.");
+    }
+
+    if (keyword != PolynomialKeyword::none) {
+        const polynomialc_internal::SeriesTable table = series_table(keyword);
+        for (size_t k = 0; k < xs.size(); k++) {
+            out[k] = polynomialc_internal::series_evaluate(table, xs[k]);
+        }
+        return;
+    }
+
+    polynomialc_internal::horner_batch(terms, count, a, xs.data(), out.data(), xs.size());
+}
+
+
+/* To Polynomial
+ *
+ * Copies the viewed polynomial into a Polynomial, which takes its memory from the thread's current
+ * resource.
+ *
+ * Returns: The copy.  (Polynomial)
+ */
+Polynomial PolynomialView::to_polynomial() const {
+    Polynomial result(coefficients(), a, polynomial_resource());
+    result.keyword = keyword;
+    return result;
+}
+
+
+
+
+
+// ===== POLYNOMIAL STORE =====
+
+
+/* Polynomial Store Constructor
+ *
+ * Maps a file written by save_polynomials into memory, read-only, and checks its header.  Nothing is
+ * read beyond the header until views are taken, so opening takes the same time for any size of store,
+ * and only the pages that are used are ever loaded.  The format is little-endian, so the store (which
+ * never copies the coefficients) needs a little-endian machine; read_polynomials works on any.
+ *
+ * Parameters: The path of the file.  (String)
+ */
+PolynomialStore::PolynomialStore(const string& path) {
+    if (!little_endian_host) {
+        throw runtime_error("Polynomial stores can only be mapped on little-endian machines.");
+    }
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        throw runtime_error("Could not open " + path + ".");
+    }
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart < LONGLONG(header_size)) {
+        CloseHandle(file);
+        throw runtime_error("Not a polynomial store.");
+    }
+    length = size_t(file_size.QuadPart);
+    mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (mapping == nullptr) {
+        throw runtime_error("Could not map " + path + ".");
+    }
+    bytes = static_cast<const unsigned char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    if (bytes == nullptr) {
+        CloseHandle(mapping);
+        throw runtime_error("Could not map " + path + ".");
+    }
+#else
+    const int file = open(path.c_str(), O_RDONLY);
+    if (file < 0) {
+        throw runtime_error("Could not open " + path + ".");
+    }
+    struct stat info;
+    if (fstat(file, &info) != 0 || info.st_size < off_t(header_size)) {
+        close(file);
+        throw runtime_error("Not a polynomial store.");
+    }
+    length = size_t(info.st_size);
+    void* mapped = mmap(nullptr, length, PROT_READ, MAP_SHARED, file, 0);
+    close(file);
+    if (mapped == MAP_FAILED) {
+        throw runtime_error("Could not map " + path + ".");
+    }
+    bytes = static_cast<const unsigned char*>(mapped);
+#endif
+
+    try {
+        const Layout layout = read_header(bytes, length);
+        polynomial_count = layout.count;
+        index = bytes + layout.index_offset;
+        index_stride = layout.entry_size;
+        data = reinterpret_cast<const double*>(bytes + layout.data_offset);
+        data_terms = (length - layout.data_offset) / sizeof(double);
+    } catch (...) {
+        unmap();
+        throw;
+    }
+}
+
+PolynomialStore::~PolynomialStore() {
+    unmap();
+}
+
+void PolynomialStore::unmap() {
+#ifdef _WIN32
+    UnmapViewOfFile(bytes);
+    CloseHandle(mapping);
+#else
+    munmap(const_cast<unsigned char*>(bytes), length);
+#endif
+}
+
+
+/* Square Bracket Operator
+ *
+ * Takes a view of the ith polynomial of the store.  The view points into the mapping, so it is only
+ * valid while the store is open.
+ *
+ * Parameters: The position of the polynomial.  (Size)
+ * Returns: A view of the polynomial.  (PolynomialView)
+ */
+PolynomialView PolynomialStore::operator[](size_t i) const {
+    if (i >= polynomial_count) {
+        throw invalid_argument("Polynomial store index out of range.");
+    }
+    return read_entry(index + i * index_stride, data, data_terms);
+}
+
+
+
+
+
+// ===== WRITING AND READING =====
+
+
+/* Write Polynomials
+ *
+ * Writes polynomials to a binary stream in the format described in PolynomialStore.h: the header, an
+ * index entry per polynomial, then every coefficient list, one after the other.
+ *
+ * Parameters: The stream, opened in binary mode (Output Stream), the polynomials.  (Span of Polynomials)
+ * Returns: None.
+ */
+void write_polynomials(ostream& out, span<const Polynomial> polynomials) {
+    const size_t count = polynomials.size();
+    const size_t data_offset = (header_size + count * entry_size + data_alignment - 1) / data_alignment * data_alignment;
+
+    // The header, the index and the padding up to the coefficients are built in one buffer.
+    vector<unsigned char> head(data_offset, 0);
+    uint64_t total_terms = 0;
+    for (size_t i = 0; i < count; i++) {
+        const PolynomialView view(polynomials[i]);
+        if (view.size() > UINT32_MAX) {
+            throw invalid_argument("Polynomial too long for the store format.");
+        }
+        unsigned char* entry = head.data() + header_size + i * entry_size;
+        store<double>(entry, view.get_a());
+        store<uint64_t>(entry + 8, total_terms);
+        store<uint32_t>(entry + 16, uint32_t(view.size()));
+        entry[20] = (unsigned char) view.get_keyword();
+        total_terms += view.size();
+    }
+
+    memcpy(head.data(), magic, sizeof(magic));
+    store<uint32_t>(head.data() + 8, format_version);
+    store<uint32_t>(head.data() + 12, uint32_t(entry_size));
+    store<uint64_t>(head.data() + 16, count);
+    store<uint64_t>(head.data() + 24, header_size);
+    store<uint64_t>(head.data() + 32, data_offset);
+    store<uint64_t>(head.data() + 40, data_offset + total_terms * sizeof(double));
+    out.write(reinterpret_cast<const char*>(head.data()), streamsize(head.size()));
+
+    vector<double> swapped;
+    for (const Polynomial& polynomial : polynomials) {
+        span<const double> coefficients = polynomial.coefficients();
+        if (!little_endian_host) {
+            swapped.resize(coefficients.size());
+            transform(coefficients.begin(), coefficients.end(), swapped.begin(), byte_swap<double>);
+            coefficients = swapped;
+        }
+        out.write(reinterpret_cast<const char*>(coefficients.data()), streamsize(coefficients.size_bytes()));
+    }
+
+    if (!out) {
+        throw runtime_error("Could not write the polynomials.");
+    }
+}
+
+
+/* Save Polynomials
+ *
+ * Writes polynomials to a file (replacing it) that a PolynomialStore can map.
+ *
+ * Parameters: The path of the file (String), the polynomials.  (Span of Polynomials)
+ * Returns: None.
+ */
+void save_polynomials(const string& path, span<const Polynomial> polynomials) {
+    ofstream out(path, ios::binary | ios::trunc);
+    if (!out) {
+        throw runtime_error("Could not open " + path + ".");
+    }
+    write_polynomials(out, polynomials);
+    out.close();
+    if (!out) {
+        throw runtime_error("Could not write " + path + ".");
+    }
+}
+
+
+/* Read Polynomials
+ *
+ * Reads a whole binary stream written by write_polynomials back into Polynomials.  Unlike a
+ * PolynomialStore this copies every coefficient, but it works on streams and on any machine.
+ *
+ * Parameters: The stream, opened in binary mode.  (Input Stream)
+ * Returns: The polynomials, in the order they were written.  (Vector of Polynomials)
+ */
+vector<Polynomial> read_polynomials(istream& in) {
+    unsigned char header[header_size];
+    if (!in.read(reinterpret_cast<char*>(header), header_size)) {
+        throw runtime_error("Not a polynomial store.");
+    }
+    check_signature(header, header_size);
+    const uint64_t length = load<uint64_t>(header + 40);
+    if (length < header_size || length > numeric_limits<size_t>::max() - sizeof(double)) {
+        throw runtime_error("The polynomial store header is corrupt.");
+    }
+
+    // The file is read into doubles, so the coefficients in it are aligned.  The length is only a
+    // claim of the stream, so the buffer grows a chunk at a time with what was actually read: a bogus
+    // length ends as a truncated store, not as an allocation of that size.
+    const size_t chunk = size_t(1) << 20;
+    vector<double> buffer(header_size / sizeof(double));
+    memcpy(buffer.data(), header, header_size);
+    size_t read = header_size;
+    while (read < length) {
+        const size_t next = size_t(min<uint64_t>(length - read, chunk));
+        buffer.resize((read + next + sizeof(double) - 1) / sizeof(double));
+        if (!in.read(reinterpret_cast<char*>(buffer.data()) + read, streamsize(next))) {
+            throw runtime_error("The polynomial store is truncated.");
+        }
+        read += next;
+    }
+
+    unsigned char* bytes = reinterpret_cast<unsigned char*>(buffer.data());
+    const Layout layout = read_header(bytes, length);
+    double* data = reinterpret_cast<double*>(bytes + layout.data_offset);
+    const size_t data_terms = (length - layout.data_offset) / sizeof(double);
+    if (!little_endian_host) {
+        transform(data, data + data_terms, data, byte_swap<double>);
+    }
+
+    vector<Polynomial> polynomials;
+    polynomials.reserve(layout.count);
+    for (size_t i = 0; i < layout.count; i++) {
+        const unsigned char* entry = bytes + layout.index_offset + i * layout.entry_size;
+        polynomials.push_back(read_entry(entry, data, data_terms).to_polynomial());
+    }
+    return polynomials;
+}
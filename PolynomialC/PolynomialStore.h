@@ -0,0 +1,114 @@
+//
+// A compact binary format for collections of polynomials, and a read-only store that maps such a file
+// into memory and evaluates the polynomials straight from it.
+//
+//     save_polynomials("models.plyc", models);     // any span of Polynomials
+//     PolynomialStore store("models.plyc");        // maps the file: no parsing, no copies
+//     double y = store[42].solve(x);               // a PolynomialView into the mapping
+//
+// Version 1 of the format, every number little-endian:
+//
+//     offset  size  header
+//          0     8  magic "PLYC\r\n\x1a\n" (the \r\n and \x1a catch text-mode transfers)
+//          8     4  version (1)
+//         12     4  size of an index entry (24)
+//         16     8  number of polynomials
+//         24     8  offset of the index
+//         32     8  offset of the coefficients (a multiple of 64)
+//         40     8  size of the file
+//         48    16  reserved (0)
+//
+//     index entry (one per polynomial, in order)
+//          0     8  a (double)
+//          8     8  position of the first coefficient, counted in doubles from the coefficients
+//         16     4  number of coefficients
+//         20     1  keyword (PolynomialKeyword: 0 none, 1 sine, 2 cosine, 3 euler, 4 ln)
+//         21     3  reserved (0)
+//
+// The coefficients of every polynomial are stored contiguously as doubles, lowest power first, so a
+// view hands them to the same Horner kernels as a Polynomial.  Readers reject other versions.
+//
+
+#ifndef POLYNOMIALC_POLYNOMIALSTORE_H
+#define POLYNOMIALC_POLYNOMIALSTORE_H
+
+#include "PolynomialC.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <span>
+#include <string>
+#include <vector>
+
+// A read-only polynomial whose coefficients live somewhere else (usually in a PolynomialStore's
+// mapping).  A view is a pointer, a size, a and a keyword; it never allocates, and it is only valid
+// while the memory it points to is.
+class PolynomialView {
+    const double* terms = nullptr;
+    size_t count = 0;
+    double a = 0;
+    PolynomialKeyword keyword = PolynomialKeyword::none;
+
+public:
+    // Class Constructors
+    PolynomialView() = default;
+    PolynomialView(span<const double> coefficients, double a, PolynomialKeyword keyword=PolynomialKeyword::none);
+    explicit PolynomialView(const Polynomial& polynomial);
+
+    // Class Getters
+    span<const double> coefficients() const { return {terms, count}; }
+    double get_a() const { return a; }
+    PolynomialKeyword get_keyword() const { return keyword; }
+    size_t size() const { return count; }
+
+    // Class Functions
+    double solve(double x) const;
+    void evaluate(span<const double> xs, span<double> out) const;
+    Polynomial to_polynomial() const;
+
+    // Miscellaneous Operations
+    double operator[](size_t i) const { return terms[i]; }
+    double operator()(double x) const { return solve(x); }
+};
+
+
+// A store file mapped into memory.  Opening it only checks the header, so it takes the same time for
+// any number of polynomials; each index entry is checked when its view is taken.  The mapping is
+// read-only and shared, so any number of threads can take views and evaluate them at once.
+class PolynomialStore {
+    const unsigned char* bytes = nullptr;
+    size_t length = 0;
+    size_t polynomial_count = 0;
+    const unsigned char* index = nullptr;
+    size_t index_stride = 0;
+    const double* data = nullptr;
+    size_t data_terms = 0;
+#ifdef _WIN32
+    void* mapping = nullptr;
+#endif
+
+    void unmap();
+
+public:
+    explicit PolynomialStore(const string& path);
+    ~PolynomialStore();
+    PolynomialStore(const PolynomialStore&) = delete;
+    PolynomialStore& operator=(const PolynomialStore&) = delete;
+
+    // The number of polynomials in the store.
+    size_t size() const { return polynomial_count; }
+
+    // A view of the ith polynomial.
+    PolynomialView operator[](size_t i) const;
+};
+
+
+// Writes polynomials in the binary format, to a stream opened in binary mode or to a file.
+void write_polynomials(ostream& out, span<const Polynomial> polynomials);
+void save_polynomials(const string& path, span<const Polynomial> polynomials);
+
+// Reads every polynomial of a stream in the binary format into ordinary Polynomials.
+vector<Polynomial> read_polynomials(istream& in);
+
+#endif //POLYNOMIALC_POLYNOMIALSTORE_H
@@ -0,0 +1,222 @@
+//
+// Simultaneous root finding with the Aberth-Ehrlich iteration.
+//
+
+#include "Kernels.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+using namespace std;
+
+namespace polynomialc_internal {
+namespace {
+
+// Roots are only spread over threads when there are enough of them to pay for the hand-off.
+const size_t parallel_root_threshold = 64;
+const unsigned int aberth_max_iterations = 200;
+
+// Starting points from the Newton polygon of the coefficients (Bini, 1996).  Each edge of the
+// upper convex hull of the points (i, log|c_i|) says that (end - start) roots have a modulus close to
+// (|c_start| / |c_end|)^(1 / (end - start)); those roots start evenly spread on that circle.
+vector<complex<double>> initial_guesses(const vector<double>& coefficients) {
+    const double pi = 3.14159265358979323846;
+    const size_t degree = coefficients.size() - 1;
+
+    vector<size_t> hull;
+    for (size_t i = 0; i <= degree; i++) {
+        if (coefficients[i] == 0) {
+            continue;
+        }
+        double log_i = log(fabs(coefficients[i]));
+        while (hull.size() >= 2) {
+            size_t p = hull[hull.size() - 2];
+            size_t q = hull[hull.size() - 1];
+            double log_p = log(fabs(coefficients[p]));
+            double log_q = log(fabs(coefficients[q]));
+            // q is dropped when it lies on or below the line from p to i.
+            if ((log_q - log_p) * double(i - p) <= (log_i - log_p) * double(q - p)) {
+                hull.pop_back();
+            } else {
+                break;
+            }
+        }
+        hull.push_back(i);
+    }
+
+    vector<complex<double>> guesses;
+    guesses.reserve(degree);
+    for (size_t k = 0; k + 1 < hull.size(); k++) {
+        size_t start = hull[k];
+        size_t end = hull[k + 1];
+        size_t count = end - start;
+        double radius = pow(fabs(coefficients[start]) / fabs(coefficients[end]), 1.0 / double(count));
+        // The offsets keep circles from lining up and the guesses away from the real axis, where
+        // conjugate pairs would otherwise stay stuck together.
+        double offset = 2 * pi * double(k) / double(degree) + 0.4;
+        for (size_t j = 0; j < count; j++) {
+            double angle = 2 * pi * double(j) / double(count) + offset;
+            guesses.push_back(polar(radius, angle));
+        }
+    }
+    return guesses;
+}
+
+// Computes the Newton correction p(z) / p'(z) and reports whether |p(z)| has dropped to the size of
+// a rounding error on its largest terms, in which case z cannot be improved.  radius is how far a root
+// can be from z with p(z) still that small: degree times the rounding error over |p'(z)|.  Points
+// outside the unit circle are evaluated through the reversed polynomial in 1 / z so high degrees
+// cannot overflow.
+bool newton_correction(const vector<double>& coefficients, complex<double> z, complex<double>& correction,
+                       double& radius) {
+    const size_t degree = coefficients.size() - 1;
+    const double rounding = numeric_limits<double>::epsilon();
+
+    complex<double> value = 0;
+    complex<double> derivative = 0;
+    double magnitude = 0;
+
+    if (abs(z) <= 1) {
+        double modulus = abs(z);
+        for (size_t i = degree + 1; i-- > 0;) {
+            derivative = derivative * z + value;
+            value = value * z + coefficients[i];
+            magnitude = magnitude * modulus + fabs(coefficients[i]);
+        }
+        correction = value / derivative;
+        radius = double(degree) * rounding * magnitude / abs(derivative);
+    } else {
+        // p(z) = z^d q(y) and p'(z) = z^(d - 1) (d q(y) - y q'(y)) with y = 1 / z.
+        complex<double> y = 1.0 / z;
+        double modulus = abs(y);
+        for (size_t i = 0; i <= degree; i++) {
+            derivative = derivative * y + value;
+            value = value * y + coefficients[i];
+            magnitude = magnitude * modulus + fabs(coefficients[i]);
+        }
+        correction = z * value / (double(degree) * value - y * derivative);
+        radius = double(degree) * rounding * abs(z) * magnitude / abs(double(degree) * value - y * derivative);
+    }
+
+    return abs(value) <= rounding * magnitude;
+}
+
+// The roots of a real polynomial are real or come in conjugate pairs, but the iteration leaves them a
+// rounding error off the real axis and out of step with their partners.  A root whose imaginary part is
+// within its radius (see newton_correction) is put on the real axis; every other root in the upper
+// half plane is paired with the nearest unpaired conjugate of a root in the lower one, and both are
+// replaced by the mean of the two estimates.  A root left without a partner is put on the real axis.
+void pair_conjugates(const vector<double>& coefficients, vector<complex<double>>& roots) {
+    const size_t count = roots.size();
+    vector<char> done(count, 0);
+    for (size_t i = 0; i < count; i++) {
+        complex<double> correction;
+        double radius;
+        newton_correction(coefficients, roots[i], correction, radius);
+        if (!(fabs(roots[i].imag()) > radius)) {
+            roots[i].imag(0);
+            done[i] = 1;
+        }
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        if (done[i] || roots[i].imag() < 0) {
+            continue;
+        }
+        size_t partner = count;
+        double nearest = numeric_limits<double>::infinity();
+        for (size_t j = 0; j < count; j++) {
+            if (!done[j] && roots[j].imag() < 0 && abs(roots[j] - conj(roots[i])) < nearest) {
+                partner = j;
+                nearest = abs(roots[j] - conj(roots[i]));
+            }
+        }
+        done[i] = 1;
+        if (partner == count) {
+            roots[i].imag(0);
+            continue;
+        }
+        roots[i] = (roots[i] + conj(roots[partner])) / 2.0;
+        roots[partner] = conj(roots[i]);
+        done[partner] = 1;
+    }
+    for (size_t i = 0; i < count; i++) {
+        if (!done[i]) {
+            roots[i].imag(0);
+        }
+    }
+}
+
+} // namespace
+
+
+vector<complex<double>> aberth_roots(const double* coefficients, size_t n, unsigned int threads) {
+    // Trailing zero terms are dropped, and every leading zero term is a root at exactly 0.
+    while (n > 0 && coefficients[n - 1] == 0) {
+        n--;
+    }
+    size_t zero_roots = 0;
+    while (zero_roots < n && coefficients[zero_roots] == 0) {
+        zero_roots++;
+    }
+
+    vector<complex<double>> roots(zero_roots, complex<double>(0, 0));
+    if (n == 0 || n - zero_roots <= 1) {
+        return roots;
+    }
+
+    vector<double> reduced(coefficients + zero_roots, coefficients + n);
+    const size_t degree = reduced.size() - 1;
+
+    vector<complex<double>> current = initial_guesses(reduced);
+    vector<complex<double>> next = current;
+    vector<char> converged(degree, 0);
+
+    unsigned int parts = degree >= parallel_root_threshold ? resolve_threads(threads) : 1;
+    for (unsigned int iteration = 0; iteration < aberth_max_iterations; iteration++) {
+        // Every root is updated from the previous positions of all others (a Jacobi sweep), so the
+        // updates are independent and can run on separate threads.
+        ThreadPool::global().parallel_for(degree, parts, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                next[i] = current[i];
+                if (converged[i]) {
+                    continue;
+                }
+
+                complex<double> correction;
+                double radius;
+                if (newton_correction(reduced, current[i], correction, radius)) {
+                    converged[i] = 1;
+                    continue;
+                }
+
+                complex<double> repulsion = 0;
+                for (size_t j = 0; j < degree; j++) {
+                    if (j != i) {
+                        repulsion += 1.0 / (current[i] - current[j]);
+                    }
+                }
+                complex<double> step = correction / (1.0 - correction * repulsion);
+                if (!isfinite(step.real()) || !isfinite(step.imag())) {
+                    continue;
+                }
+                next[i] = current[i] - step;
+                if (abs(step) <= numeric_limits<double>::epsilon() * abs(next[i])) {
+                    converged[i] = 1;
+                }
+            }
+        });
+        current.swap(next);
+
+        if (all_of(converged.begin(), converged.end(), [](char done) { return done != 0; })) {
+            break;
+        }
+    }
+
+    pair_conjugates(reduced, current);
+    roots.insert(roots.end(), current.begin(), current.end());
+    return roots;
+}
+
+} // namespace polynomialc_internal
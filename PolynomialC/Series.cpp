@@ -0,0 +1,234 @@
+//
+// Shared coefficient tables for the keyword constructor.
+//
+
+#include "Kernels.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <limits>
+#include <mutex>
+#include <shared_mutex>
+using namespace std;
+
+namespace polynomialc_internal {
+namespace {
+
+// Every table holds the terms generated so far and whether it has reached its last term (the
+// factorial series end once 1/i! drops below the smallest normal double).
+struct CachedSeries {
+    vector<double> coefficients;
+    bool complete = false;
+};
+
+shared_mutex series_lock;
+CachedSeries series_cache[4];
+
+// Rebuilds a table with at least terms coefficients.  The reciprocal factorials are accumulated in
+// long double so every coefficient is rounded to double only once.
+void build_series(SeriesTable table, size_t terms, CachedSeries& series) {
+    vector<double> coefficients;
+    coefficients.reserve(terms);
+
+    if (table == SeriesTable::ln) {
+        // ln(x) = (x - 1) - (x - 1)^2 / 2 + (x - 1)^3 / 3 - ...
+        if (terms > 0) {
+            coefficients.push_back(0);
+        }
+        for (size_t i = 1; i < terms; i++) {
+            coefficients.push_back(i % 2 == 1 ? 1.0 / double(i) : -1.0 / double(i));
+        }
+        series.coefficients.swap(coefficients);
+        return;
+    }
+
+    long double reciprocal_factorial = 1;
+    for (size_t i = 0; i < terms; i++) {
+        if (i > 0) {
+            reciprocal_factorial /= (long double) i;
+        }
+        if (double(reciprocal_factorial) < DBL_MIN) {
+            series.complete = true;
+            break;
+        }
+
+        double value = double(reciprocal_factorial);
+        if (table == SeriesTable::sine) {
+            // sin(x) = x - x^3 / 3! + x^5 / 5! - ...
+            value = i % 2 == 0 ? 0.0 : (i % 4 == 1 ? value : -value);
+        } else if (table == SeriesTable::cosine) {
+            // cos(x) = 1 - x^2 / 2! + x^4 / 4! - ...
+            value = i % 2 == 1 ? 0.0 : (i % 4 == 0 ? value : -value);
+        }
+        coefficients.push_back(value);
+    }
+
+    // A series never ends on a zero term.
+    while (!coefficients.empty() && coefficients.back() == 0) {
+        coefficients.pop_back();
+    }
+    series.coefficients.swap(coefficients);
+}
+
+// Copies the first terms coefficients of a table, without the zero terms at the top.
+vector<double> copy_prefix(const CachedSeries& series, size_t terms) {
+    size_t length = min(terms, series.coefficients.size());
+    while (length > 0 && series.coefficients[length - 1] == 0) {
+        length--;
+    }
+    return vector<double>(series.coefficients.begin(), series.coefficients.begin() + length);
+}
+
+
+// ===== RANGE-REDUCED EVALUATION =====
+
+// pi / 2 split into three parts whose leading bits are exact, so that x - n * pi / 2 can be computed
+// without losing the low bits of the remainder (Cody-Waite reduction).  The first two parts have 33
+// significant bits, so their products with any n below 2^20 are exact.
+const double pi_over_2_part_1 = 1.57079632673412561417e+00;
+const double pi_over_2_part_2 = 6.07710050630396597660e-11;
+const double pi_over_2_part_3 = 2.02226624871116645580e-21;
+const double two_over_pi = 6.36619772367581382433e-01;
+const double cody_waite_limit = 1647099.0;  // 2^20 * pi / 2
+
+// ln(2) split the same way; the first part has 32 significant bits.
+const double ln2_part_1 = 6.93147180369123816490e-01;
+const double ln2_part_2 = 1.90821492927058770002e-10;
+
+// Horner evaluation of sum(coefficients[i] * t^i).
+inline double short_horner(const vector<double>& coefficients, double t) {
+    double result = 0;
+    for (size_t i = coefficients.size(); i-- > 0;) {
+        result = result * t + coefficients[i];
+    }
+    return result;
+}
+
+// The reduced-range kernels are polynomials in r^2 built from the cached series tables:
+// sin(r) = r * S(r^2) and cos(r) = C(r^2) for |r| <= pi / 4, e^r = E(r) for |r| <= ln(2) / 2, and
+// ln(m) = 2s * L(s^2) with s = (m - 1) / (m + 1) for sqrt(1/2) <= m < sqrt(2).
+struct ReducedKernels {
+    vector<double> sine;
+    vector<double> cosine;
+    vector<double> euler;
+    vector<double> ln;
+
+    ReducedKernels() {
+        vector<double> sine_series = series_coefficients(SeriesTable::sine, 20);
+        vector<double> cosine_series = series_coefficients(SeriesTable::cosine, 20);
+        for (size_t i = 1; i < sine_series.size(); i += 2) {
+            sine.push_back(sine_series[i]);
+        }
+        for (size_t i = 0; i < cosine_series.size(); i += 2) {
+            cosine.push_back(cosine_series[i]);
+        }
+        euler = series_coefficients(SeriesTable::euler, 15);
+        for (int k = 0; k < 12; k++) {
+            ln.push_back(1.0 / double(2 * k + 1));
+        }
+    }
+};
+
+const ReducedKernels& reduced_kernels() {
+    static const ReducedKernels kernels;
+    return kernels;
+}
+
+double sine_or_cosine(double x, bool cosine) {
+    if (!isfinite(x)) {
+        return numeric_limits<double>::quiet_NaN();
+    }
+    if (fabs(x) >= cody_waite_limit) {
+        // Huge arguments need a multi-word reduction (Payne-Hanek), which the C library provides.
+        return cosine ? cos(x) : sin(x);
+    }
+
+    double n = nearbyint(x * two_over_pi);
+    double r = ((x - n * pi_over_2_part_1) - n * pi_over_2_part_2) - n * pi_over_2_part_3;
+
+    // sin(x) cycles through sin(r), cos(r), -sin(r), -cos(r) as the quadrant n grows; cos(x) is
+    // one quadrant ahead of sin(x).
+    long quadrant = (long(n) + (cosine ? 1 : 0)) & 3;
+    const ReducedKernels& kernels = reduced_kernels();
+    double r2 = r * r;
+    double value = quadrant % 2 == 0 ? r * short_horner(kernels.sine, r2) : short_horner(kernels.cosine, r2);
+    return quadrant >= 2 ? -value : value;
+}
+
+double euler(double x) {
+    if (isnan(x)) {
+        return x;
+    }
+    if (x > 709.782712893384) {
+        return numeric_limits<double>::infinity();
+    }
+    if (x < -745.1332191019412) {
+        return 0;
+    }
+
+    // e^x = 2^k * e^r with x = k * ln(2) + r.
+    double k = nearbyint(x / (ln2_part_1 + ln2_part_2));
+    double r = (x - k * ln2_part_1) - k * ln2_part_2;
+    return ldexp(short_horner(reduced_kernels().euler, r), int(k));
+}
+
+double natural_log(double x) {
+    if (isnan(x) || x < 0) {
+        return numeric_limits<double>::quiet_NaN();
+    }
+    if (x == 0) {
+        return -numeric_limits<double>::infinity();
+    }
+    if (isinf(x)) {
+        return x;
+    }
+
+    // ln(x) = e * ln(2) + ln(m) with x = m * 2^e and m kept close to 1.
+    int exponent = 0;
+    double mantissa = frexp(x, &exponent);
+    if (mantissa < 0.70710678118654752440) {
+        mantissa *= 2;
+        exponent--;
+    }
+    double s = (mantissa - 1) / (mantissa + 1);
+    double log_mantissa = 2 * s * short_horner(reduced_kernels().ln, s * s);
+    return exponent * ln2_part_1 + (exponent * ln2_part_2 + log_mantissa);
+}
+
+} // namespace
+
+
+vector<double> series_coefficients(SeriesTable table, size_t terms) {
+    CachedSeries& series = series_cache[int(table)];
+
+    {
+        shared_lock<shared_mutex> reader(series_lock);
+        if (series.complete || series.coefficients.size() >= terms) {
+            return copy_prefix(series, terms);
+        }
+    }
+
+    // The table is at least doubled when it grows so that slowly increasing requests stay cheap.
+    unique_lock<shared_mutex> writer(series_lock);
+    if (!series.complete && series.coefficients.size() < terms) {
+        build_series(table, max(terms, 2 * series.coefficients.size()), series);
+    }
+    return copy_prefix(series, terms);
+}
+
+double series_evaluate(SeriesTable table, double x) {
+    switch (table) {
+        case SeriesTable::sine:
+            return sine_or_cosine(x, false);
+        case SeriesTable::cosine:
+            return sine_or_cosine(x, true);
+        case SeriesTable::euler:
+            return euler(x);
+        case SeriesTable::ln:
+            return natural_log(x);
+    }
+    return numeric_limits<double>::quiet_NaN();
+}
+
+} // namespace polynomialc_internal
@@ -0,0 +1,596 @@
+//
+// The sparse polynomial representation: sorted (exponent, coefficient) terms, with sparse Horner
+// evaluation and a heap-merge product that hands dense operands to the multiplication engine.
+//
+
+#include "SparsePolynomial.h"
+#include "Kernels.h"
+
+#include <algorithm>
+#include <stdexcept>
+using namespace std;
+
+namespace {
+
+// ===== HELPER FUNCTIONS =====
+
+double integer_power(double t, size_t exponent) {
+    // Exponentiation by squaring, so a gap of k exponents costs about 2 * log2(k) products.
+    double result = 1;
+    while (exponent > 0) {
+        if (exponent & 1) {
+            result *= t;
+        }
+        exponent >>= 1;
+        t *= t;
+    }
+    return result;
+}
+
+vector<SparseTerm> merge_terms(span<const SparseTerm> first, span<const SparseTerm> second, double sign) {
+    // Both lists are sorted, so the sum is a single merge; cancelled terms are dropped.
+    vector<SparseTerm> merged;
+    merged.reserve(first.size() + second.size());
+    size_t i = 0, j = 0;
+    while (i < first.size() || j < second.size()) {
+        if (j == second.size() || (i < first.size() && first[i].exponent < second[j].exponent)) {
+            merged.push_back(first[i++]);
+        } else if (i == first.size() || second[j].exponent < first[i].exponent) {
+            merged.push_back({second[j].exponent, sign * second[j].coefficient});
+            j++;
+        } else {
+            double sum = first[i].coefficient + sign * second[j].coefficient;
+            if (sum != 0) {
+                merged.push_back({first[i].exponent, sum});
+            }
+            i++;
+            j++;
+        }
+    }
+    return merged;
+}
+
+vector<SparseTerm> heap_product(span<const SparseTerm> first, span<const SparseTerm> second) {
+    // Johnson's heap merge: the heap holds the next unmerged product of every term of the shorter
+    // operand, so the products come out in exponent order and equal exponents are summed as they
+    // appear.  It takes O(n * m * log(min(n, m))) steps and O(min(n, m)) extra memory.
+    if (first.size() > second.size()) {
+        swap(first, second);
+    }
+    struct Entry {
+        size_t exponent;
+        size_t i;
+        size_t j;
+    };
+    auto later = [](const Entry& x, const Entry& y) { return x.exponent > y.exponent; };
+
+    vector<Entry> heap;
+    heap.reserve(first.size());
+    for (size_t i = 0; i < first.size(); i++) {
+        heap.push_back({first[i].exponent + second[0].exponent, i, 0});
+    }
+    make_heap(heap.begin(), heap.end(), later);
+
+    vector<SparseTerm> product;
+    while (!heap.empty()) {
+        pop_heap(heap.begin(), heap.end(), later);
+        Entry entry = heap.back();
+        heap.pop_back();
+
+        double value = first[entry.i].coefficient * second[entry.j].coefficient;
+        if (!product.empty() && product.back().exponent == entry.exponent) {
+            product.back().coefficient += value;
+        } else {
+            if (!product.empty() && product.back().coefficient == 0) {
+                product.pop_back();
+            }
+            product.push_back({entry.exponent, value});
+        }
+
+        if (entry.j + 1 < second.size()) {
+            heap.push_back({first[entry.i].exponent + second[entry.j + 1].exponent, entry.i, entry.j + 1});
+            push_heap(heap.begin(), heap.end(), later);
+        }
+    }
+    if (!product.empty() && product.back().coefficient == 0) {
+        product.pop_back();
+    }
+    return product;
+}
+
+vector<SparseTerm> dense_product(span<const SparseTerm> first, span<const SparseTerm> second) {
+    // Both operands are spread into dense lists and multiplied by the multiplication engine.
+    vector<double> dense_first(first.back().exponent + 1, 0.0);
+    vector<double> dense_second(second.back().exponent + 1, 0.0);
+    for (const SparseTerm& term : first) {
+        dense_first[term.exponent] = term.coefficient;
+    }
+    for (const SparseTerm& term : second) {
+        dense_second[term.exponent] = term.coefficient;
+    }
+    vector<double> product(dense_first.size() + dense_second.size() - 1);
+    polynomialc_internal::multiply(dense_first.data(), dense_first.size(), dense_second.data(),
+                                   dense_second.size(), product.data());
+
+    vector<SparseTerm> terms;
+    for (size_t i = 0; i < product.size(); i++) {
+        if (product[i] != 0) {
+            terms.push_back({i, product[i]});
+        }
+    }
+    return terms;
+}
+
+// Dense products are only used up to this length, so a product of two huge-degree polynomials never
+// allocates a huge dense list.
+const size_t max_dense_product = size_t(1) << 24;
+
+} // namespace
+
+void SparsePolynomial::normalize() {
+    // The terms are sorted by exponent, terms with the same exponent are added, and zeros are dropped.
+    stable_sort(term_list.begin(), term_list.end(),
+                [](const SparseTerm& x, const SparseTerm& y) { return x.exponent < y.exponent; });
+    vector<SparseTerm> merged;
+    merged.reserve(term_list.size());
+    for (const SparseTerm& term : term_list) {
+        if (!merged.empty() && merged.back().exponent == term.exponent) {
+            merged.back().coefficient += term.coefficient;
+        } else {
+            if (!merged.empty() && merged.back().coefficient == 0) {
+                merged.pop_back();
+            }
+            merged.push_back(term);
+        }
+    }
+    if (!merged.empty() && merged.back().coefficient == 0) {
+        merged.pop_back();
+    }
+    term_list = std::move(merged);
+}
+
+
+
+// ===== CLASS CONSTRUCTORS =====
+
+
+/* Default Constructor
+ *
+ * The default constructor creates the zero polynomial, which has no terms.
+ */
+SparsePolynomial::SparsePolynomial() {
+    a = 0;
+}
+
+
+/* Term Constructor
+ *
+ * Creates a polynomial from a list of terms in any order.  Terms with the same exponent are added
+ * together, and terms with a coefficient of 0 are dropped.
+ *
+ * Parameters: The terms of the polynomial (Vector of SparseTerms), the value of a.  (Double)
+ */
+SparsePolynomial::SparsePolynomial(vector<SparseTerm> set_term_list, double set_a) {
+    term_list = std::move(set_term_list);
+    a = set_a;
+    normalize();
+}
+
+
+/* Dense Constructor
+ *
+ * Creates a sparse polynomial with the nonzero terms of a dense polynomial.
+ *
+ * Parameters: The dense polynomial.  (Polynomial)
+ */
+SparsePolynomial::SparsePolynomial(const Polynomial& polynomial) {
+    span<const double> coefficients = polynomial.coefficients();
+    for (size_t i = 0; i < coefficients.size(); i++) {
+        if (coefficients[i] != 0) {
+            term_list.push_back({i, coefficients[i]});
+        }
+    }
+    a = polynomial.get_a();
+}
+
+
+/* To Polynomial
+ *
+ * Converts the polynomial to the dense representation, which stores degree() + 1 coefficients.
+ *
+ * Parameters: None.
+ * Returns: The dense polynomial.  (Polynomial)
+ */
+Polynomial SparsePolynomial::to_polynomial() const {
+    vector<double> coefficients(term_list.empty() ? 1 : term_list.back().exponent + 1, 0.0);
+    for (const SparseTerm& term : term_list) {
+        coefficients[term.exponent] = term.coefficient;
+    }
+    return Polynomial(std::move(coefficients), a);
+}
+
+
+
+
+
+// ===== CLASS GETTERS & SETTERS =====
+
+
+/* Terms
+ *
+ * Returns a read-only view of the terms, sorted by increasing exponent.
+ *
+ * Parameters: None.
+ * Returns: The nonzero terms of the polynomial.  (Span of SparseTerms)
+ */
+span<const SparseTerm> SparsePolynomial::terms() const {
+    return term_list;
+}
+
+
+/* Get a
+ *
+ * Returns the value of a for the polynomial.  [c * (x - a)^b]
+ *
+ * Parameters: None.
+ * Returns: The current value of a.  (Double)
+ */
+double SparsePolynomial::get_a() const {
+    return a;
+}
+
+
+/* Set a
+ *
+ * Sets the value of a of the polynomial to something else.  [c * (x - a)^b]
+ *
+ * Parameters: The new value of a to replace the old.  (Double)
+ * Returns: None.
+ */
+void SparsePolynomial::set_a(double new_a) {
+    a = new_a;
+}
+
+
+/* Degree
+ *
+ * Returns the highest exponent of the polynomial (0 for the zero polynomial).
+ *
+ * Parameters: None.
+ * Returns: The degree of the polynomial.  (Size)
+ */
+size_t SparsePolynomial::degree() const {
+    return term_list.empty() ? 0 : term_list.back().exponent;
+}
+
+
+/* Fill Ratio
+ *
+ * Returns the share of the degree() + 1 possible terms that are nonzero (0 for the zero polynomial).
+ * Products use it to choose between the sparse and the dense algorithms.
+ *
+ * Parameters: None.
+ * Returns: The number of terms divided by degree() + 1.  (Double)
+ */
+double SparsePolynomial::fill_ratio() const {
+    if (term_list.empty()) {
+        return 0;
+    }
+    return double(term_list.size()) / double(degree() + 1);
+}
+
+
+
+
+
+// ===== CLASS FUNCTIONS =====
+
+
+/* Solve
+ *
+ * Solves the polynomial at x with a sparse Horner scheme: the terms are walked from the highest
+ * exponent down, and each gap between two exponents is bridged with one power of (x - a) computed by
+ * repeated squaring.  The cost depends on the number of terms and the logarithm of the gaps, not on
+ * the degree.
+ *
+ * Parameters: The value for x used to solve the polynomial.  (Double)
+ * Returns: The value of the polynomial.  (Double)
+ */
+double SparsePolynomial::solve(double x) const {
+    if (term_list.empty()) {
+        return 0;
+    }
+    const double t = x - a;
+    double result = term_list.back().coefficient;
+    for (size_t k = term_list.size() - 1; k > 0; k--) {
+        size_t gap = term_list[k].exponent - term_list[k - 1].exponent;
+        result = result * integer_power(t, gap) + term_list[k - 1].coefficient;
+    }
+    return result * integer_power(t, term_list.front().exponent);
+}
+
+
+/* Differentiate
+ *
+ * Creates the derivative of the polynomial, term by term.
+ *
+ * Parameters: None.
+ * Returns: The derivative of the current polynomial.  (SparsePolynomial)
+ */
+SparsePolynomial SparsePolynomial::differentiate() const {
+    SparsePolynomial derivative;
+    derivative.a = a;
+    for (const SparseTerm& term : term_list) {
+        if (term.exponent > 0) {
+            derivative.term_list.push_back({term.exponent - 1, term.coefficient * double(term.exponent)});
+        }
+    }
+    return derivative;
+}
+
+
+/* Integrate
+ *
+ * Creates the integral of the polynomial with respect to x, term by term.
+ *
+ * Parameters: The constant value of C.  (Double)
+ * Returns: The integral of the current polynomial.  (SparsePolynomial)
+ */
+SparsePolynomial SparsePolynomial::integrate(double c) const {
+    SparsePolynomial integral;
+    integral.a = a;
+    if (c != 0) {
+        integral.term_list.push_back({0, c});
+    }
+    for (const SparseTerm& term : term_list) {
+        integral.term_list.push_back({term.exponent + 1, term.coefficient / double(term.exponent + 1)});
+    }
+    return integral;
+}
+
+
+/* Power
+ *
+ * Raises the polynomial to a power by repeated squaring.  Every product picks the sparse or the dense
+ * algorithm on its own, so a power that fills in switches to the dense algorithm as it goes.
+ *
+ * Parameters: The power to raise the polynomial.  (Unsigned Integer)
+ * Returns: The raised polynomial.  (SparsePolynomial)
+ */
+SparsePolynomial SparsePolynomial::power(unsigned int x) const {
+    SparsePolynomial result({{0, 1.0}}, a);
+    SparsePolynomial base = *this;
+    while (x > 0) {
+        if (x & 1) {
+            result *= base;
+        }
+        x >>= 1;
+        if (x > 0) {
+            base *= base;
+        }
+    }
+    return result;
+}
+
+
+
+
+
+// ===== CLASS INTERACTIONS WITH OTHER POLYNOMIALS =====
+
+
+/* SparsePolynomial += SparsePolynomial Operation
+ *
+ * Adds the terms of another polynomial with a single merge of the two sorted term lists.
+ *
+ * Parameters: Another polynomial with the same value of a.  (SparsePolynomial)
+ * Returns: This polynomial.  (SparsePolynomial)
+ */
+SparsePolynomial& SparsePolynomial::operator+=(const SparsePolynomial& other) {
+    if (a != other.a) {
+        throw invalid_argument("Polynomial a mismatch.");
+    }
+    term_list = merge_terms(term_list, other.term_list, 1);
+    return *this;
+}
+
+
+/* SparsePolynomial -= SparsePolynomial Operation
+ *
+ * Subtracts the terms of another polynomial with a single merge of the two sorted term lists.
+ *
+ * Parameters: Another polynomial with the same value of a.  (SparsePolynomial)
+ * Returns: This polynomial.  (SparsePolynomial)
+ */
+SparsePolynomial& SparsePolynomial::operator-=(const SparsePolynomial& other) {
+    if (a != other.a) {
+        throw invalid_argument("Polynomial a mismatch.");
+    }
+    term_list = merge_terms(term_list, other.term_list, -1);
+    return *this;
+}
+
+
+/* SparsePolynomial *= SparsePolynomial Operation
+ *
+ * Multiplies by another polynomial.  When the n * m products of the terms are few compared to the
+ * length of the product (the operands are mostly empty), they are merged on a heap in O(n * m *
+ * log(min(n, m))) steps.  Otherwise the operands are spread into dense lists and multiplied by the
+ * dense multiplication engine, which uses Karatsuba or FFT multiplication.
+ *
+ * Parameters: Another polynomial with the same value of a.  (SparsePolynomial)
+ * Returns: This polynomial.  (SparsePolynomial)
+ */
+SparsePolynomial& SparsePolynomial::operator*=(const SparsePolynomial& other) {
+    *this = *this * other;
+    return *this;
+}
+
+
+SparsePolynomial operator*(const SparsePolynomial& left, const SparsePolynomial& right) {
+    if (left.get_a() != right.get_a()) {
+        throw invalid_argument("Polynomial a mismatch.");
+    }
+    span<const SparseTerm> first = left.terms();
+    span<const SparseTerm> second = right.terms();
+    if (first.empty() || second.empty()) {
+        return SparsePolynomial({}, left.get_a());
+    }
+
+    const size_t product_length = first.back().exponent + second.back().exponent + 1;
+    const bool dense = product_length <= max_dense_product &&
+                       first.size() * second.size() > polynomialc_internal::sparse_product_ratio * product_length;
+    return SparsePolynomial(dense ? dense_product(first, second) : heap_product(first, second), left.get_a());
+}
+
+
+
+
+
+// ===== CLASS INTERACTIONS WITH NON-POLYNOMIAL OBJECTS =====
+
+
+/* SparsePolynomial += Constant Operation
+ *
+ * Adds a constant to the x^0 term.
+ *
+ * Parameters: The constant to add.  (Double)
+ * Returns: This polynomial.  (SparsePolynomial)
+ */
+SparsePolynomial& SparsePolynomial::operator+=(const double x) {
+    SparseTerm constant = {0, x};
+    term_list = merge_terms(term_list, span<const SparseTerm>(&constant, 1), 1);
+    return *this;
+}
+
+
+/* SparsePolynomial -= Constant Operation
+ *
+ * Subtracts a constant from the x^0 term.
+ *
+ * Parameters: The constant to subtract.  (Double)
+ * Returns: This polynomial.  (SparsePolynomial)
+ */
+SparsePolynomial& SparsePolynomial::operator-=(const double x) {
+    return *this += -x;
+}
+
+
+/* SparsePolynomial *= Constant Operation
+ *
+ * Multiplies every term by a constant.
+ *
+ * Parameters: The multiplicative constant.  (Double)
+ * Returns: This polynomial.  (SparsePolynomial)
+ */
+SparsePolynomial& SparsePolynomial::operator*=(const double x) {
+    for (SparseTerm& term : term_list) {
+        term.coefficient *= x;
+    }
+    normalize();
+    return *this;
+}
+
+
+/* SparsePolynomial /= Constant Operation
+ *
+ * Divides every term by a constant.
+ *
+ * Parameters: The divisor constant.  (Double)
+ * Returns: This polynomial.  (SparsePolynomial)
+ */
+SparsePolynomial& SparsePolynomial::operator/=(const double x) {
+    for (SparseTerm& term : term_list) {
+        term.coefficient /= x;
+    }
+    normalize();
+    return *this;
+}
+
+
+SparsePolynomial operator+(SparsePolynomial left, const SparsePolynomial& right) {
+    return left += right;
+}
+
+SparsePolynomial operator-(SparsePolynomial left, const SparsePolynomial& right) {
+    return left -= right;
+}
+
+SparsePolynomial operator+(SparsePolynomial polynomial, const double x) {
+    return polynomial += x;
+}
+
+SparsePolynomial operator+(const double x, SparsePolynomial polynomial) {
+    return polynomial += x;
+}
+
+SparsePolynomial operator-(SparsePolynomial polynomial, const double x) {
+    return polynomial -= x;
+}
+
+SparsePolynomial operator-(const double x, SparsePolynomial polynomial) {
+    polynomial *= -1;
+    return polynomial += x;
+}
+
+SparsePolynomial operator*(SparsePolynomial polynomial, const double x) {
+    return polynomial *= x;
+}
+
+SparsePolynomial operator*(const double x, SparsePolynomial polynomial) {
+    return polynomial *= x;
+}
+
+SparsePolynomial operator/(SparsePolynomial polynomial, const double x) {
+    return polynomial /= x;
+}
+
+SparsePolynomial operator-(SparsePolynomial polynomial) {
+    return polynomial *= -1;
+}
+
+
+
+
+
+// ===== MISCELLANEOUS OPERATIONS =====
+
+
+/* Square Bracket Operator
+ *
+ * Returns the coefficient of a given power of x, found by binary search (0 if there is no such term).
+ *
+ * Parameters: The power of x.  (Size)
+ * Returns: The coefficient of that power.  (Double)
+ */
+double SparsePolynomial::operator[](size_t exponent) const {
+    auto term = lower_bound(term_list.begin(), term_list.end(), exponent,
+                            [](const SparseTerm& x, size_t e) { return x.exponent < e; });
+    return term != term_list.end() && term->exponent == exponent ? term->coefficient : 0.0;
+}
+
+
+/* Parentheses Operator
+ *
+ * Solves the polynomial at x, see solve.
+ *
+ * Parameters: The input number, x.  (Double)
+ * Returns: The result of the polynomial.  (Double)
+ */
+double SparsePolynomial::operator()(double x) const {
+    return solve(x);
+}
+
+
+/* Angle Bracket Operator
+ *
+ * Prints the terms from the highest power down, such as x^4000 + 3x^2 + 1, with the same rules as
+ * the simple display of Polynomial (see Polynomial::display).
+ *
+ * Parameters: The output stream (Ostream), the polynomial.  (SparsePolynomial)
+ * Returns: The output stream.  (Ostream)
+ */
+ostream& operator<<(ostream& out, const SparsePolynomial& obj) {
+    polynomialc_internal::write_sparse_terms(out, obj.term_list, obj.a);
+    return out;
+}
@@ -0,0 +1,97 @@
+//
+// A polynomial stored as its nonzero terms only, for polynomials like x^4000 + 3x^2 + 1 whose dense
+// coefficient list would be almost all zeros.  The terms are (exponent, coefficient) pairs sorted by
+// exponent, so the memory and the work of every operation depend on the number of terms, not on the
+// degree.
+//
+// Products pick their algorithm from the fill ratio of the operands: mostly-empty operands are
+// multiplied term by term with a heap merge, and operands that are dense enough go through the dense
+// multiplication engine (Karatsuba or FFT) instead.  A SparsePolynomial converts to and from the dense
+// Polynomial.
+//
+// Unlike Polynomial, a SparsePolynomial only combines with polynomials that have the same value of a
+// (the others throw invalid_argument): rewriting x^4000 around another center fills in all 4001 terms,
+// so such sums and products belong in the dense Polynomial.
+//
+
+#ifndef POLYNOMIALC_SPARSEPOLYNOMIAL_H
+#define POLYNOMIALC_SPARSEPOLYNOMIAL_H
+
+#include "PolynomialC.h"
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+// One term, coefficient * (x - a)^exponent, of a SparsePolynomial.
+struct SparseTerm {
+    size_t exponent;
+    double coefficient;
+};
+
+namespace polynomialc_internal {
+    // Writes the terms (sorted by exponent) to out in the simple display of Polynomial, highest power
+    // first, so both classes print a polynomial the same way.  Defined next to the Polynomial display.
+    void write_sparse_terms(ostream& out, span<const SparseTerm> terms, double a);
+}
+
+class SparsePolynomial {
+    // Sorted by increasing exponent, with no repeated exponents and no zero coefficients.
+    vector<SparseTerm> term_list;
+    double a;
+
+    void normalize();
+
+public:
+    // Class Constructors
+    SparsePolynomial();
+    SparsePolynomial(vector<SparseTerm> set_term_list, double set_a=0);
+    explicit SparsePolynomial(const Polynomial& polynomial);
+    Polynomial to_polynomial() const;
+
+    // Class Getters & Setters
+    span<const SparseTerm> terms() const;
+    double get_a() const;
+    void set_a(double new_a);
+    size_t degree() const;
+    double fill_ratio() const;
+
+    // Class Functions
+    double solve(double x) const;
+    SparsePolynomial differentiate() const;
+    SparsePolynomial integrate(double c=0) const;
+    SparsePolynomial power(unsigned int x) const;
+
+    // Class Interactions with other polynomials
+    SparsePolynomial& operator+=(const SparsePolynomial& other);
+    SparsePolynomial& operator-=(const SparsePolynomial& other);
+    SparsePolynomial& operator*=(const SparsePolynomial& other);
+
+    // Class Interactions with other data types
+    SparsePolynomial& operator+=(double x);
+    SparsePolynomial& operator-=(double x);
+    SparsePolynomial& operator*=(double x);
+    SparsePolynomial& operator/=(double x);
+
+    // Miscellaneous Operations
+    double operator[](size_t exponent) const;
+    double operator()(double x) const;
+    friend ostream& operator<<(ostream& out, const SparsePolynomial& obj);
+};
+
+// Interactions with other polynomials
+SparsePolynomial operator+(SparsePolynomial left, const SparsePolynomial& right);
+SparsePolynomial operator-(SparsePolynomial left, const SparsePolynomial& right);
+SparsePolynomial operator*(const SparsePolynomial& left, const SparsePolynomial& right);
+
+// Interactions with other data types
+SparsePolynomial operator+(SparsePolynomial polynomial, double x);
+SparsePolynomial operator+(double x, SparsePolynomial polynomial);
+SparsePolynomial operator-(SparsePolynomial polynomial, double x);
+SparsePolynomial operator-(double x, SparsePolynomial polynomial);
+SparsePolynomial operator*(SparsePolynomial polynomial, double x);
+SparsePolynomial operator*(double x, SparsePolynomial polynomial);
+SparsePolynomial operator/(SparsePolynomial polynomial, double x);
+SparsePolynomial operator-(SparsePolynomial polynomial);
+
+#endif //POLYNOMIALC_SPARSEPOLYNOMIAL_H
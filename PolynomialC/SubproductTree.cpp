@@ -0,0 +1,329 @@
+//
+// The subproduct tree: products of (x - x_i) built level by level, the remainder tree that evaluates
+// a polynomial at every point, and the bottom-up combination that interpolates samples.
+//
+
+#include "SubproductTree.h"
+#include "Kernels.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+using namespace std;
+
+namespace {
+
+// ===== HELPER FUNCTIONS =====
+
+// Nodes of this level (2^5 = 32 points) and below are not divided further: their remainder is
+// evaluated at their points with Horner's scheme, which is cheaper than the divisions there, and every
+// level skipped is one less source of rounding error.
+const size_t horner_level = 5;
+
+// Levels whose nodes hold fewer coefficients than this in total are handled on one thread.
+const size_t parallel_cutoff = 4096;
+
+// The number of points under node j of level k (whose nodes cover 2^k points each, the last one
+// possibly fewer).
+size_t node_points(size_t n, size_t level, size_t j) {
+    const size_t start = j << level;
+    return min(size_t(1) << level, n - start);
+}
+
+size_t node_count(size_t n, size_t level) {
+    return (n + (size_t(1) << level) - 1) >> level;
+}
+
+void for_each_node(size_t count, size_t work, unsigned int threads, const function<void(size_t, size_t)>& body) {
+    // Calls body on ranges of the nodes of one level, in parallel when the level is wide and heavy
+    // enough.  The nodes of a level are independent, so each range works on its own part of the
+    // output.
+    if (threads > 1 && count > 1 && work >= parallel_cutoff) {
+        polynomialc_internal::ThreadPool::global().parallel_for(count, threads, body);
+    } else {
+        body(0, count);
+    }
+}
+
+} // namespace
+
+
+
+
+
+// ===== CONSTRUCTORS =====
+
+
+/* Subproduct Tree Constructor
+ *
+ * Builds the products of (x - x_i) over every pair, every four, and so on up to all the points.  Level
+ * k of the tree stores its nodes in one array, node j taking the 2^k + 1 coefficients starting at
+ * j * (2^k + 1), so the tree is a handful of allocations whatever the number of points.
+ *
+ * Parameters: The points (Span of doubles), the number of threads used for the wide levels, where 0
+ * uses every hardware thread.  (Unsigned Integer)
+ */
+SubproductTree::SubproductTree(span<const double> points, unsigned int threads)
+        : point_list(points.begin(), points.end()), threads(threads) {
+    const size_t n = point_list.size();
+    if (n == 0) {
+        return;
+    }
+
+    levels.emplace_back(2 * n);
+    for (size_t i = 0; i < n; i++) {
+        levels[0][2 * i] = -point_list[i];
+        levels[0][2 * i + 1] = 1;
+    }
+
+    const unsigned int used = polynomialc_internal::resolve_threads(threads);
+    for (size_t level = 1; node_count(n, level - 1) > 1; level++) {
+        const size_t stride = (size_t(1) << level) + 1;
+        const size_t child_stride = (size_t(1) << (level - 1)) + 1;
+        const size_t count = node_count(n, level);
+        levels.emplace_back(count * stride);
+        const vector<double>& children = levels[level - 1];
+        vector<double>& nodes = levels[level];
+
+        for_each_node(count, nodes.size(), used, [&](size_t begin, size_t end) {
+            for (size_t j = begin; j < end; j++) {
+                const double* left = children.data() + 2 * j * child_stride;
+                const size_t left_points = node_points(n, level - 1, 2 * j);
+                if (2 * j + 1 == node_count(n, level - 1)) {
+                    // An odd node out at the end of a level moves up unchanged.
+                    copy(left, left + left_points + 1, nodes.data() + j * stride);
+                    continue;
+                }
+                const double* right = children.data() + (2 * j + 1) * child_stride;
+                const size_t right_points = node_points(n, level - 1, 2 * j + 1);
+                polynomialc_internal::multiply_fast(left, left_points + 1, right, right_points + 1,
+                                               nodes.data() + j * stride);
+            }
+        });
+    }
+}
+
+
+
+
+
+// ===== CLASS GETTERS =====
+
+
+/* Size
+ *
+ * Returns: The number of points.  (Size)
+ */
+size_t SubproductTree::size() const {
+    return point_list.size();
+}
+
+
+/* Points
+ *
+ * Returns: The points the tree was built on, in their original order.  (Span of doubles)
+ */
+span<const double> SubproductTree::points() const {
+    return point_list;
+}
+
+
+/* Root
+ *
+ * Returns: The coefficients of (x - x_0) ... (x - x_{n-1}), lowest first (size() + 1 of them, or none
+ * without points).  (Span of doubles)
+ */
+span<const double> SubproductTree::root() const {
+    if (levels.empty()) {
+        return {};
+    }
+    return span<const double>(levels.back().data(), point_list.size() + 1);
+}
+
+
+
+
+
+// ===== CLASS FUNCTIONS =====
+
+
+void SubproductTree::evaluate_into(span<const double> coefficients, span<double> out) const {
+    // The remainder tree: p mod M_node is passed down from each node to its children, where it is
+    // reduced again, until the nodes are small enough for Horner's scheme.  The remainder of node j of
+    // level k has at most 2^k coefficients, so a whole level fits in one array of n values, node j
+    // starting at j * 2^k.
+    const size_t n = point_list.size();
+    const size_t top = levels.size() - 1;
+    const size_t bottom = min(top, horner_level);
+
+    vector<double> remainders(n, 0.0);
+    if (coefficients.size() > n) {
+        vector<double> quotient(coefficients.size() - n);
+        polynomialc_internal::divide(coefficients.data(), coefficients.size(), root().data(), n + 1,
+                                     quotient.data(), remainders.data());
+    } else {
+        copy(coefficients.begin(), coefficients.end(), remainders.begin());
+    }
+
+    const unsigned int used = polynomialc_internal::resolve_threads(threads);
+    vector<double> reduced(n);
+    for (size_t level = top; level > bottom; level--) {
+        const size_t width = size_t(1) << level;
+        const size_t child_width = width >> 1;
+        const size_t child_stride = child_width + 1;
+        const vector<double>& children = levels[level - 1];
+
+        for_each_node(node_count(n, level - 1), n, used, [&](size_t begin, size_t end) {
+            vector<double> quotient;
+            for (size_t c = begin; c < end; c++) {
+                const size_t parent_points = node_points(n, level, c / 2);
+                const size_t points = node_points(n, level - 1, c);
+                const double* parent = remainders.data() + (c / 2) * width;
+                double* child = reduced.data() + c * child_width;
+                if (points == parent_points) {
+                    copy(parent, parent + points, child);
+                    continue;
+                }
+                quotient.resize(parent_points - points);
+                polynomialc_internal::divide(parent, parent_points, children.data() + c * child_stride, points + 1,
+                                             quotient.data(), child);
+            }
+        });
+        swap(remainders, reduced);
+    }
+
+    const size_t width = size_t(1) << bottom;
+    for_each_node(node_count(n, bottom), n * width, used, [&](size_t begin, size_t end) {
+        for (size_t j = begin; j < end; j++) {
+            const size_t points = node_points(n, bottom, j);
+            polynomialc_internal::horner_batch(remainders.data() + j * width, points, 0.0,
+                                               point_list.data() + j * width, out.data() + j * width, points);
+        }
+    });
+}
+
+
+/* Evaluate
+ *
+ * Solves a polynomial at every point of the tree with a remainder tree: the polynomial is reduced
+ * modulo the root, then modulo each child, and so on, and the remainder at a node of 32 points or
+ * fewer is solved at those points with Horner's scheme.  With d + 1 coefficients and n points this
+ * takes O(M(n) log n + M(d)) steps, against O(n d) for solve() at every point, so it pays off when the
+ * degree and the number of points are both in the hundreds or more.
+ *
+ * Accuracy: every reduction is a division by a monic product of (x - x_i), and its rounding error
+ * grows with the size of that product's coefficients, which is exponential in the number of points
+ * unless they are all close to 0.  Random points in [-1, 1] lose about half of the digits at 100
+ * points and all of them by 200; points in [-0.01, 0.01] stay within 10^-11 of Horner's scheme up to
+ * 200000 points.
+ *
+ * Parameters: The coefficients of sum(c_i * x^i), lowest first.  (Span of doubles)
+ * Returns: The value of the polynomial at every point, in the order of the points.  (Vector of doubles)
+ */
+vector<double> SubproductTree::evaluate(span<const double> coefficients) const {
+    vector<double> values(point_list.size());
+    if (!point_list.empty()) {
+        evaluate_into(coefficients, values);
+    }
+    return values;
+}
+
+
+/* Evaluate (Polynomial)
+ *
+ * Same as evaluate for the coefficients, for a Polynomial; see Polynomial::evaluate_many.
+ *
+ * Parameters: The polynomial to solve.  (Polynomial)
+ * Returns: The value of the polynomial at every point, in the order of the points.  (Vector of doubles)
+ */
+vector<double> SubproductTree::evaluate(const Polynomial& polynomial) const {
+    return polynomial.evaluate_many(*this);
+}
+
+
+/* Interpolate
+ *
+ * Finds the polynomial of degree below n that takes the given values at the n points of the tree.
+ * Lagrange's formula p(x) = sum(y_i / M'(x_i) * M(x) / (x - x_i)), where M is the root of the tree, is
+ * computed from the bottom up: each node combines its children as P_left * M_right + P_right * M_left.
+ * The values M'(x_i) come from a remainder tree, once per tree, so interpolating many sets of values on
+ * the same points costs one bottom-up pass each.
+ *
+ * Accuracy: the weights y_i / M'(x_i) grow exponentially with the number of points and cancel in the
+ * sums, on top of the ill-conditioning of any interpolation into the coefficients of x^i.  At 16
+ * Chebyshev points in [-1, 1] the coefficients are accurate to about 10^-6, and at 24 they are lost.
+ *
+ * Parameters: The value at every point, in the order of the points.  (Span of doubles)
+ * Returns: The interpolating polynomial, with a = 0.  (Polynomial)
+ */
+Polynomial SubproductTree::interpolate(span<const double> values) const {
+    const size_t n = point_list.size();
+    if (values.size() != n) {
+        throw invalid_argument("SubproductTree value count mismatch.");
+    }
+    if (n == 0) {
+        return Polynomial({0}, 0);
+    }
+
+    call_once(root_derivative_once, [this, n]() {
+        span<const double> product = root();
+        vector<double> derivative(n);
+        for (size_t i = 1; i <= n; i++) {
+            derivative[i - 1] = product[i] * double(i);
+        }
+        root_derivative.resize(n);
+        evaluate_into(derivative, root_derivative);
+    });
+
+    // Level 0: the constant y_i / M'(x_i) under every point.  Node j of level k then holds a
+    // polynomial with up to 2^k coefficients, starting at j * 2^k like the remainders.
+    vector<double> combined(n);
+    for (size_t i = 0; i < n; i++) {
+        if (root_derivative[i] == 0) {
+            throw invalid_argument("SubproductTree points must be distinct to interpolate.");
+        }
+        combined[i] = values[i] / root_derivative[i];
+    }
+
+    const unsigned int used = polynomialc_internal::resolve_threads(threads);
+    vector<double> next(n);
+    for (size_t level = 1; level < levels.size(); level++) {
+        const size_t width = size_t(1) << level;
+        const size_t child_width = width >> 1;
+        const size_t child_stride = child_width + 1;
+        const vector<double>& children = levels[level - 1];
+
+        for_each_node(node_count(n, level), n, used, [&](size_t begin, size_t end) {
+            vector<double> product;
+            for (size_t j = begin; j < end; j++) {
+                const size_t points = node_points(n, level, j);
+                const size_t left_points = node_points(n, level - 1, 2 * j);
+                double* out = next.data() + j * width;
+                const double* left = combined.data() + 2 * j * child_width;
+                if (points == left_points) {
+                    copy(left, left + points, out);
+                    continue;
+                }
+                const size_t right_points = points - left_points;
+                const double* right = left + child_width;
+                const double* left_product = children.data() + 2 * j * child_stride;
+                const double* right_product = left_product + child_stride;
+
+                // Both products have exactly points coefficients.
+                polynomialc_internal::multiply_fast(left, left_points, right_product, right_points + 1, out);
+                product.resize(points);
+                polynomialc_internal::multiply_fast(right, right_points, left_product, left_points + 1, product.data());
+                for (size_t i = 0; i < points; i++) {
+                    out[i] += product[i];
+                }
+            }
+        });
+        swap(combined, next);
+    }
+
+    while (combined.size() > 1 && combined.back() == 0) {
+        combined.pop_back();
+    }
+    return Polynomial(std::move(combined), 0);
+}
@@ -0,0 +1,58 @@
+//
+// A subproduct tree over a set of points x_0, ..., x_{n-1}: the leaves are the polynomials (x - x_i),
+// and every node is the product of its two children, up to the root (x - x_0) ... (x - x_{n-1}).
+// With it a polynomial is evaluated at all n points with a remainder tree, and a polynomial is rebuilt
+// from n samples, in O(M(n) log n) steps each (M(n) being the cost of a product), instead of the
+// O(n^2) of a solve() per point or Lagrange's formula.
+//
+// Building the tree is the expensive part, so a tree can be built once and reused for any number of
+// polynomials.  Wide levels of the tree are built and walked on several threads.
+//
+// Accuracy: the remainders are exact in exact arithmetic, but in floating point their error grows with
+// the size of the subproduct coefficients, which is exponential in the number of points unless the
+// points are all close to 0.  See SubproductTree::evaluate for measured limits.
+//
+
+#ifndef POLYNOMIALC_SUBPRODUCTTREE_H
+#define POLYNOMIALC_SUBPRODUCTTREE_H
+
+#include "PolynomialC.h"
+
+#include <cstddef>
+#include <mutex>
+#include <span>
+#include <vector>
+
+class SubproductTree {
+    vector<double> point_list;
+    unsigned int threads;
+
+    // levels[k] holds the products of (x - x_i) over the points j * 2^k <= i < (j + 1) * 2^k, node j
+    // taking the coefficients from j * (2^k + 1); levels.back() holds the root.
+    vector<vector<double>> levels;
+
+    // M'(x_i) for interpolation, where M is the root; computed by the first interpolate() call.
+    mutable vector<double> root_derivative;
+    mutable once_flag root_derivative_once;
+
+    void evaluate_into(span<const double> coefficients, span<double> out) const;
+
+public:
+    // threads is the number of threads for the wide levels of the tree (0 = all).
+    explicit SubproductTree(span<const double> points, unsigned int threads=0);
+
+    size_t size() const;
+    span<const double> points() const;
+    span<const double> root() const;
+
+    // The values of the polynomial at every point, in the order of the points.  The coefficients are
+    // those of sum(c_i * x^i).
+    vector<double> evaluate(span<const double> coefficients) const;
+    vector<double> evaluate(const Polynomial& polynomial) const;
+
+    // The polynomial of degree below size() that takes the given value at every point.  The points
+    // have to be distinct.
+    Polynomial interpolate(span<const double> values) const;
+};
+
+#endif //POLYNOMIALC_SUBPRODUCTTREE_H
@@ -0,0 +1,852 @@
+//
+// polynomialc_tests: round-trip checks of the numerical paths (run by ctest).  Every check compares
+// two ways of computing the same thing, within an error bound of the algorithm, and prints the cases
+// that fail; the exit status is 1 if any did.
+//
+//     ctest --test-dir build --output-on-failure
+//
+
+#include "BasicPolynomial.h"
+#include "ChebyshevPolynomial.h"
+#include "FixedPolynomial.h"
+#include "GridEvaluator.h"
+#include "Instrumentation.h"
+#include "PolynomialC.h"
+#include "PolynomialExpression.h"
+#include "PolynomialMemory.h"
+#include "PolynomialStore.h"
+#include "SparsePolynomial.h"
+#include "SubproductTree.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <cmath>
+#include <complex>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <limits>
+#include <numbers>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+using namespace std;
+
+namespace {
+
+// ===== HELPERS =====
+
+int failures = 0;
+
+void check(bool passed, const string& name) {
+    if (!passed) {
+        printf("FAILED: %s\n", name.c_str());
+        failures++;
+    }
+}
+
+vector<double> random_coefficients(size_t n, unsigned int seed) {
+    // Fixed seeds, so every run checks the same polynomials.
+    mt19937_64 generator(seed);
+    uniform_real_distribution<double> distribution(-1.0, 1.0);
+    vector<double> coefficients(n);
+    for (double& coefficient : coefficients) {
+        coefficient = distribution(generator);
+    }
+    return coefficients;
+}
+
+double norm(span<const double> coefficients) {
+    double sum = 0;
+    for (double coefficient : coefficients) {
+        sum += coefficient * coefficient;
+    }
+    return sqrt(sum);
+}
+
+// max() that keeps a NaN, so that no check passes on one.
+double larger(double largest, double value) {
+    return value <= largest ? largest : value;
+}
+
+// The largest difference between two coefficient lists, the shorter one padded with zeros.
+double difference(span<const double> first, span<const double> second) {
+    double largest = 0;
+    for (size_t i = 0; i < max(first.size(), second.size()); i++) {
+        const double x = i < first.size() ? first[i] : 0.0;
+        const double y = i < second.size() ? second[i] : 0.0;
+        largest = larger(largest, fabs(x - y));
+    }
+    return largest;
+}
+
+// The largest difference between two polynomials at points spread over [low, high].
+double value_difference(const Polynomial& first, const Polynomial& second, double low, double high) {
+    double largest = 0;
+    for (int k = 0; k <= 64; k++) {
+        const double x = low + (high - low) * k / 64;
+        largest = larger(largest, fabs(first(x) - second(x)));
+    }
+    return largest;
+}
+
+vector<double> schoolbook(span<const double> a, span<const double> b) {
+    vector<double> product(a.size() + b.size() - 1);
+    for (size_t i = 0; i < a.size(); i++) {
+        for (size_t j = 0; j < b.size(); j++) {
+            product[i + j] += a[i] * b[j];
+        }
+    }
+    return product;
+}
+
+
+// ===== CHECKS =====
+
+void multiply_and_divide() {
+    // Karatsuba and FFT sizes against the schoolbook product, within the normwise bound of operator*,
+    // then the product plus a remainder divided back.  The divisor's leading coefficient outweighs the
+    // others, so its roots lie inside the unit circle and the division is well conditioned.
+    for (size_t n : {40, 300, 3000}) {
+        const vector<double> p = random_coefficients(n, 1);
+        vector<double> q = random_coefficients(n / 2 + 1, 2);
+        double others = 0;
+        for (size_t i = 0; i + 1 < q.size(); i++) {
+            others += fabs(q[i]);
+        }
+        q.back() = 2 * others;
+        const Polynomial product = Polynomial(p, 0) * Polynomial(q, 0);
+        const double bound = 4 * log2(double(n + q.size())) * 0x1p-53 * norm(p) * norm(q);
+        check(difference(product.coefficients(), schoolbook(p, q)) <= bound, "multiply " + to_string(n));
+
+        const Polynomial remainder(random_coefficients(q.size() - 1, 3), 0);
+        const DivisionResult division = (product + remainder).divmod(Polynomial(q, 0));
+        check(difference(division.quotient.coefficients(), p) <= 1e-8, "divmod quotient " + to_string(n));
+        check(difference(division.remainder.coefficients(), remainder.coefficients()) <= 1e-8,
+              "divmod remainder " + to_string(n));
+    }
+
+    // One tiny coefficient among ordinary ones keeps the fast product and its bound.
+    vector<double> p = random_coefficients(2000, 4);
+    p[1000] = 1e-7;
+    const Polynomial square = Polynomial(p, 0) * Polynomial(p, 0);
+    const double bound = 4 * log2(4000.0) * 0x1p-53 * norm(p) * norm(p);
+    check(difference(square.coefficients(), schoolbook(p, p)) <= bound, "multiply with a small coefficient");
+
+    // The keyword series stay accurate term by term.
+    const Polynomial exp_square = Polynomial("euler") * Polynomial("euler");
+    double worst = 0;
+    for (size_t k = 0; k < 150; k++) {
+        const double expected = exp(double(k) * log(2.0) - lgamma(double(k) + 1));
+        worst = larger(worst, fabs(exp_square[int(k)] - expected) / expected);
+    }
+    check(worst <= 1e-12, "e^x * e^x term by term");
+}
+
+void common_divisors() {
+    // (x - 1)(x^2 + 1) shared by two quartics, in either order and after a factor of degree 8.
+    const Polynomial common = Polynomial({-1, 1}, 0) * Polynomial({1, 0, 1}, 0);
+    const Polynomial f = common * Polynomial({2, 1}, 0);
+    const Polynomial g = common * Polynomial({-3, 1}, 0);
+    check(difference(f.gcd(g).coefficients(), common.coefficients()) <= 1e-12 &&
+          difference(g.gcd(f).coefficients(), common.coefficients()) <= 1e-12, "gcd of two quartics");
+    const Polynomial longer = f * Polynomial(random_coefficients(9, 22), 0);
+    check(difference(longer.gcd(g).coefficients(), common.coefficients()) <= 1e-10, "gcd after a long factor");
+    check(Polynomial({2, 1}, 0).gcd(Polynomial({-3, 1}, 0)).get_coefficients() == vector<double>({1}),
+          "gcd of coprime polynomials");
+    check(difference(f.gcd(Polynomial()).coefficients(), f.coefficients()) == 0, "gcd with 0");
+
+    // The repeated roots of a polynomial are the roots of its gcd with its derivative.
+    Polynomial repeated({-1, 1}, 0);
+    for (int k = 2; k <= 6; k++) {
+        repeated *= Polynomial({-k / 3.0, 1}, 0);
+    }
+    check(difference(repeated.gcd(repeated.differentiate()).coefficients(), vector<double>({-1, 1})) <= 1e-10,
+          "gcd with the derivative");
+}
+
+void powers() {
+    // Binary exponentiation against repeated products, exactly for small integer coefficients.
+    const Polynomial base({1, -2, 1, 3}, 0.5);
+    Polynomial repeated({1}, 0.5);
+    for (unsigned int n = 0; n <= 13; n++) {
+        check(difference(base.power(n).coefficients(), repeated.coefficients()) == 0 &&
+              base.power(n).get_a() == 0.5, "power " + to_string(n));
+        repeated *= base;
+    }
+
+    // The truncated power keeps the first terms of the full one.
+    const Polynomial p(random_coefficients(20, 14), 0);
+    const Polynomial full = p.power(9);
+    for (unsigned int max_degree : {0u, 5u, 40u, 400u}) {
+        const Polynomial truncated = p.power(9, max_degree);
+        const span<const double> kept =
+            full.coefficients().first(min<size_t>(max_degree + 1, full.coefficients().size()));
+        check(truncated.coefficients().size() <= max_degree + 1 &&
+              difference(truncated.coefficients(), kept) <= 1e-12 * norm(full.coefficients()),
+              "truncated power to degree " + to_string(max_degree));
+    }
+}
+
+void series_tables() {
+    // Threads that grow the same table at once (cosine is not used before) all get the same
+    // coefficients, and a shorter series is the start of a longer one.
+    vector<vector<double>> built(8);
+    vector<thread> threads;
+    for (size_t t = 0; t < built.size(); t++) {
+        threads.emplace_back([&built, t]() {
+            built[t] = (t % 2 == 0 ? Polynomial("cosine") : Polynomial::series("cosine", 700)).get_coefficients();
+        });
+    }
+    for (thread& worker : threads) {
+        worker.join();
+    }
+    const vector<double> cosine = Polynomial("cosine").get_coefficients();
+    bool same = true;
+    for (size_t t = 0; t < built.size(); t++) {
+        const size_t length = t % 2 == 0 ? cosine.size() : min<size_t>(cosine.size(), 700);
+        same = same && built[t].size() == length &&
+               difference(built[t], span<const double>(cosine).first(length)) == 0;
+    }
+    check(same, "series built on several threads");
+    check(difference(Polynomial::series("cosine", 10).coefficients(), span<const double>(cosine).first(10)) == 0,
+          "short series against long");
+
+    // The shared tables hold the Taylor coefficients.
+    const Polynomial sine("sine");
+    const Polynomial euler("euler");
+    const Polynomial ln("ln");
+    double worst = 0;
+    for (int k = 0; k < 80; k++) {
+        const double factorial = exp(lgamma(double(k) + 1));
+        worst = larger(worst, fabs(euler[k] * factorial - 1));
+        worst = larger(worst, k % 2 == 0 ? fabs(sine[k]) : fabs(sine[k] * factorial - (k % 4 == 1 ? 1 : -1)));
+        worst = larger(worst, k == 0 ? fabs(ln[k]) : fabs(ln[k] * k - (k % 2 == 1 ? 1 : -1)));
+    }
+    check(worst <= 1e-12 && ln.get_a() == 1, "series coefficients");
+}
+
+void recenter_and_compose() {
+    const Polynomial p(random_coefficients(30, 5), 0);
+    const Polynomial moved = p.recenter(0.3);
+    check(value_difference(moved, p, -1, 1) <= 1e-10, "recenter keeps the values");
+    check(difference(moved.recenter(0).coefficients(), p.coefficients()) <= 1e-12, "recenter and back");
+
+    // Mixed centers are recentered by the operators.
+    const Polynomial q(random_coefficients(10, 6), -0.25);
+    check(value_difference(p + q, Polynomial(p.get_coefficients(), 0) + q.recenter(0), -1, 1) <= 1e-12,
+          "sum of mixed centers");
+
+    // The longer operand keeps its center, so a short polynomial combines with the ln series (written
+    // around 1, divergent around 0) in either order.
+    const Polynomial line({1, 2}, 0);
+    const Polynomial ln("ln");
+    const double x = 1.5;
+    const double sum = 4 + log(x);
+    const double product = 4 * log(x);
+    Polynomial accumulated = line;
+    accumulated += ln;
+    check(fabs((line + ln)(x) - sum) <= 1e-12 && fabs((ln + line)(x) - sum) <= 1e-12 &&
+          fabs(accumulated(x) - sum) <= 1e-12, "sum with ln in both orders");
+    check(fabs((line - ln)(x) - (4 - log(x))) <= 1e-12 && fabs((ln - line)(x) - (log(x) - 4)) <= 1e-12,
+          "difference with ln in both orders");
+    check(fabs((line * ln)(x) - product) <= 1e-12 && fabs((ln * line)(x) - product) <= 1e-12,
+          "product with ln in both orders");
+    check(fabs(Polynomial(lazy(line) + lazy(ln))(x) - sum) <= 1e-12 &&
+          fabs(Polynomial(lazy(line) * lazy(ln))(x) - product) <= 1e-12, "lazy arithmetic with ln");
+    const DivisionResult division = (line * ln).divmod(line);
+    check(fabs(division.quotient(x) - log(x)) <= 1e-12 && fabs(line.divmod(ln).remainder(x) - 4) <= 1e-12,
+          "division with ln in both orders");
+
+    // BasicPolynomial and FixedPolynomial center mixed operands the same way.
+    const PolynomialLD wide_line(line);
+    const PolynomialLD wide_ln(Polynomial::series("ln", 60));
+    check(fabs(double((wide_line + wide_ln)(1.5L)) - sum) <= 1e-12 &&
+          fabs(double((wide_ln * wide_line)(1.5L)) - product) <= 1e-12, "BasicPolynomial with mixed centers");
+    constexpr FixedPolynomial<1> fixed_line({1, 2});
+    constexpr FixedPolynomial<2> fixed_square({0, 0, 1}, 1);
+    check((fixed_line + fixed_square).solve(3) == 11 && (fixed_square - fixed_line).solve(3) == -3 &&
+          (fixed_line * fixed_square).solve(3) == 28 && (fixed_square * fixed_line).get_a() == 1,
+          "FixedPolynomial with mixed centers");
+
+    // p(q(x)) against Horner's scheme on the values of q.
+    const Polynomial outer(random_coefficients(40, 7), 0);
+    const Polynomial inner(random_coefficients(6, 8), 0);
+    const Polynomial composed = outer.compose(inner);
+    double worst = 0;
+    for (int k = 0; k <= 64; k++) {
+        const double x = -0.5 + k / 64.0;
+        worst = larger(worst, fabs(composed(x) - outer(inner(x))) / max(1.0, fabs(outer(inner(x)))));
+    }
+    check(worst <= 1e-9, "compose against p(q(x))");
+
+    // A power series reverted and composed back is the identity up to the kept degree.
+    const Polynomial f({0, 1, 0.5, 0.25}, 0);
+    const Polynomial inverse = f.compositional_inverse(12);
+    const Polynomial identity = f.compose(inverse, 12);
+    check(difference(identity.coefficients(), vector<double>{0, 1}) <= 1e-12, "compositional inverse");
+}
+
+void moves() {
+    // A moved polynomial hands over its coefficients, inline or on the heap, and is left as 0.
+    Polynomial short_one({1, 2, 3}, 0.5);
+    Polynomial long_one(random_coefficients(50, 19), -1);
+    Polynomial sine(string("sine"));
+    const Polynomial short_copy = short_one, long_copy = long_one, sine_copy = sine;
+    const Polynomial short_moved(std::move(short_one));
+    const Polynomial long_moved(std::move(long_one));
+    Polynomial sine_moved;
+    sine_moved = std::move(sine);
+    check(short_moved.get_coefficients() == short_copy.get_coefficients() && short_moved.get_a() == 0.5 &&
+          long_moved.get_coefficients() == long_copy.get_coefficients() && long_moved.get_a() == -1 &&
+          sine_moved(1) == sine_copy(1), "moved polynomials keep their value");
+    check(short_one.coefficients().empty() && long_one.coefficients().empty() && sine.coefficients().empty() &&
+          short_one(1) == 0 && long_one(1) == 0 && sine(1) == 0, "moved-from polynomials are 0");
+
+    // Operands aliasing the result, and temporaries reused by the rvalue operators.
+    Polynomial p({1, 1}, 0);
+    p *= p;
+    p += p;
+    check(p.get_coefficients() == vector<double>({2, 4, 2}), "compound assignment with itself");
+    p -= p;
+    check(p.coefficients().empty(), "subtracting itself");
+    Polynomial q({1, 1}, 0);
+    q = std::move(q) + q;
+    check(q.get_coefficients() == vector<double>({2, 2}), "moved operand aliasing the other one");
+    q = q + q * q - q;
+    check(q.get_coefficients() == vector<double>({4, 8, 4}), "chain of temporaries with aliased operands");
+}
+
+void expressions() {
+    // An expression is computed into a new polynomial before it is assigned, so it can be assigned to
+    // one of its own operands.
+    const Polynomial original(random_coefficients(12, 20), 0);
+    Polynomial p = original;
+    p = lazy(p) * 2.0 + lazy(p) - lazy(p) / 4.0;
+    check(difference(p.coefficients(), (original * 2.75).coefficients()) <= 1e-15, "lazy sum into an operand");
+    p = original;
+    p = lazy(p) * lazy(p) - lazy(p);
+    check(difference(p.coefficients(), (original * original - original).coefficients()) <= 1e-14,
+          "lazy product into an operand");
+    p = original;
+    p = lazy(p) - lazy(p);
+    check(p.coefficients().empty(), "lazy difference with itself");
+
+    // The same operand around two centers: the shorter one is rewritten, the operand itself is not.
+    const Polynomial line({1, 2}, 3);
+    p = original;
+    p = lazy(p) + lazy(line) * 3.0 + lazy(p);
+    check(p.get_a() == 0 && value_difference(p, original * 2.0 + line * 3.0, -1, 1) <= 1e-13 &&
+          line.get_a() == 3 && line.get_coefficients() == vector<double>({1, 2}), "lazy operands left unchanged");
+}
+
+void memory() {
+    // Short lists stay inline; a long one allocates once, and a chain of temporaries only allocates
+    // for the product (the sums reuse it).
+    const vector<double> short_list = {1, 2, 3};
+    const vector<double> long_list = random_coefficients(POLYNOMIALC_INLINE_TERMS + 42, 21);
+    CountingResource counting;
+    {
+        PolynomialResourceScope scope(&counting);
+        const Polynomial small(short_list, 0);
+        const Polynomial small_result = small * small + small;
+        check(counting.allocations() == 0, "inline polynomials do not allocate");
+        const Polynomial big(long_list, 0);
+        check(counting.allocations() == 1 && counting.bytes() == long_list.size() * sizeof(double),
+              "one allocation per list");
+        const Polynomial chain = big * big + big - big;
+        check(counting.allocations() == 2, "temporaries reused by a chain");
+    }
+    check(counting.deallocations() == counting.allocations(), "every allocation freed");
+
+    // An arena serves every list from one block, and a result assigned outside it outlives it.
+    const Polynomial x(long_list, 0);
+    const Polynomial expected = (x.differentiate() * x).integrate().power(2);
+    Polynomial result;
+    {
+        PolynomialArena arena;
+        const Polynomial inside(long_list, 0);
+        const Polynomial computed = (inside.differentiate() * inside).integrate().power(2);
+        result = computed;
+        check(arena.requests() >= 4 && arena.heap_allocations() == 1, "arena allocations");
+    }
+    check(result.get_coefficients() == expected.get_coefficients(), "result copied out of the arena");
+}
+
+void fixed() {
+    // Evaluation, products, sums, calculus and recentering all work in constant expressions.
+    constexpr FixedPolynomial<2> p({1, 2, 3});
+    constexpr FixedPolynomial<3> q = p * FixedPolynomial<1>({-1, 1});
+    static_assert(p(2) == 17 && q(2) == 17 && q(1) == 0);
+    static_assert(q.get_coefficients() == array<double, 4>{-1, -1, -1, 3});
+    static_assert(p.differentiate() == FixedPolynomial<1>({2, 6}));
+    static_assert(p.integrate(5).differentiate() == p && p.integrate(5)(0) == 5);
+    static_assert((p + FixedPolynomial<0>({1}))(0) == 2 && (2.0 * p - p) == p && (p * 3.0 / 3.0)(1) == 6);
+    static_assert(p.recenter(1)(3) == p(3) && p.recenter(1).get_a() == 1);
+    static_assert(FixedPolynomial(array<float, 2>{1, 1})(2.0f) == 3.0f);
+
+    // Conversions to and from Polynomial keep the coefficients and a.
+    const Polynomial general = Polynomial(q.recenter(0.5));
+    check(general.get_a() == 0.5 && value_difference(general, Polynomial(q), -2, 2) <= 1e-13,
+          "FixedPolynomial to Polynomial");
+    check(FixedPolynomial<3>(general).get_coefficients() == q.recenter(0.5).get_coefficients(),
+          "Polynomial to FixedPolynomial");
+    bool thrown = false;
+    try {
+        FixedPolynomial<1> too_small(general);
+    } catch (const invalid_argument&) {
+        thrown = true;
+    }
+    check(thrown, "Polynomial too long for a FixedPolynomial");
+}
+
+void evaluation() {
+    const Polynomial p(random_coefficients(50, 9), 0.1);
+    vector<double> xs(1000);
+    for (size_t k = 0; k < xs.size(); k++) {
+        xs[k] = -1 + 2.0 * double(k) / double(xs.size());
+    }
+    vector<double> values(xs.size());
+    p.evaluate(xs, values);
+    double worst = 0;
+    for (size_t k = 0; k < xs.size(); k++) {
+        worst = larger(worst, fabs(values[k] - p.solve(xs[k])));
+    }
+    check(worst <= 1e-12, "evaluate against solve");
+    check(p.evaluate_many(xs, 2) == values, "evaluate_many against evaluate");
+
+    const PolynomialF f(p);
+    vector<float> float_xs(xs.begin(), xs.end());
+    vector<float> float_values(xs.size());
+    f.evaluate(float_xs, float_values);
+    worst = 0;
+    for (size_t k = 0; k < xs.size(); k++) {
+        worst = larger(worst, double(fabs(float_values[k] - f.solve(float_xs[k]))));
+    }
+    check(worst <= 1e-4, "PolynomialF evaluate against solve");
+
+    // A truncated series is an ordinary polynomial; the keyword constructor is the function.
+    check(Polynomial::series("sine", 3).solve(1) == 1, "series solved as written");
+    check(fabs(Polynomial("sine").solve(100) - sin(100.0)) <= 1e-12, "keyword polynomial far from 0");
+
+    // Lazy chains agree with the eager operators, mixed centers included.
+    const Polynomial a({1, 2, 3}, 0);
+    const Polynomial b({4, -1, 0.5}, 1);
+    const Polynomial eager = a * 2.0 + b * a;
+    const Polynomial chained = lazy(a) * 2.0 + lazy(b) * lazy(a);
+    check(value_difference(eager, chained, -2, 2) <= 1e-12, "lazy chain against eager operators");
+}
+
+void interpolation() {
+    // A polynomial of degree 11 rebuilt from its values at 12 Chebyshev points.  The monomial
+    // coefficients are ill conditioned in the points (errors near 1e-9 are measured), so they are only
+    // checked to 1e-8, and the values at the points to 1e-11.
+    const vector<double> coefficients = random_coefficients(12, 23);
+    const Polynomial p(coefficients, 0);
+    vector<double> xs(12), ys(12), other_ys(12);
+    for (size_t i = 0; i < xs.size(); i++) {
+        xs[i] = cos(numbers::pi * double(2 * i + 1) / 24);
+        ys[i] = p(xs[i]);
+        other_ys[i] = 1 - xs[i];
+    }
+    const Polynomial rebuilt = Polynomial::interpolate(xs, ys);
+    double worst = 0;
+    for (size_t i = 0; i < xs.size(); i++) {
+        worst = larger(worst, fabs(rebuilt(xs[i]) - ys[i]));
+    }
+    check(difference(rebuilt.coefficients(), coefficients) <= 1e-8 && worst <= 1e-11, "interpolate");
+
+    // One tree serves several sets of values, and evaluates at its points.
+    const SubproductTree tree(xs);
+    check(tree.interpolate(ys).get_coefficients() == rebuilt.get_coefficients(), "interpolate with a tree");
+    check(difference(tree.interpolate(other_ys).coefficients(), vector<double>({1, -1})) <= 1e-8,
+          "interpolate a line");
+    check(difference(tree.evaluate(p), ys) <= 1e-14, "tree evaluation at the interpolation points");
+
+    // Many points close to 0 keep the remainder tree accurate.
+    const Polynomial long_one(random_coefficients(200, 24), 0);
+    vector<double> many = random_coefficients(1000, 25);
+    for (double& x : many) {
+        x /= 2;
+    }
+    const vector<double> values = SubproductTree(many).evaluate(long_one);
+    worst = 0;
+    for (size_t i = 0; i < many.size(); i++) {
+        worst = larger(worst, fabs(values[i] - long_one(many[i])));
+    }
+    check(worst <= 1e-13, "tree evaluation of 1000 points");
+
+    bool thrown = false;
+    try {
+        Polynomial::interpolate(xs, span<const double>(ys).first(11));
+    } catch (const invalid_argument&) {
+        thrown = true;
+    }
+    check(thrown, "interpolate size mismatch");
+}
+
+void formatting() {
+    // With round_trip, the coefficients written in DisplayMode::all read back to exactly the same doubles.
+    const Polynomial p({0.1, -1.0 / 3, 0, 2e-300, 12345.678901234567, -numeric_limits<double>::denorm_min()}, 0.25);
+    const string text = p.format(DisplayMode::all, true);
+    vector<double> read;
+    for (size_t open = text.find('('); open != string::npos; open = text.find('(', open + 1)) {
+        char* end = nullptr;
+        const double value = strtod(text.c_str() + open + 1, &end);
+        if (end != text.c_str() + open + 1 && strncmp(end, " * ", 3) == 0) {
+            read.push_back(value);
+        }
+    }
+    check(read == p.get_coefficients() && text.find("(x - 0.25)^5") != string::npos, "round trip coefficients");
+
+    // Every target writes the same text: a new string, the end of a string, a buffer and a stream.
+    for (DisplayMode mode : {DisplayMode::all, DisplayMode::reduced, DisplayMode::simple}) {
+        for (bool round_trip : {false, true}) {
+            const string expected = p.format(mode, round_trip);
+            string appended = "p = ";
+            p.format(appended, mode, round_trip);
+            char buffer[512];
+            const to_chars_result written = p.format(buffer, buffer + sizeof(buffer), mode, round_trip);
+            ostringstream out;
+            p.display(out, mode, round_trip);
+            check(appended == "p = " + expected && written.ec == errc() &&
+                  string(buffer, written.ptr) == expected && out.str() == expected + "\n", "format targets agree");
+        }
+    }
+    ostringstream out;
+    out << p;
+    check(out.str() == p.format(), "operator<< writes the simple format");
+
+    // A buffer one character short reports the overflow; an exact one does not.
+    const string expected = p.format(DisplayMode::all, true);
+    vector<char> buffer(expected.size());
+    check(p.format(buffer.data(), buffer.data() + buffer.size() - 1, DisplayMode::all, true).ec ==
+          errc::value_too_large, "format into a short buffer");
+    const to_chars_result exact = p.format(buffer.data(), buffer.data() + buffer.size(), DisplayMode::all, true);
+    check(exact.ec == errc() && string(buffer.data(), exact.ptr) == expected, "format into an exact buffer");
+}
+
+void store() {
+    const vector<Polynomial> polynomials = {Polynomial(random_coefficients(100, 10), 0.5), Polynomial("cosine"),
+                                            Polynomial()};
+    stringstream stream(ios::in | ios::out | ios::binary);
+    write_polynomials(stream, polynomials);
+    const string bytes = stream.str();
+    const vector<Polynomial> read = read_polynomials(stream);
+    check(read.size() == polynomials.size(), "store read count");
+    for (size_t i = 0; i < min(read.size(), polynomials.size()); i++) {
+        check(difference(read[i].coefficients(), polynomials[i].coefficients()) == 0 &&
+              read[i].get_a() == polynomials[i].get_a(), "store read " + to_string(i));
+    }
+
+    const string path = (filesystem::temp_directory_path() / "polynomialc_tests.plyc").string();
+    save_polynomials(path, polynomials);
+    {
+        PolynomialStore mapped(path);
+        check(mapped.size() == polynomials.size(), "store map count");
+        check(mapped[0](0.7) == polynomials[0](0.7) && mapped[1](2.0) == polynomials[1](2.0), "store map values");
+    }
+    filesystem::remove(path);
+
+    // Streams that are not stores, or claim more than they hold, are rejected before any big allocation.
+    auto rejects = [](string input, const string& message) {
+        istringstream in(input);
+        try {
+            read_polynomials(in);
+        } catch (const runtime_error& error) {
+            return message == error.what();
+        }
+        return false;
+    };
+    string zeros(64, '\0');
+    const uint64_t huge = uint64_t(1) << 60;
+    memcpy(zeros.data() + 40, &huge, sizeof(huge));
+    check(rejects(zeros, "Not a polynomial store."), "store rejects other streams");
+    string bogus = bytes;
+    memcpy(bogus.data() + 40, &huge, sizeof(huge));
+    check(rejects(bogus, "The polynomial store is truncated."), "store rejects a bogus length");
+}
+
+void chebyshev() {
+    // The reported error of a fit is its largest error on a fine grid, and within the target.
+    const ChebyshevFit fit = ChebyshevPolynomial::fit([](double x) { return exp(x); }, -1, 1, 1e-10);
+    double worst = 0;
+    for (int k = 0; k <= 10000; k++) {
+        const double x = -1 + k / 5000.0;
+        worst = larger(worst, fabs(exp(x) - fit.polynomial(x)));
+    }
+    check(fit.converged && fit.error <= 1e-10, "Chebyshev fit converged");
+    check(worst <= fit.error * 1.01, "Chebyshev fit error");
+
+    // Conversions both ways keep the values.
+    const Polynomial cubic({1, -2, 0.5, 3}, 0);
+    const ChebyshevPolynomial converted(cubic, 0, 4);
+    check(value_difference(converted.to_polynomial(), cubic, 0, 4) <= 1e-12, "Chebyshev conversion");
+}
+
+void sparse() {
+    // Sparse products, heap-merged or handed to the dense engine, against the dense products.
+    const SparsePolynomial spread({{0, 1}, {2, 3}, {4000, 1}}, 0);
+    const vector<double> dense_terms = random_coefficients(300, 11);
+    const SparsePolynomial dense(Polynomial(dense_terms, 0));
+    const Polynomial spread_square = spread.to_polynomial() * spread.to_polynomial();
+    check(difference((spread * spread).to_polynomial().coefficients(), spread_square.coefficients()) == 0,
+          "sparse heap product");
+    const double bound = 4 * log2(600.0) * 0x1p-53 * norm(dense_terms) * norm(dense_terms);
+    check(difference((dense * dense).to_polynomial().coefficients(), schoolbook(dense_terms, dense_terms)) <= bound,
+          "sparse dense product");
+    const vector<double> spread_terms = spread.to_polynomial().get_coefficients();
+    const Polynomial mixed = (spread * dense).to_polynomial();
+    check(mixed.coefficients().size() == 4300 &&
+          difference(mixed.coefficients(), schoolbook(spread_terms, dense_terms)) <= 4 * 0x1p-53 * norm(dense_terms),
+          "sparse mixed product");
+    check(difference((dense * spread).to_polynomial().coefficients(), mixed.coefficients()) == 0,
+          "sparse product in either order");
+
+    // Both classes print a polynomial the same way.
+    auto printed = [](const auto& polynomial) {
+        ostringstream out;
+        out << polynomial;
+        return out.str();
+    };
+    check(printed(spread) == "x^4000 + 3x^2 + 1", "sparse display");
+    for (const SparsePolynomial& polynomial : {spread, SparsePolynomial({{1, -1}, {3, 2.5}}, 1.5),
+                                               SparsePolynomial({{0, 1}, {5, 1}}, -2), SparsePolynomial()}) {
+        check(printed(polynomial) == printed(polynomial.to_polynomial()), "sparse display like dense");
+    }
+}
+
+void grid() {
+    // Stepped and solved grids against solve(), within the bound of GridEvaluator.h, on a fine grid and
+    // a coarse one, for every degree up to the Horner path.
+    for (const auto& [x0, h] : {pair{-1.0, 2e-6}, pair{-3.0, 0.37}}) {
+        for (size_t n = 1; n <= 6; n++) {
+            const Polynomial p(random_coefficients(n, 12 + unsigned(n)), 0.1);
+            vector<double> values(300001);
+            GridEvaluator evaluator(p, x0, h);
+            evaluator.fill(span<double>(values).first(1001));
+            evaluator.fill(span<double>(values).subspan(1001));
+            double worst = 0;
+            double largest = 0;
+            for (size_t i = 0; i < values.size(); i++) {
+                const double exact = p.solve(x0 + double(i) * h);
+                worst = larger(worst, fabs(values[i] - exact));
+                largest = max(largest, fabs(exact));
+            }
+            check(worst <= 0x1p-39 * largest, "grid against solve, degree " + to_string(n - 1));
+
+            evaluator.seek(123457);
+            check(fabs(evaluator.next() - p.solve(x0 + 123457 * h)) <= 0x1p-39 * largest, "grid seek");
+            vector<double> head(10);
+            p.evaluate_grid(x0, h, head);
+            check(equal(head.begin(), head.end(), values.begin()), "evaluate_grid against GridEvaluator");
+        }
+    }
+}
+
+void zeros() {
+    // A simple zero in a few steps, from a guess close to it and from one where Newton's method cycles.
+    // |p(x)| <= 1e-10 puts a simple zero within 1e-10 / |p'(x)| of the exact one.
+    const Polynomial cubic({-5, -2, 0, 1}, 0);
+    const double root = 2.0945514815423265;
+    const ZeroResult near = cubic.find_zero(2);
+    check(near.converged && fabs(near.root - root) <= 1e-11 && near.iterations < 10 &&
+          fabs(near.residual) <= 1e-10 && cubic.zero(2) == near.root, "zero near the guess");
+    const Polynomial cycling({2, -2, 0, 1}, 0);
+    const ZeroResult far = cycling.find_zero(0);
+    check(far.converged && fabs(cycling(far.root)) <= 1e-10 && fabs(far.root + 1.7692923542386314) <= 1e-10,
+          "zero where Newton's method cycles");
+
+    // Once bracketed, the search stays in the bracket: x^3 - x from 0.45 has to end at a zero of it.
+    const ZeroResult bracketed = Polynomial({0, -1, 0, 1}, 0).find_zero(0.45);
+    check(bracketed.converged && (fabs(bracketed.root) <= 1e-12 || fabs(fabs(bracketed.root) - 1) <= 1e-12),
+          "zero of x^3 - x");
+
+    // A double zero converges slowly and is only found to sqrt(1e-10); no real zero is reported as not converged.
+    const ZeroResult twice = Polynomial({1, -2, 1}, 0).find_zero(3);
+    check(twice.converged && fabs(twice.root - 1) <= 1e-5, "double zero");
+    const ZeroResult none = Polynomial({1, 0, 1}, 0).find_zero(0.5, 1e-10, 50);
+    check(!none.converged && !none.bracketed && none.iterations == 50, "no real zero");
+}
+
+void roots() {
+    // (x^2 + 1)(x - 2)(x^2 - 2x + 5): roots +-i, 2 and 1 +- 2i, the complex ones in exact conjugate pairs.
+    const Polynomial known = Polynomial({1, 0, 1}, 0) * Polynomial({-2, 1}, 0) * Polynomial({5, -2, 1}, 0);
+    const vector<complex<double>> found = known.roots();
+    const vector<complex<double>> expected = {{0, -1}, {0, 1}, {1, -2}, {1, 2}, {2, 0}};
+    double worst = found.size() == expected.size() ? 0 : 1;
+    for (size_t i = 0; i < min(found.size(), expected.size()); i++) {
+        worst = larger(worst, abs(found[i] - expected[i]));
+    }
+    check(worst <= 1e-12, "roots of a known polynomial");
+    check(found.size() == 5 && found[0] == conj(found[1]) && found[2] == conj(found[3]) && found[4].imag() == 0,
+          "roots in conjugate pairs");
+    const vector<double> real = known.real_roots();
+    check(real.size() == 1 && fabs(real[0] - 2) <= 1e-12, "real roots of a known polynomial");
+
+    // Wilkinson's polynomial: its roots are real, but rounding leaves them only accurate to about 1e-2.
+    Polynomial wilkinson({1}, 0);
+    for (int k = 1; k <= 20; k++) {
+        wilkinson *= Polynomial({-double(k), 1}, 0);
+    }
+    const vector<double> wilkinson_roots = wilkinson.real_roots();
+    worst = wilkinson_roots.size() == 20 ? 0 : 1;
+    for (size_t k = 0; k < min<size_t>(wilkinson_roots.size(), 20); k++) {
+        worst = larger(worst, fabs(wilkinson_roots[k] - double(k + 1)));
+    }
+    check(worst <= 0.05, "Wilkinson real roots");
+
+    // A random polynomial of degree 99, solved on several threads: pairs, residuals and the real roots
+    // against root isolation.
+    const Polynomial random(random_coefficients(100, 13), 0);
+    const vector<complex<double>> random_roots = random.roots(4);
+    check(random_roots == random.roots(1), "roots on one and several threads");
+    size_t real_count = 0;
+    bool paired = random_roots.size() == 99;
+    worst = 0;
+    for (const complex<double>& root : random_roots) {
+        real_count += root.imag() == 0;
+        paired = paired && (root.imag() == 0 || count(random_roots.begin(), random_roots.end(), conj(root)) == 1);
+        complex<double> value = 0;
+        double magnitude = 0;
+        for (size_t i = 100; i-- > 0;) {
+            value = value * root + random[int(i)];
+            magnitude = magnitude * abs(root) + fabs(random[int(i)]);
+        }
+        worst = larger(worst, abs(value) / magnitude);
+    }
+    check(paired, "random roots in conjugate pairs");
+    check(worst <= 1e-13, "random roots residual");
+    check(real_count == random.isolate_real_roots(-INFINITY, INFINITY).size(), "random real roots against isolation");
+}
+
+void isolation() {
+    // (x + 3)(x + 1)(x - 0.5)(x - 2)(x - 7)(x^2 + 1): five real roots, each in its own narrow interval.
+    Polynomial p({1, 0, 1}, 0);
+    const vector<double> expected = {-3, -1, 0.5, 2, 7};
+    for (double root : expected) {
+        p *= Polynomial({-root, 1}, 0);
+    }
+    const vector<RootInterval> intervals = p.isolate_real_roots(-INFINITY, INFINITY, 1e-12);
+    bool found = intervals.size() == expected.size();
+    for (size_t k = 0; found && k < expected.size(); k++) {
+        // The rounded coefficients move the roots by a few ulps, so only the interval's width is exact.
+        found = intervals[k].isolated && intervals[k].high - intervals[k].low <= 1e-12 &&
+                fabs(intervals[k].low - expected[k]) <= 1e-12 * max(1.0, fabs(expected[k]));
+    }
+    check(found, "isolated roots of a known polynomial");
+    const vector<RootInterval> inside = p.isolate_real_roots(0, 5, 1e-6);
+    check(inside.size() == 2 && inside[0].low <= 0.5 && 0.5 <= inside[0].high && inside[1].low <= 2 &&
+          2 <= inside[1].high && inside[1].high - inside[1].low <= 1e-6, "isolated roots in a range");
+    check(Polynomial({1, 0, 1}, 0).isolate_real_roots(-INFINITY, INFINITY).empty(), "no real roots to isolate");
+
+    // Degree 99 is split over threads; the intervals must not depend on how many.
+    const Polynomial random(random_coefficients(100, 17), 0);
+    const vector<RootInterval> serial = random.isolate_real_roots(-INFINITY, INFINITY, 1e-12, 1);
+    const vector<RootInterval> parallel = random.isolate_real_roots(-INFINITY, INFINITY, 1e-12, 4);
+    bool same = !serial.empty() && serial.size() == parallel.size();
+    for (size_t k = 0; same && k < serial.size(); k++) {
+        same = serial[k].low == parallel[k].low && serial[k].high == parallel[k].high &&
+               serial[k].isolated == parallel[k].isolated;
+    }
+    check(same, "isolation on one and several threads");
+    bool signs = true;
+    for (const RootInterval& interval : serial) {
+        signs = signs && interval.isolated && (interval.low == interval.high ||
+                                               random(interval.low) * random(interval.high) <= 0);
+    }
+    check(signs, "isolated roots change sign");
+}
+
+void thread_pool() {
+    // Every index is visited exactly once, however the range is split.
+    polynomialc_internal::ThreadPool pool(4);
+    for (unsigned int parts : {1u, 3u, 4u, 64u, 2000u}) {
+        vector<atomic<int>> visits(1000);
+        pool.parallel_for(visits.size(), parts, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                visits[i]++;
+            }
+        });
+        check(all_of(visits.begin(), visits.end(), [](const atomic<int>& n) { return n == 1; }),
+              "parallel_for in " + to_string(parts) + " parts");
+    }
+    bool thrown = false;
+    try {
+        pool.parallel_for(100, 4, [](size_t begin, size_t) {
+            if (begin > 0) {
+                throw runtime_error("part failed");
+            }
+        });
+    } catch (const runtime_error&) {
+        thrown = true;
+    }
+    check(thrown, "parallel_for rethrows");
+}
+
+void statistics() {
+    // The counters only move in a build with POLYNOMIALC_INSTRUMENTATION; otherwise they stay 0.
+    reset_polynomial_statistics();
+    const size_t n = POLYNOMIALC_INLINE_TERMS + 42;
+    const Polynomial p(random_coefficients(n, 26), 0);
+    for (int k = 0; k < 10; k++) {
+        p.solve(k / 10.0);
+    }
+    thread other([&p] { p.solve(0.5); });
+    other.join();
+    const ZeroResult zero = Polynomial({-2, 0, 1}, 0).find_zero(1);
+    const PolynomialStatistics counted = polynomial_statistics();
+    if (counted.enabled) {
+        check(counted.operation(PolynomialOperation::solve).calls == 11 &&
+              counted.operation(PolynomialOperation::find_zero).calls == 1, "operation calls on every thread");
+        check(counted.counter(PolynomialCounter::allocations) == 1 &&
+              counted.counter(PolynomialCounter::allocated_bytes) == n * sizeof(double), "allocation counters");
+        check(counted.counter(PolynomialCounter::zero_iterations) == zero.iterations &&
+              counted.counter(PolynomialCounter::flops) >= 11 * 2 * (n - 1), "work counters");
+        check(counted.to_json().find("\"solve\": {\"calls\": 11") != string::npos &&
+              counted.to_prometheus().find("polynomialc_calls_total{operation=\"solve\"} 11") != string::npos,
+              "statistics export");
+    } else {
+        check(counted.operation(PolynomialOperation::solve).calls == 0 &&
+              counted.counter(PolynomialCounter::allocations) == 0, "statistics compiled out");
+    }
+    reset_polynomial_statistics();
+    check(polynomial_statistics().operation(PolynomialOperation::solve).calls == 0, "statistics reset");
+}
+
+} // namespace
+
+
+int main() {
+    multiply_and_divide();
+    common_divisors();
+    powers();
+    series_tables();
+    recenter_and_compose();
+    moves();
+    expressions();
+    memory();
+    fixed();
+    evaluation();
+    interpolation();
+    formatting();
+    store();
+    chebyshev();
+    sparse();
+    grid();
+    zeros();
+    roots();
+    isolation();
+    thread_pool();
+    statistics();
+    if (failures == 0) {
+        printf("All checks passed.\n");
+    }
+    return failures == 0 ? 0 : 1;
+}
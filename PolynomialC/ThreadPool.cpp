@@ -0,0 +1,193 @@
+//
+// A small work-stealing thread pool used to spread the heavier Polynomial algorithms over several
+// cores.
+//
+
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <chrono>
+using namespace std;
+
+namespace polynomialc_internal {
+namespace {
+
+// The pool and queue the current thread works for; threads outside every pool use the shared queue.
+thread_local const ThreadPool* current_pool = nullptr;
+thread_local size_t current_queue = 0;
+
+} // namespace
+
+
+// ===== THREAD POOL =====
+
+ThreadPool::ThreadPool(unsigned int threads) {
+    // The thread waiting on a task group always takes part, so one worker fewer is started.
+    threads = max(1u, threads);
+    for (unsigned int i = 0; i < threads; i++) {
+        queues.push_back(make_unique<TaskQueue>());
+    }
+    for (unsigned int i = 1; i < threads; i++) {
+        workers.emplace_back([this, i] { work(i); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        lock_guard<mutex> guard(sleep_lock);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+unsigned int ThreadPool::size() const {
+    return (unsigned int) workers.size() + 1;
+}
+
+void ThreadPool::work(size_t home) {
+    current_pool = this;
+    current_queue = home;
+    while (true) {
+        if (run_one()) {
+            continue;
+        }
+        unique_lock<mutex> guard(sleep_lock);
+        wake.wait(guard, [this] { return stopping || queued.load() > 0; });
+        if (stopping && queued.load() == 0) {
+            return;
+        }
+    }
+}
+
+void ThreadPool::submit(function<void()> task) {
+    size_t home = current_pool == this ? current_queue : 0;
+    queued.fetch_add(1);
+    {
+        lock_guard<mutex> guard(queues[home]->lock);
+        queues[home]->tasks.push_back(move(task));
+    }
+    {
+        // Taking the lock orders the new task before a worker that is about to go to sleep.
+        lock_guard<mutex> guard(sleep_lock);
+    }
+    wake.notify_one();
+}
+
+bool ThreadPool::run_one() {
+    size_t home = current_pool == this ? current_queue : 0;
+    function<void()> task;
+
+    // The newest task of the thread's own queue is the most likely to still be in cache.
+    {
+        lock_guard<mutex> guard(queues[home]->lock);
+        if (!queues[home]->tasks.empty()) {
+            task = move(queues[home]->tasks.back());
+            queues[home]->tasks.pop_back();
+        }
+    }
+
+    // Otherwise the oldest task of another queue is stolen; it is usually the largest piece of work.
+    for (size_t k = 1; !task && k < queues.size(); k++) {
+        TaskQueue& victim = *queues[(home + k) % queues.size()];
+        lock_guard<mutex> guard(victim.lock);
+        if (!victim.tasks.empty()) {
+            task = move(victim.tasks.front());
+            victim.tasks.pop_front();
+        }
+    }
+
+    if (!task) {
+        return false;
+    }
+    queued.fetch_sub(1);
+    task();
+    return true;
+}
+
+void ThreadPool::parallel_for(size_t count, unsigned int parts, const function<void(size_t, size_t)>& body) {
+    if (count == 0) {
+        return;
+    }
+    parts = (unsigned int) max<size_t>(1, min<size_t>(parts, count));
+    if (parts == 1 || workers.empty()) {
+        body(0, count);
+        return;
+    }
+
+    TaskGroup group(*this);
+    for (unsigned int part = 1; part < parts; part++) {
+        size_t begin = count * part / parts;
+        size_t end = count * (part + 1) / parts;
+        group.run([&body, begin, end] { body(begin, end); });
+    }
+    group.run([&body, count, parts] { body(0, count / parts); });
+    group.wait();
+}
+
+ThreadPool& ThreadPool::global() {
+    static ThreadPool pool(max(1u, thread::hardware_concurrency()));
+    return pool;
+}
+
+
+// ===== TASK GROUP =====
+
+TaskGroup::TaskGroup(ThreadPool& pool) : pool(pool) {}
+
+TaskGroup::~TaskGroup() {
+    // Tasks refer to the group, so it cannot go away before they are done.
+    try {
+        wait();
+    } catch (...) {
+    }
+}
+
+void TaskGroup::run(function<void()> task) {
+    pending.fetch_add(1);
+    pool.submit([this, task = move(task)] {
+        try {
+            task();
+        } catch (...) {
+            lock_guard<mutex> guard(lock);
+            if (!error) {
+                error = current_exception();
+            }
+        }
+        // The count drops under the lock so wait() cannot return (and the group go away) while this
+        // task still touches it.
+        lock_guard<mutex> guard(lock);
+        if (pending.fetch_sub(1) == 1) {
+            done.notify_all();
+        }
+    });
+}
+
+void TaskGroup::wait() {
+    // The waiting thread helps with queued tasks (from this group or any other) until the group is
+    // done, which also keeps nested groups from deadlocking.  The timed wait picks up tasks that other
+    // threads queue while this one sleeps.
+    while (pending.load() > 0) {
+        if (!pool.run_one()) {
+            unique_lock<mutex> guard(lock);
+            done.wait_for(guard, chrono::microseconds(200), [this] { return pending.load() == 0; });
+        }
+    }
+
+    exception_ptr failure;
+    {
+        lock_guard<mutex> guard(lock);
+        swap(failure, error);
+    }
+    if (failure) {
+        rethrow_exception(failure);
+    }
+}
+
+unsigned int resolve_threads(unsigned int threads) {
+    return threads == 0 ? ThreadPool::global().size() : threads;
+}
+
+} // namespace polynomialc_internal
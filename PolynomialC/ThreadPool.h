@@ -0,0 +1,87 @@
+//
+// A small work-stealing thread pool used to spread the heavier Polynomial algorithms over several
+// cores.
+//
+
+#ifndef POLYNOMIALC_THREADPOOL_H
+#define POLYNOMIALC_THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace polynomialc_internal {
+    // Every worker owns a queue.  A worker runs the newest task of its own queue first and, when that
+    // is empty, steals the oldest task of another queue, so recursive work (a task that spawns smaller
+    // tasks) spreads over idle workers with little contention.  Threads outside the pool submit to a
+    // shared queue.
+    class ThreadPool {
+        struct TaskQueue {
+            std::mutex lock;
+            std::deque<std::function<void()>> tasks;
+        };
+
+        std::vector<std::thread> workers;
+        std::vector<std::unique_ptr<TaskQueue>> queues;  // queues[0] is shared, queues[i + 1] is worker i's
+        std::atomic<size_t> queued{0};
+        std::mutex sleep_lock;
+        std::condition_variable wake;
+        bool stopping = false;
+
+        void work(size_t home);
+        void submit(std::function<void()> task);
+        bool run_one();
+
+        friend class TaskGroup;
+
+    public:
+        explicit ThreadPool(unsigned int threads);
+        ~ThreadPool();
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        // The number of threads that can work at once (the workers plus the calling thread).
+        unsigned int size() const;
+
+        // Splits [0, count) into up to parts contiguous ranges and calls body(begin, end) on each,
+        // spread over the workers and the calling thread.  Returns once every range is done; the first
+        // exception thrown by body is rethrown here.
+        void parallel_for(size_t count, unsigned int parts, const std::function<void(size_t, size_t)>& body);
+
+        // A pool shared by the whole library, with one thread per hardware thread.
+        static ThreadPool& global();
+    };
+
+    // A set of tasks that can be waited on together.  Tasks may add more tasks to their own group.
+    // While waiting, the waiting thread runs queued tasks itself, so groups can be nested freely.
+    class TaskGroup {
+        ThreadPool& pool;
+        std::atomic<size_t> pending{0};
+        std::mutex lock;
+        std::condition_variable done;
+        std::exception_ptr error;
+
+    public:
+        explicit TaskGroup(ThreadPool& pool);
+        ~TaskGroup();
+        TaskGroup(const TaskGroup&) = delete;
+        TaskGroup& operator=(const TaskGroup&) = delete;
+
+        void run(std::function<void()> task);
+
+        // Returns once every task of the group is done; rethrows the first exception a task threw.
+        void wait();
+    };
+
+    // The number of threads to use for a requested thread count, where 0 means every hardware thread.
+    unsigned int resolve_threads(unsigned int threads);
+}
+
+#endif //POLYNOMIALC_THREADPOOL_H